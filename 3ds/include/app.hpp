@@ -36,6 +36,7 @@
 #include "loader.hpp"
 #include "TitleLoadScreen.hpp"
 #include "thread.hpp"
+#include "WriteQueue.hpp"
 
 extern "C" {
 #include "download.h"
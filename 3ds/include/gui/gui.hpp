@@ -37,6 +37,7 @@
 #include "json.hpp"
 #include "i18n.hpp"
 #include "PKX.hpp"
+#include "PKXView.hpp"
 #include "Sav.hpp"
 #include "thread.hpp"
 
@@ -127,6 +128,12 @@ namespace Gui
     void sprite(int key, int x, int y);
     void sprite(int key, int x, int y, u32 color);
     void pkm(const PKX& pkm, int x, int y, float scale = 1.0f, u32 color = C2D_Color32(0, 0, 0, 255), float blend = 0.0f);
+    void pkmIcon(int species, int form, Generation generation, int gender, bool egg, bool item, bool shiny, int x, int y, float scale, u32 color, float blend);
+    template <Generation G>
+    void pkm(const PKXView<G>& pkm, int x, int y, float scale = 1.0f, u32 color = C2D_Color32(0, 0, 0, 255), float blend = 0.0f)
+    {
+        pkmIcon(pkm.species(), pkm.alternativeForm(), G, pkm.gender(), pkm.egg(), pkm.heldItem() > 0, pkm.shiny(), x, y, scale, color, blend);
+    }
     void pkm(int species, int form, Generation generation, int gender, int x, int y, float scale = 1.0f, u32 color = C2D_Color32(0, 0, 0, 255), float blend = 0.0f);
 
     void backgroundTop(bool stripes);
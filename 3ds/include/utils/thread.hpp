@@ -32,7 +32,8 @@
 
 namespace Threads
 {
-    void create(ThreadFunc entrypoint);
+    // priority is relative to the calling thread's; lower runs first
+    void create(ThreadFunc entrypoint, void* arg = NULL, size_t stackSize = 4*1024, s32 priority = -1);
     void destroy(void);
 }
 
@@ -25,15 +25,25 @@
 */
 
 #include "Bank.hpp"
+#include "ArchiveBankFile.hpp"
+#include "BackupStore.hpp"
+#include "BankJournal.hpp"
 #include "Configuration.hpp"
 #include "FSStream.hpp"
 #include "archive.hpp"
+#include "banks.hpp"
 #include "gui.hpp"
 #include "PB7.hpp"
+#include "WriteQueue.hpp"
+#include <algorithm>
+#include <ctime>
+#include <map>
 
 // TODO actually do stuff with the name
 Bank::Bank(const std::string& name, int maxBoxes) : bankName(name)
 {
+    // A box is hashed as saved when first read rather than every box when the bank loads
+    pages.observe([this](int box, const u8* data) { changes.loaded(data, box); });
     load(maxBoxes);
     if (boxes() != maxBoxes)
     {
@@ -41,14 +51,22 @@ Bank::Bank(const std::string& name, int maxBoxes) : bankName(name)
     }
 }
 
+Bank::~Bank()
+{
+    // Queued saves refer to this bank
+    WriteQueue::getInstance().flush();
+}
+
 void Bank::load(int maxBoxes)
 {
-    if (data)
-    {
-        delete[] data;
-        data = nullptr;
-    }
-    needsCheck = false;
+    WriteQueue::getInstance().flush();
+    pages.close();
+    file = std::make_unique<ArchiveBankFile>(Configuration::getInstance().useExtData() ? Archive::data() : Archive::sd());
+    headerChanged = false;
+    namesChanged = false;
+    damaged = false;
+    indexed = false;
+    slotIndex = BankIndex();
     if (name() == "pksm_1" && io::exists("/3ds/PKSM/bank/bank.bin"))
     {
         convert();
@@ -59,41 +77,70 @@ void Bank::load(int maxBoxes)
         std::string jsonPath = Configuration::getInstance().useExtData() ? "/banks/" + bankName + ".json" : "/3ds/PKSM/banks/" + bankName + ".json";
         auto archive = Configuration::getInstance().useExtData() ? Archive::data() : Archive::sd();
         bool needSave = false;
+        if (!BankJournal(*file, bankPath).recover())
+        {
+            // The file is part way through a save its journal could not finish. Reading it would show
+            // the half written state and saving would drop the journal, so it waits for a later load
+            Gui::warn(i18n::localize("BANK_RECOVER_ERROR"));
+            damaged = true;
+            createBank(maxBoxes);
+            changes.reset(sizeof(BankEntry) * 30, boxes());
+            headerChanged = false;
+            createJSON();
+            return;
+        }
+        store.attach(*file, bankPath, sizeof(BankHeader));
         FSStream in(archive, bankPath, FS_OPEN_READ);
         if (in.good())
         {
             Gui::waitFrame(i18n::localize("BANK_LOAD"));
-            BankHeader h{"BAD_MGC", 0, 0};
-            size = in.size();
-            in.read((char*)&h, sizeof(BankHeader) - sizeof(int));
-            if (memcmp(&h, BANK_MAGIC.data(), 8))
+            BankHeader h{"BAD_MGC", 0, 0, 0};
+            size_t size = in.size();
+            in.read((char*)&h, sizeof(h.MAGIC) + sizeof(h.version));
+            if (h.version != 1)
+            {
+                in.read(&h.boxes, sizeof(int));
+            }
+            if (h.version == BANK_VERSION)
+            {
+                in.read(&h.revision, sizeof(u32));
+            }
+            in.close();
+            if (memcmp(&h, BANK_MAGIC.data(), 8) || (h.version == BANK_VERSION && !store.open(*file, bankPath, sizeof(BankHeader), h.boxes)))
             {
                 Gui::warn(i18n::localize("BANK_CORRUPT"));
-                in.close();
                 createBank(maxBoxes);
                 needSave = true;
             }
+            else if (h.version == BANK_VERSION)
+            {
+                header = h;
+                // Boxes are read and unpacked as they are needed rather than all at once
+                pages.open([this](int box, u8* out) { return loadBox(box, out); }, boxes());
+                changes.reset(sizeof(BankEntry) * 30, boxes());
+            }
             else
             {
                 // NOTE: THIS IS THE CONVERSION SECTION. WILL NEED TO BE MODIFIED WHEN THE FORMAT IS CHANGED
+                // Versions 1 and 2 store every entry at full size straight after the header, which
+                // version 1 lacks a box count in. Their boxes are paged from the old file until the
+                // save below rewrites it in the current layout.
+                u32 entriesOffset = sizeof(h.MAGIC) + sizeof(h.version) + sizeof(h.boxes);
                 if (h.version == 1)
                 {
-                    h.boxes = (size - (sizeof(BankHeader) - sizeof(int))) / sizeof(BankEntry) / 30;
+                    h.boxes = (size - (sizeof(h.MAGIC) + sizeof(h.version))) / sizeof(BankEntry) / 30;
                     maxBoxes = h.boxes;
                     extern nlohmann::json g_banks;
                     g_banks[bankName] = maxBoxes;
-                    data = new u8[size = size + sizeof(int)];
-                    h.version = BANK_VERSION;
-                    needSave = true;
+                    entriesOffset -= sizeof(int);
                 }
-                else
-                {
-                    data = new u8[size];
-                    in.read(&h.boxes, sizeof(int));
-                }
-                std::copy((char*)&h, (char*)(&h + 1), data);
-                in.read(data + sizeof(BankHeader), size - sizeof(BankHeader));
-                in.close();
+                h.version = BANK_VERSION;
+                header = h;
+                pages.open(*file, bankPath, entriesOffset, boxes());
+                changes.reset(sizeof(BankEntry) * 30, boxes());
+                changes.invalidate();
+                headerChanged = true;
+                needSave = true;
             }
         }
         else
@@ -112,34 +159,34 @@ void Bank::load(int maxBoxes)
             in.read(jsonData, jsonSize);
             in.close();
             jsonData[jsonSize] = '\0';
-            boxNames = nlohmann::json::parse(jsonData, nullptr, false);
-            if (boxNames.is_discarded())
+            nlohmann::json names = nlohmann::json::parse(jsonData, nullptr, false);
+            if (!names.is_array())
             {
                 createJSON();
                 needSave = true;
+                namesChanged = true;
             }
             else
             {
+                boxNames.clear();
+                for (auto& name : names)
+                {
+                    boxNames.push_back(name.is_string() ? name.get<std::string>() : "");
+                }
                 for (int i = boxNames.size(); i < boxes(); i++)
                 {
-                    boxNames[i] = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
-                    if (!needSave)
-                    {
-                        needSave = true;
-                    }
+                    boxNames.push_back(i18n::localize("STORAGE") + " " + std::to_string(i + 1));
+                    needSave = true;
+                    namesChanged = true;
                 }
             }
         }
         else
         {
             in.close();
-            boxNames = nlohmann::json::array();
-            for (int i = 0; i < boxes(); i++)
-            {
-                boxNames[i] = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
-            }
-
+            createJSON();
             needSave = true;
+            namesChanged = true;
         }
 
         if (boxes() != maxBoxes)
@@ -151,12 +198,10 @@ void Bank::load(int maxBoxes)
         {
             save();
         }
-        else
-        {
-            sha256(prevHash.data(), data, size);
-        }
     }
 
+    indexGlobal();
+
     if (Configuration::getInstance().autoBackup())
     {
         backup();
@@ -165,233 +210,292 @@ void Bank::load(int maxBoxes)
 
 bool Bank::save() const
 {
-    std::string bankPath;
+    if (damaged)
+    {
+        Gui::warn(i18n::localize("BANK_RECOVER_ERROR"));
+        return false;
+    }
+
     std::string jsonPath;
     FS_Archive archive;
     if (Configuration::getInstance().useExtData())
     {
-        bankPath = "/banks/" + bankName + ".bnk";
         jsonPath = "/banks/" + bankName + ".json";
         archive = Archive::data();
     }
     else
     {
-        bankPath = "/3ds/PKSM/banks/" + bankName + ".bnk";
         jsonPath = "/3ds/PKSM/banks/" + bankName + ".json";
         archive = Archive::sd();
     }
-    Gui::waitFrame(i18n::localize("BANK_SAVE"));
-    FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(bankPath).c_str()));
-    FSStream out(archive, bankPath, FS_OPEN_WRITE, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
-    if (out.good())
-    {
-        out.write(data, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
-        out.close();
 
-        std::string jsonData = boxNames.dump(2);
-        FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(jsonPath).c_str()));
-        out = FSStream(archive, jsonPath, FS_OPEN_WRITE, jsonData.size());
-        if (out.good())
+    // A box that could not be read holds filler, so the store keeps what the file has for it
+    auto boxData = [this](int box) -> const u8* {
+        const u8* data = pages.box(box);
+        return pages.readable(box) ? data : nullptr;
+    };
+    std::vector<int> changedBoxes = changes.changedBoxes([this](int box) { return pages.box(box); });
+    auto unreadable = std::remove_if(changedBoxes.begin(), changedBoxes.end(), [this](int box) { return !pages.readable(box); });
+    if (unreadable != changedBoxes.end())
+    {
+        Gui::warn(i18n::localize("BANK_CORRUPT"));
+        changedBoxes.erase(unreadable, changedBoxes.end());
+    }
+    // Extdata files are recreated to change size, so only a whole rewrite may do that there
+    bool resizable = !Configuration::getInstance().useExtData();
+    if (headerChanged || !changedBoxes.empty())
+    {
+        header.revision++;
+    }
+    std::vector<u8> headerData((u8*)&header, (u8*)(&header + 1));
+    if (headerChanged)
+    {
+        // A rewrite reads every box, so it happens here rather than behind the pages' back
+        Gui::waitFrame(i18n::localize("BANK_SAVE"));
+        WriteQueue::getInstance().flush();
+        if (!store.save(headerData, boxes(), boxData, changedBoxes, true, resizable))
         {
-            out.write(jsonData.data(), jsonData.size() + 1);
-            sha256(prevHash.data(), data, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
+            Gui::warn(i18n::localize("BANK_SAVE_ERROR"));
+            return false;
         }
-        else
+        headerChanged = false;
+        // Everything edited is on disk now, so the pages can go back to being a cache of it
+        pages.open([this](int box, u8* out) { return loadBox(box, out); }, boxes());
+        for (int box : changedBoxes)
         {
-            Gui::error(i18n::localize("BANK_NAME_ERROR"), out.result());
+            changes.saved(pages.box(box), box);
         }
-        out.close();
-        return true;
+        indexBoxes(changedBoxes, [this](int box) { return pages.box(box); }, header.revision);
     }
-    else
+    else if (!changedBoxes.empty())
     {
-        Gui::error(i18n::localize("BANK_SAVE_ERROR"), out.result());
-        out.close();
-        return false;
+        // The edited boxes are copied, so they can be edited again while the copies are written.
+        // Their pages stay pinned until the write is known to have worked, so a failed one loses nothing
+        auto edited = std::make_shared<std::map<int, std::vector<u8>>>();
+        for (int box : changedBoxes)
+        {
+            const u8* data = pages.box(box);
+            (*edited)[box].assign(data, data + BankBoxStore::BOX_SIZE);
+        }
+        WriteQueue::getInstance().push(
+            [this, headerData, count = boxes(), changedBoxes, edited, resizable]() {
+                std::vector<u8> unchanged(BankBoxStore::BOX_SIZE);
+                auto data = [&](int box) -> const u8* {
+                    auto found = edited->find(box);
+                    if (found != edited->end())
+                    {
+                        return found->second.data();
+                    }
+                    // Only asked for when the store decides to rewrite the whole file. A box that
+                    // cannot be read is copied across as stored rather than replaced
+                    return store.readBox(box, unchanged.data()) ? unchanged.data() : nullptr;
+                };
+                return store.save(headerData, count, data, changedBoxes, false, resizable);
+            },
+            [this, edited, revision = header.revision](bool good) {
+                if (!good)
+                {
+                    Gui::warn(i18n::localize("BANK_SAVE_ERROR"));
+                    // What made it to disk is unknown, so the next save writes everything
+                    changes.invalidate();
+                    headerChanged = true;
+                    return;
+                }
+                std::vector<int> written;
+                for (auto& [box, data] : *edited)
+                {
+                    // The bank may have shrunk since
+                    if (box >= pages.boxes())
+                    {
+                        continue;
+                    }
+                    written.push_back(box);
+                    changes.saved(data.data(), box);
+                    if (std::equal(data.begin(), data.end(), pages.box(box)))
+                    {
+                        pages.saved(box);
+                    }
+                    else
+                    {
+                        // Edited again while being written, so it waits for the next save
+                        changes.markDirty(box);
+                    }
+                }
+                indexBoxes(written, [&edited](int box) { return (const u8*)edited->at(box).data(); }, revision);
+            });
     }
 
-    needsCheck = false;
+    if (namesChanged)
+    {
+        namesChanged = false;
+        auto res = std::make_shared<Result>(0);
+        WriteQueue::getInstance().push(
+            [archive, jsonPath, jsonData = namesJson(), res]() {
+                FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(jsonPath).c_str()));
+                FSStream out(archive, jsonPath, FS_OPEN_WRITE, jsonData.size());
+                if (out.good())
+                {
+                    out.write(jsonData.data(), jsonData.size() + 1);
+                }
+                *res = out.result();
+                out.close();
+                return R_SUCCEEDED(*res);
+            },
+            [this, res](bool good) {
+                if (!good)
+                {
+                    Gui::error(i18n::localize("BANK_NAME_ERROR"), *res);
+                    namesChanged = true;
+                }
+            });
+    }
+    return true;
 }
 
 void Bank::resize(int boxes)
 {
-    size_t newSize = sizeof(BankHeader) + sizeof(BankEntry) * boxes * 30;
-    std::string bankPath = Configuration::getInstance().useExtData() ? "/banks/" + bankName + ".bnk" : "/3ds/PKSM/banks/" + bankName + ".bnk";
-    std::string jsonPath = Configuration::getInstance().useExtData() ? "/banks/" + bankName + ".json" : "/3ds/PKSM/banks/" + bankName + ".json";
-    FS_Archive archive = Configuration::getInstance().useExtData() ? Archive::data() : Archive::sd();
-    if (newSize != size)
+    if (boxes != this->boxes())
     {
         Gui::showResizeStorage();
-        u8* newData = new u8[newSize];
-        std::copy(data, data + std::min(newSize, size), newData);
-        delete[] data;
-        if (newSize > size)
+        header.boxes = boxes;
+        headerChanged = true;
+        pages.resize(boxes);
+        if (indexed)
         {
-            std::fill_n(newData + size, newSize - size, 0xFF);
+            slotIndex.resize(boxes * 30);
         }
-        data = newData;
-
-        FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(bankPath).c_str()));
-        FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(jsonPath).c_str()));
+        changes.resize(boxes);
 
-        ((BankHeader*)data)->boxes = boxes;
-
-        for (size_t i = boxNames.size(); i < boxes; i++)
+        for (int i = boxNames.size(); i < boxes; i++)
         {
-            boxNames[i] = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
+            boxNames.push_back(i18n::localize("STORAGE") + " " + std::to_string(i + 1));
+            namesChanged = true;
         }
 
         save();
     }
-    size = newSize;
 }
 
 std::shared_ptr<PKX> Bank::pkm(int box, int slot) const
 {
-    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
-    int index = box * 30 + slot;
-    bool party = false;
-    switch (bank[index].gen)
-    {
-        case Generation::FOUR:
-            for (int i = 260; i > 136; i--)
-            {
-                if (bank[index].data[i] != 0xFF)
-                {
-                    party = true;
-                    break;
-                }
-            }
-            return std::make_shared<PK4>(bank[index].data, false, party);
-
-        case Generation::FIVE:
-            for (int i = 260; i > 136; i--)
-            {
-                if (bank[index].data[i] != 0xFF)
-                {
-                    party = true;
-                    break;
-                }
-            }
-            return std::make_shared<PK5>(bank[index].data, false, party);
-
-        case Generation::SIX:
-            for (int i = 260; i > 232; i--)
-            {
-                if (bank[index].data[i] != 0xFF)
-                {
-                    party = true;
-                    break;
-                }
-            }
-            return std::make_shared<PK6>(bank[index].data, false, party);
-
-        case Generation::SEVEN:
-            for (int i = 260; i > 232; i--)
-            {
-                if (bank[index].data[i] != 0xFF)
-                {
-                    party = true;
-                    break;
-                }
-            }
-            return std::make_shared<PK7>(bank[index].data, false, party);
-
-        case Generation::LGPE:
-            return std::make_shared<PB7>(bank[index].data, false);
-
-        case Generation::UNUSED:
-        default:
-            return std::make_shared<PK7>();
-    }
+    return BankBoxStore::readEntry(pages.box(box) + slot * sizeof(BankEntry));
 }
 
 void Bank::pkm(std::shared_ptr<PKX> pkm, int box, int slot)
 {
-    BankEntry* bank = (BankEntry*)(data + sizeof(BankHeader));
-    int index = box * 30 + slot;
-    BankEntry newEntry;
-    if (pkm->species() == 0)
-    {
-        std::fill_n((char*) &newEntry, sizeof(BankEntry), 0xFF);
-        bank[index] = newEntry;
-        needsCheck = true;
-        return;
-    }
-    newEntry.gen = pkm->generation();
-    std::copy(pkm->rawData(), pkm->rawData() + pkm->getLength(), newEntry.data);
-    if (pkm->getLength() < 260)
+    BankBoxStore::writeEntry(*pkm, pages.edit(box) + slot * sizeof(BankEntry));
+    // Without an index yet, the slot is picked up when one is built
+    if (indexed)
     {
-        std::fill_n(newEntry.data + pkm->getLength(), 260 - pkm->getLength(), 0xFF);
+        if (pkm->species() == 0)
+        {
+            slotIndex.clear(box * 30 + slot);
+        }
+        else
+        {
+            slotIndex.set(box * 30 + slot, *pkm);
+        }
     }
-    bank[index] = newEntry;
-    needsCheck = true;
+    changes.markDirty(box);
 }
 
 void Bank::backup() const
 {
-    Gui::waitFrame(i18n::localize("BANK_BACKUP"));
-    std::string bankPath = "/3ds/PKSM/backups/" + bankName + ".bnk.bak";
-    std::string jsonPath = "/3ds/PKSM/backups/" + bankName + ".json.bak";
-    FSUSER_DeleteFile(Archive::sd(), fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(bankPath).c_str()));
-    FSUSER_DeleteFile(Archive::sd(), fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(jsonPath).c_str()));
-
-    FSStream out(Archive::sd(), bankPath, FS_OPEN_WRITE, size);
-    out.write(data, size);
-    out.close();
-
-    std::string jsonData = boxNames.dump(2);
-    out = FSStream(Archive::sd(), jsonPath, FS_OPEN_WRITE, jsonData.size());
-    out.write(jsonData.data(), jsonData.size());
-    out.close();
+    if (damaged)
+    {
+        return;
+    }
+
+    std::string bankPath = Configuration::getInstance().useExtData() ? "/banks/" + bankName + ".bnk" : "/3ds/PKSM/banks/" + bankName + ".bnk";
+    char stringTime[15] = {0};
+    time_t unixTime = time(NULL);
+    std::strftime(stringTime, 14, "%Y%m%d%H%M%S", gmtime(&unixTime));
+
+    // A snapshot of the file as saved, sharing whatever has not changed with earlier ones.
+    // Queued behind any save, so that is what it sees
+    WriteQueue::getInstance().push(
+        [this, bankPath, name = bankName, snapshot = std::string(stringTime), jsonData = namesJson(), kept = Configuration::getInstance().keptBackups()]() {
+            BackupStore store("/3ds/PKSM/backups/store");
+            std::vector<u8> contents;
+            if (!file->read(bankPath, contents) || !store.backup(name + ".bnk", snapshot, contents.data(), contents.size()) ||
+                !store.backup(name + ".json", snapshot, (const u8*)jsonData.data(), jsonData.size()))
+            {
+                return false;
+            }
+            // Only the newest are kept if the configuration sets how many
+            if (kept > 0 && store.prune(name + ".bnk", kept) + store.prune(name + ".json", kept))
+            {
+                store.collectGarbage();
+            }
+            return true;
+        },
+        [](bool good) {
+            if (!good)
+            {
+                Gui::warn(i18n::localize("BAD_OPEN_BACKUP"));
+            }
+        });
 }
 
-std::string Bank::boxName(int box) const
+const std::string& Bank::boxName(int box) const
 {
-    return boxNames[box].get<std::string>();
+    return boxNames[box];
 }
 
 void Bank::boxName(std::string name, int box)
 {
-    boxNames[box] = name;
+    if (boxNames[box] != name)
+    {
+        boxNames[box] = std::move(name);
+        namesChanged = true;
+    }
 }
 
 void Bank::createJSON()
 {
-    boxNames = nlohmann::json::array();
+    boxNames.clear();
     for (int i = 0; i < boxes(); i++)
     {
-        boxNames[i] = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
+        boxNames.push_back(i18n::localize("STORAGE") + " " + std::to_string(i + 1));
     }
 }
 
+std::string Bank::namesJson() const
+{
+    return nlohmann::json(boxNames).dump(2);
+}
+
 void Bank::createBank(int maxBoxes)
 {
-    if (data)
-    {
-        delete[] data;
-    }
-    data = new u8[size = sizeof(BankHeader) + sizeof(BankEntry) * maxBoxes * 30];
-    std::copy(BANK_MAGIC.data(), BANK_MAGIC.data() + BANK_MAGIC.size(), data);
-    *(int*)(data + 8) = BANK_VERSION;
-    *(int*)(data + 12) = maxBoxes;
-    std::fill_n(data + sizeof(BankHeader), sizeof(BankEntry) * boxes() * 30, 0xFF);
+    std::copy(BANK_MAGIC.data(), BANK_MAGIC.data() + BANK_MAGIC.size(), header.MAGIC);
+    header.version = BANK_VERSION;
+    header.boxes = maxBoxes;
+    pages.close();
+    pages.resize(maxBoxes);
+    changes.reset(sizeof(BankEntry) * 30, boxes());
+    changes.invalidate();
+    headerChanged = true;
 }
 
-bool Bank::hasChanged() const
+bool Bank::loadBox(int box, u8* out) const
 {
-    if (!needsCheck)
+    // The store may be in the middle of a queued save
+    WriteQueue::getInstance().wait();
+    if (!store.readBox(box, out))
     {
+        // Only once, as the pager keeps the box marked unreadable until the bank is opened again
+        if (pages.readable(box))
+        {
+            Gui::warn(i18n::localize("BANK_CORRUPT"));
+        }
         return false;
     }
-    u8 hash[SHA256_BLOCK_SIZE];
-    sha256(hash, data, sizeof(BankHeader) + sizeof(BankEntry) * boxes() * 30);
-    if (memcmp(hash, prevHash.data(), SHA256_BLOCK_SIZE))
-    {
-        return true;
-    }
-    needsCheck = false;
-    return false;
+    return true;
+}
+
+bool Bank::hasChanged() const
+{
+    return changes.changed([this](int box) { return pages.box(box); });
 }
 
 void Bank::convert()
@@ -414,14 +518,18 @@ void Bank::convert()
     }
     stream.close();
 
-    data = new u8[size = sizeof(BankHeader) + sizeof(BankEntry) * oldSize / 232];
-    std::copy(BANK_MAGIC.data(), BANK_MAGIC.data() + BANK_MAGIC.size(), data);
-    ((BankHeader*) data)->version = BANK_VERSION;
-    ((BankHeader*) data)->boxes = oldSize / 232 / 30;
+    std::copy(BANK_MAGIC.data(), BANK_MAGIC.data() + BANK_MAGIC.size(), header.MAGIC);
+    header.version = BANK_VERSION;
+    header.boxes = oldSize / 232 / 30;
     extern nlohmann::json g_banks;
-    g_banks["pksm_1"] = ((BankHeader*) data)->boxes;
-    std::fill_n(data + sizeof(BankHeader), sizeof(BankEntry) * boxes() * 30, 0xFF);
-    boxNames = nlohmann::json::array();
+    g_banks["pksm_1"] = header.boxes;
+    store.attach(*file, Configuration::getInstance().useExtData() ? "/banks/" + bankName + ".bnk" : "/3ds/PKSM/banks/" + bankName + ".bnk", sizeof(BankHeader));
+    pages.close();
+    pages.resize(boxes());
+    changes.reset(sizeof(BankEntry) * 30, boxes());
+    changes.invalidate();
+    headerChanged = true;
+    namesChanged = true;
 
     for (int box = 0; box < std::min((int) oldSize / (232 * 30), boxes()); box++)
     {
@@ -470,10 +578,7 @@ void Bank::convert()
         }
     }
 
-    for (int i = 0; i < boxes(); i++)
-    {
-        boxNames[i] = i18n::localize("STORAGE") + " " + std::to_string(i + 1);
-    }
+    createJSON();
 
 
     stream = FSStream(Archive::sd(), "/3ds/PKSM/backups/bank.bin", FS_OPEN_WRITE, oldSize);
@@ -494,13 +599,87 @@ const std::string& Bank::name() const
     return bankName;
 }
 
+void Bank::indexGlobal()
+{
+    // A bank the cross-bank index does not know, knows at another size or knows from another
+    // revision of its file, such as one imported since, is added whole. That reads every box
+    // once; otherwise boxes wait until they are looked at
+    GlobalBankIndex& global = Banks::index();
+    if (global.contains(bankName) && global.boxes(bankName) == boxes() && global.current(bankName, header.revision))
+    {
+        return;
+    }
+    global.resize(bankName, 0);
+    global.resize(bankName, boxes());
+    global.revision(bankName, header.revision);
+    for (int i = 0; i < boxes() * 30; i++)
+    {
+        // It needs a PKX, for the OT name
+        global.set(bankName, i / 30, i % 30, *pkm(i / 30, i % 30));
+    }
+    Banks::saveIndex();
+}
+
+void Bank::indexBoxes(const std::vector<int>& boxes, const BankChangeTracker::Boxes& data, u32 revision) const
+{
+    // One it does not know yet is added whole once loaded
+    GlobalBankIndex& global = Banks::index();
+    if (!global.contains(bankName))
+    {
+        return;
+    }
+    global.resize(bankName, this->boxes());
+    global.revision(bankName, revision);
+    for (int box : boxes)
+    {
+        for (int slot = 0; slot < 30; slot++)
+        {
+            global.set(bankName, box, slot, *BankBoxStore::readEntry(data(box) + slot * sizeof(BankEntry)));
+        }
+    }
+    Banks::saveIndex();
+}
+
+const BankIndex& Bank::index() const
+{
+    if (!indexed)
+    {
+        slotIndex.resize(boxes() * 30);
+        for (int i = 0; i < boxes() * 30; i++)
+        {
+            if (!view(i / 30, i % 30, [this, i](const auto& pkm) { slotIndex.set(i, pkm); return true; }))
+            {
+                slotIndex.clear(i);
+            }
+        }
+        indexed = true;
+    }
+    return slotIndex;
+}
+
+const BankPager::Stats& Bank::pageStats() const
+{
+    return pages.stats();
+}
+
+void Bank::pageBudget(size_t boxes)
+{
+    pages.budget(boxes);
+}
+
 int Bank::boxes() const
 {
-    return ((BankHeader*)data)->boxes;
+    return header.boxes;
 }
 
 bool Bank::setName(const std::string& name)
 {
+    // The journal waiting to be replayed is found by the bank's name
+    if (damaged)
+    {
+        return false;
+    }
+    WriteQueue::getInstance().flush();
     std::string oldName = bankName;
     bankName = name;
     std::string oldBankPath = Configuration::getInstance().useExtData() ? "/banks/" + oldName + ".bnk" : "/3ds/PKSM/banks/" + oldName + ".bnk";
@@ -523,5 +702,7 @@ bool Bank::setName(const std::string& name)
         }
         return false;
     }
+    pages.moved(newBankPath);
+    store.moved(newBankPath);
     return true;
 }
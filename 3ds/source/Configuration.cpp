@@ -103,6 +103,10 @@ Configuration::Configuration()
                 mJson.erase("storageSize");
                 mJson["showBackups"] = false;
             }
+            if (mJson["version"].get<int>() < 7)
+            {
+                mJson["keptBackups"] = 0;
+            }
 
             mJson["version"] = CURRENT_VERSION;
             save();
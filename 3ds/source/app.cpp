@@ -171,6 +171,7 @@ Result App::init(std::string execPath)
     if (R_FAILED(res = Gui::init()))
         return consoleDisplayError("Gui::init failed.", res);
     
+    WriteQueue::getInstance().start();
     Configuration::getInstance();
     i18n::init();
     if (R_FAILED(res = Banks::init()))
@@ -190,6 +191,8 @@ Result App::init(std::string execPath)
 
 Result App::exit(void)
 {
+    // Everything queued still has to reach the SD card
+    WriteQueue::getInstance().stop();
     TitleLoader::exit();
     Gui::exit();
     socExit();
@@ -25,13 +25,28 @@
 */
 
 #include "banks.hpp"
+#include "ArchiveBankFile.hpp"
+#include "BackupStore.hpp"
+#include "BankJournal.hpp"
 #include "FSStream.hpp"
+#include "WriteQueue.hpp"
 #include "json.hpp"
 #include "archive.hpp"
 
 std::shared_ptr<Bank> Banks::bank = nullptr;
 
 nlohmann::json g_banks;
+static GlobalBankIndex globalIndex;
+
+static FS_Archive indexArchive()
+{
+    return Configuration::getInstance().useExtData() ? Archive::data() : Archive::sd();
+}
+
+static std::string indexPath()
+{
+    return Configuration::getInstance().useExtData() ? "/banks.idx" : "/3ds/PKSM/banks.idx";
+}
 
 static Result saveJson()
 {
@@ -88,6 +103,10 @@ Result Banks::init()
     if (g_banks.is_discarded())
         return -1;
 
+    // Banks missing from it are added as they are loaded
+    ArchiveBankFile file(indexArchive());
+    globalIndex.load(file, indexPath());
+
     auto i = g_banks.find("pksm_1");
     if (i == g_banks.end())
     {
@@ -145,6 +164,8 @@ void Banks::removeBank(const std::string& name)
                 break;
             }
         }
+        globalIndex.remove(name);
+        saveIndex();
     }
 }
 
@@ -179,6 +200,8 @@ void Banks::renameBank(const std::string& oldName, const std::string& newName)
         g_banks[newName] = g_banks[oldName];
         g_banks.erase(oldName);
         saveJson();
+        globalIndex.rename(oldName, newName);
+        saveIndex();
     }
 }
 
@@ -195,18 +218,112 @@ void Banks::setBankSize(const std::string& name, int size)
     }
 }
 
+bool Banks::restoreBank(const std::string& name)
+{
+    if (!g_banks.contains(name))
+    {
+        return false;
+    }
+    // A queued save landing afterwards would undo the restore
+    WriteQueue::getInstance().flush();
+    BackupStore store("/3ds/PKSM/backups/store");
+    std::vector<std::string> snapshots = store.snapshots(name + ".bnk");
+    std::vector<u8> contents;
+    if (snapshots.empty() || !store.restore(name + ".bnk", snapshots.back(), contents) || contents.size() < 16)
+    {
+        return false;
+    }
+    int boxes;
+    memcpy(&boxes, contents.data() + 12, sizeof(int));
+    if (boxes <= 0 || boxes > BANK_MAX_SIZE)
+    {
+        return false;
+    }
+
+    auto archive = Configuration::getInstance().useExtData() ? Archive::data() : Archive::sd();
+    std::string path = Configuration::getInstance().useExtData() ? "/banks/" + name : "/3ds/PKSM/banks/" + name;
+    ArchiveBankFile file(archive);
+    // Through the journal, which also drops one a damaged bank could not replay
+    if (!BankJournal(file, path + ".bnk").commit({{0, contents}}, contents.size()))
+    {
+        return false;
+    }
+    // Box names backed up alongside it; the bank makes new ones if they are missing
+    std::vector<u8> names;
+    if (store.restore(name + ".json", snapshots.back(), names))
+    {
+        FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(path + ".json").c_str()));
+        FSStream out(archive, path + ".json", FS_OPEN_WRITE, names.size());
+        if (out.good())
+        {
+            out.write(names.data(), names.size());
+        }
+        out.close();
+    }
+
+    g_banks[name] = boxes;
+    saveJson();
+    // The backup may have the very revision the index last saw, so its record goes and
+    // loading the bank indexes it again
+    globalIndex.remove(name);
+    saveIndex();
+    if (bank && bank->name() == name)
+    {
+        bank->load(boxes);
+    }
+    return true;
+}
+
 Result Banks::swapSD(bool toSD)
 {
     Result res = 0;
+    WriteQueue::getInstance().flush();
     if (toSD)
     {
         if (R_FAILED(res = Archive::moveDir(Archive::data(), "/banks", Archive::sd(), "/3ds/PKSM/banks"))) return res;
         if (R_FAILED(res = Archive::moveFile(Archive::data(), "/banks.json", Archive::sd(), "/3ds/PKSM/banks.json"))) return res;
+        // The index is rebuilt as banks load if it cannot follow
+        Archive::moveFile(Archive::data(), "/banks.idx", Archive::sd(), "/3ds/PKSM/banks.idx");
     }
     else
     {
         if (R_FAILED(res = Archive::moveDir(Archive::sd(), "/3ds/PKSM/banks", Archive::data(), "/banks"))) return res;
         if (R_FAILED(res = Archive::moveFile(Archive::sd(), "/3ds/PKSM/banks.json", Archive::data(), "/banks.json"))) return res;
+        Archive::moveFile(Archive::sd(), "/3ds/PKSM/banks.idx", Archive::data(), "/banks.idx");
     }
     return res;
 }
+
+GlobalBankIndex& Banks::index()
+{
+    return globalIndex;
+}
+
+void Banks::saveIndex()
+{
+    WriteQueue::getInstance().push([archive = indexArchive(), path = indexPath(), contents = globalIndex.serialize()]() {
+        ArchiveBankFile file(archive);
+        return GlobalBankIndex::save(file, path, contents);
+    });
+}
+
+std::vector<std::vector<DuplicateFinder::Location>> Banks::duplicates(const Sav* save, DuplicateFinder::Match match)
+{
+    DuplicateFinder finder(match);
+    finder.reserve((save ? save->maxSlot() : 0) + (bank ? bank->boxes() * 30 : 0));
+    if (save)
+    {
+        for (int i = 0; i < save->maxSlot(); i++)
+        {
+            save->view(i / 30, i % 30, [&finder, i](const auto& pkm) { finder.add(0, i / 30, i % 30, pkm); });
+        }
+    }
+    if (bank)
+    {
+        for (int i = 0; i < bank->boxes() * 30; i++)
+        {
+            bank->view(i / 30, i % 30, [&finder, i](const auto& pkm) { finder.add(1, i / 30, i % 30, pkm); });
+        }
+    }
+    return finder.groups();
+}
@@ -25,6 +25,7 @@
 */
 
 #include "gui.hpp"
+#include "WriteQueue.hpp"
 
 C3D_RenderTarget* g_renderTargetTop;
 C3D_RenderTarget* g_renderTargetBottom;
@@ -368,6 +369,7 @@ void Gui::mainLoop(void)
 
         C3D_FrameEnd(0);
         Gui::clearTextBufs();
+        WriteQueue::getInstance().poll();
         if (keyboardFunc != nullptr)
         {
             keyboardFunc();
@@ -907,15 +909,20 @@ void Gui::sprite(int key, int x, int y, u32 color)
 }
 
 void Gui::pkm(const PKX& pokemon, int x, int y, float scale, u32 color, float blend)
+{
+    pkmIcon(pokemon.species(), pokemon.alternativeForm(), pokemon.generation(), pokemon.gender(), pokemon.egg(), pokemon.heldItem() > 0, pokemon.shiny(), x, y, scale, color, blend);
+}
+
+void Gui::pkmIcon(int species, int form, Generation generation, int gender, bool egg, bool item, bool shiny, int x, int y, float scale, u32 color, float blend)
 {
     static C2D_ImageTint tint;
     C2D_PlainImageTint(&tint, color, blend);
 
-    if (pokemon.egg())
+    if (egg)
     {
-        if (pokemon.species() != 490)
+        if (species != 490)
         {
-            pkm(pokemon.species(), pokemon.alternativeForm(), pokemon.generation(), pokemon.gender(), x, y, scale, color, blend);
+            pkm(species, form, generation, gender, x, y, scale, color, blend);
             C2D_DrawImageAt(C2D_SpriteSheetGetImage(spritesheet_pkm, pkm_spritesheet_0_idx), x - 13 + ceilf(3 * scale), y + 4 + 30 * (scale - 1), 0.5f, &tint);
         }
         else
@@ -925,14 +932,14 @@ void Gui::pkm(const PKX& pokemon, int x, int y, float scale, u32 color, float bl
     }
     else
     {
-        pkm(pokemon.species(), pokemon.alternativeForm(), pokemon.generation(), pokemon.gender(), x, y, scale, color, blend);
-        if (pokemon.heldItem() > 0)
+        pkm(species, form, generation, gender, x, y, scale, color, blend);
+        if (item)
         {
             C2D_DrawImageAt(C2D_SpriteSheetGetImage(spritesheet_ui, ui_sheet_icon_item_idx), x + ceilf(3 * scale), y + 21 + ceilf(30 * (scale - 1)), 0.5f, &tint);
         }
     }
 
-    if (pokemon.shiny())
+    if (shiny)
     {
         C2D_DrawImageAt(C2D_SpriteSheetGetImage(spritesheet_ui, ui_sheet_icon_shiny_idx), x, y, 0.5f, &tint);
     }
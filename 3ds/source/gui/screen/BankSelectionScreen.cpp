@@ -31,7 +31,7 @@ void BankSelectionScreen::draw() const
 {
     C2D_SceneBegin(g_renderTargetBottom);
     Gui::sprite(ui_sheet_part_info_bottom_idx, 0, 0);
-    Gui::staticText(i18n::localize("X_RENAME") + "\n" + i18n::localize("Y_RESIZE") + "\n" + i18n::localize("START_DELETE"), 160, 120, FONT_SIZE_18, FONT_SIZE_18, COLOR_BLACK, TextPosX::CENTER, TextPosY::CENTER);
+    Gui::staticText(i18n::localize("X_RENAME") + "\n" + i18n::localize("Y_RESIZE") + "\n" + i18n::localize("START_DELETE") + "\n" + i18n::localize("SELECT_RESTORE"), 160, 120, FONT_SIZE_18, FONT_SIZE_18, COLOR_BLACK, TextPosX::CENTER, TextPosY::CENTER);
 
     C2D_SceneBegin(g_renderTargetTop);
     Gui::sprite(ui_sheet_part_editor_20x2_idx, 0, 0);
@@ -100,6 +100,33 @@ void BankSelectionScreen::update(touchPosition* touch)
             }
         }
     }
+    else if (downKeys & KEY_SELECT)
+    {
+        // The last entry is a bank yet to be made, with nothing backed up
+        if (hid.fullIndex() == strings.size() - 1)
+        {
+            return;
+        }
+        auto& bank = strings[hid.fullIndex()];
+        if (Gui::showChoiceMessage(StringUtils::format(i18n::localize("BANK_RESTORE"), bank.first.c_str())))
+        {
+            if (Banks::restoreBank(bank.first))
+            {
+                // It comes back at the size it was backed up at
+                for (auto& restored : Banks::bankNames())
+                {
+                    if (restored.first == bank.first)
+                    {
+                        bank.second = restored.second;
+                    }
+                }
+            }
+            else
+            {
+                Gui::warn(i18n::localize("BANK_RESTORE_ERROR"));
+            }
+        }
+    }
 }
 
 std::pair<std::string, int> BankSelectionScreen::run()
@@ -279,11 +279,13 @@ void StorageScreen::draw() const
             }
             else
             {
-                std::shared_ptr<PKX> pokemon = TitleLoader::save->pkm(boxBox, row * 6 + column);
-                if (pokemon->species() > 0)
-                {
-                    Gui::pkm(*pokemon, x, y);
-                }
+                // Box data is decrypted while this screen is open, so slots are drawn in place
+                TitleLoader::save->view(boxBox, row * 6 + column, [x, y](const auto& pokemon) {
+                    if (pokemon.species() > 0)
+                    {
+                        Gui::pkm(pokemon, x, y);
+                    }
+                });
                 if (TitleLoader::save->generation() == Generation::LGPE)
                 {
                     int partySlot = std::distance(partyPkm, std::find(partyPkm, partyPkm + 6, boxBox * 30 + row * 6 + column));
@@ -431,11 +433,12 @@ void StorageScreen::draw() const
             {
                 C2D_DrawRectSolid(x, y, 0.5f, 34, 30, C2D_Color32(0x50, 0xC0, 0x40, 0xC0));
             }
-            auto pkm = Banks::bank->pkm(storageBox, row * 6 + column);
-            if (pkm->species() > 0)
-            {
-                Gui::pkm(*pkm, x, y);
-            }
+            Banks::bank->view(storageBox, row * 6 + column, [x, y](const auto& pokemon) {
+                if (pokemon.species() > 0)
+                {
+                    Gui::pkm(pokemon, x, y);
+                }
+            });
             x += 34;
         }
         y += 30;
@@ -1011,61 +1014,11 @@ bool StorageScreen::isValidTransfer(std::shared_ptr<PKX> moveMon, bool bulkTrans
     {
         return false;
     }
-    bool moveBad = false;
-    for (int i = 0; i < 4; i++)
-    {
-        if (moveMon->move(i) > TitleLoader::save->maxMove())
-        {
-            moveBad = true;
-            break;
-        }
-        if (moveMon->generation() == Generation::SIX)
-        {
-            PK6* pk6 = (PK6*) moveMon.get();
-            if (pk6->relearnMove(i) > TitleLoader::save->maxMove())
-            {
-                moveBad = true;
-                break;
-            }
-        }
-        else if (moveMon->generation() == Generation::SEVEN)
-        {
-            PK7* pk7 = (PK7*) moveMon.get();
-            if (pk7->relearnMove(i) > TitleLoader::save->maxMove())
-            {
-                moveBad = true;
-                break;
-            }
-        }
-    }
-    if (moveBad)
-    {
-        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_MOVE"));
-        return false;
-    }
-    else if (moveMon->species() > TitleLoader::save->maxSpecies())
-    {
-        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_SPECIES"));
-        return false;
-    }
-    else if (moveMon->alternativeForm() > TitleLoader::save->formCount(moveMon->species()) && !((moveMon->species() == 664 || moveMon->species() == 665) && moveMon->alternativeForm() <= TitleLoader::save->formCount(666)))
-    {
-        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_FORM"));
-        return false;
-    }
-    else if (moveMon->ability() > TitleLoader::save->maxAbility())
-    {
-        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_ABILITY"));
-        return false;
-    }
-    else if (moveMon->heldItem() > TitleLoader::save->maxItem())
+    static const std::string reasons[] = {"", "STORAGE_BAD_MOVE", "STORAGE_BAD_SPECIES", "STORAGE_BAD_FORM", "STORAGE_BAD_ABILITY", "STORAGE_BAD_ITEM", "STORAGE_BAD_BALL"};
+    TransferError error = TitleLoader::save->transferError(*moveMon);
+    if (error != TransferError::NONE)
     {
-        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_ITEM"));
-        return false;
-    }
-    else if (moveMon->ball() > TitleLoader::save->maxBall())
-    {
-        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize("STORAGE_BAD_BALL"));
+        if (!bulkTransfer) Gui::warn(i18n::localize("STORAGE_BAD_TRANFER"), i18n::localize(reasons[(int)error]));
         return false;
     }
     return true;
@@ -1447,6 +1400,125 @@ bool StorageScreen::pickSort(size_t number)
     return false;
 }
 
+// Ranks strings so they can be sorted as numbers: equal strings share a rank,
+// and ranks follow std::string ordering
+static void rankStrings(const std::vector<std::string>& strings, u32* out, size_t stride)
+{
+    std::vector<std::string> unique = strings;
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+    for (size_t i = 0; i < strings.size(); i++)
+    {
+        out[i * stride] = std::lower_bound(unique.begin(), unique.end(), strings[i]) - unique.begin();
+    }
+}
+
+// Writes one key per Pokémon, every stride entries, such that ascending keys give the sort order
+static void sortKeys(const std::vector<std::shared_ptr<PKX>>& pkms, SortType type, u32* out, size_t stride)
+{
+    if (type == NICKNAME || type == SPECIESNAME || type == OTNAME)
+    {
+        std::vector<std::string> strings;
+        strings.reserve(pkms.size());
+        for (auto& pkm : pkms)
+        {
+            switch (type)
+            {
+                case NICKNAME:
+                    strings.push_back(pkm->nickname());
+                    break;
+                case SPECIESNAME:
+                    strings.push_back(i18n::species(Configuration::getInstance().language(), pkm->species()));
+                    break;
+                default:
+                    strings.push_back(pkm->otName());
+                    break;
+            }
+        }
+        rankStrings(strings, out, stride);
+        return;
+    }
+
+    for (size_t i = 0; i < pkms.size(); i++)
+    {
+        const PKX& pkm = *pkms[i];
+        u32 key = 0;
+        switch (type)
+        {
+            case DEX:
+                key = pkm.species();
+                break;
+            case FORM:
+                key = pkm.alternativeForm();
+                break;
+            case TYPE1:
+                key = pkm.type1();
+                break;
+            case TYPE2:
+                key = pkm.type2();
+                break;
+            case HP:
+                key = pkm.stat(0);
+                break;
+            case ATK:
+                key = pkm.stat(1);
+                break;
+            case DEF:
+                key = pkm.stat(2);
+                break;
+            case SATK:
+                key = pkm.stat(4);
+                break;
+            case SDEF:
+                key = pkm.stat(5);
+                break;
+            case SPE:
+                key = pkm.stat(3);
+                break;
+            case NATURE:
+                key = pkm.nature();
+                break;
+            case LEVEL:
+                key = pkm.level();
+                break;
+            case TID:
+                key = pkm.TID();
+                break;
+            case HPIV:
+                key = pkm.iv(0);
+                break;
+            case ATKIV:
+                key = pkm.iv(1);
+                break;
+            case DEFIV:
+                key = pkm.iv(2);
+                break;
+            case SATKIV:
+                key = pkm.iv(4);
+                break;
+            case SDEFIV:
+                key = pkm.iv(5);
+                break;
+            case SPEIV:
+                key = pkm.iv(3);
+                break;
+            case HIDDENPOWER:
+                key = pkm.hpType();
+                break;
+            case FRIENDSHIP:
+                key = pkm.currentFriendship();
+                break;
+            case SHINY:
+                // shiny Pokémon come first
+                key = pkm.shiny() ? 0 : 1;
+                break;
+            default:
+                break;
+        }
+        out[i * stride] = key;
+    }
+}
+
 bool StorageScreen::sort()
 {
     while (!sortTypes.empty() && sortTypes.back() == NONE)
@@ -1482,118 +1554,31 @@ bool StorageScreen::sort()
                 }
             }
         }
-        std::stable_sort(sortMe.begin(), sortMe.end(), [this](const std::shared_ptr<PKX>& pkm1, const std::shared_ptr<PKX>& pkm2){
-            for (auto type : sortTypes)
-            {
-                switch (type)
-                {
-                    case DEX:
-                        if (pkm1->species() < pkm2->species()) return true;
-                        if (pkm2->species() < pkm1->species()) return false;
-                        break;
-                    case FORM:
-                        if (pkm1->alternativeForm() < pkm2->alternativeForm()) return true;
-                        if (pkm2->alternativeForm() < pkm1->alternativeForm()) return false;
-                        break;
-                    case TYPE1:
-                        if (pkm1->type1() < pkm2->type1()) return true;
-                        if (pkm2->type1() < pkm1->type1()) return false;
-                        break;
-                    case TYPE2:
-                        if (pkm1->type2() < pkm2->type2()) return true;
-                        if (pkm2->type2() < pkm1->type2()) return false;
-                        break;
-                    case HP:
-                        if (pkm1->stat(0) < pkm2->stat(0)) return true;
-                        if (pkm2->stat(0) < pkm1->stat(0)) return false;
-                        break;
-                    case ATK:
-                        if (pkm1->stat(1) < pkm2->stat(1)) return true;
-                        if (pkm2->stat(1) < pkm1->stat(1)) return false;
-                        break;
-                    case DEF:
-                        if (pkm1->stat(2) < pkm2->stat(2)) return true;
-                        if (pkm2->stat(2) < pkm1->stat(2)) return false;
-                        break;
-                    case SATK:
-                        if (pkm1->stat(4) < pkm2->stat(4)) return true;
-                        if (pkm2->stat(4) < pkm1->stat(4)) return false;
-                        break;
-                    case SDEF:
-                        if (pkm1->stat(5) < pkm2->stat(5)) return true;
-                        if (pkm2->stat(5) < pkm1->stat(5)) return false;
-                        break;
-                    case SPE:
-                        if (pkm1->stat(3) < pkm2->stat(3)) return true;
-                        if (pkm2->stat(3) < pkm1->stat(3)) return false;
-                        break;
-                    case NATURE:
-                        if (pkm1->nature() < pkm2->nature()) return true;
-                        if (pkm2->nature() < pkm1->nature()) return false;
-                        break;
-                    case LEVEL:
-                        if (pkm1->level() < pkm2->level()) return true;
-                        if (pkm2->level() < pkm1->level()) return false;
-                        break;
-                    case TID:
-                        if (pkm1->TID() < pkm2->TID()) return true;
-                        if (pkm2->TID() < pkm1->TID()) return false;
-                        break;
-                    case HPIV:
-                        if (pkm1->iv(0) < pkm2->iv(0)) return true;
-                        if (pkm2->iv(0) < pkm1->iv(0)) return false;
-                        break;
-                    case ATKIV:
-                        if (pkm1->iv(1) < pkm2->iv(1)) return true;
-                        if (pkm2->iv(1) < pkm1->iv(1)) return false;
-                        break;
-                    case DEFIV:
-                        if (pkm1->iv(2) < pkm2->iv(2)) return true;
-                        if (pkm2->iv(2) < pkm1->iv(2)) return false;
-                        break;
-                    case SATKIV:
-                        if (pkm1->iv(4) < pkm2->iv(4)) return true;
-                        if (pkm2->iv(4) < pkm1->iv(4)) return false;
-                        break;
-                    case SDEFIV:
-                        if (pkm1->iv(5) < pkm2->iv(5)) return true;
-                        if (pkm2->iv(5) < pkm1->iv(5)) return false;
-                        break;
-                    case SPEIV:
-                        if (pkm1->iv(3) < pkm2->iv(3)) return true;
-                        if (pkm2->iv(3) < pkm1->iv(3)) return false;
-                        break;
-                    case HIDDENPOWER:
-                        if (pkm1->hpType() < pkm2->hpType()) return true;
-                        if (pkm2->hpType() < pkm1->hpType()) return false;
-                        break;
-                    case FRIENDSHIP:
-                        if (pkm1->currentFriendship() < pkm2->currentFriendship()) return true;
-                        if (pkm2->currentFriendship() < pkm1->currentFriendship()) return false;
-                        break;
-                    case NICKNAME:
-                        if (pkm1->nickname() < pkm2->nickname()) return true;
-                        if (pkm2->nickname() < pkm1->nickname()) return false;
-                        break;
-                    case SPECIESNAME:
-                        if (i18n::species(Configuration::getInstance().language(), pkm1->species()) < i18n::species(Configuration::getInstance().language(), pkm2->species())) return true;
-                        if (i18n::species(Configuration::getInstance().language(), pkm2->species()) < i18n::species(Configuration::getInstance().language(), pkm1->species())) return false;
-                        break;
-                    case OTNAME:
-                        if (pkm1->otName() < pkm2->otName()) return true;
-                        if (pkm2->otName() < pkm1->otName()) return false;
-                        break;
-                    case SHINY:
-                        if (pkm1->shiny() && !pkm2->shiny()) return true;
-                        if (pkm2->shiny() && !pkm1->shiny()) return false;
-                        break;
-                    default:
-                        break;
-                }
-            }
-            return false;
+        // Read every key once up front, then sort indices on the packed keys
+        const size_t keyCount = sortTypes.size();
+        std::vector<u32> keys(sortMe.size() * keyCount);
+        for (size_t key = 0; key < keyCount; key++)
+        {
+            sortKeys(sortMe, sortTypes[key], keys.data() + key, keyCount);
+        }
+
+        std::vector<u32> order(sortMe.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&keys, keyCount](u32 pkm1, u32 pkm2){
+            return std::lexicographical_compare(keys.begin() + pkm1 * keyCount, keys.begin() + (pkm1 + 1) * keyCount,
+                keys.begin() + pkm2 * keyCount, keys.begin() + (pkm2 + 1) * keyCount);
         });
 
+        std::vector<std::shared_ptr<PKX>> sorted(sortMe.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            sorted[i] = std::move(sortMe[order[i]]);
+        }
+        sortMe = std::move(sorted);
+
         if (storageChosen)
         {
             for (size_t i = 0; i < sortMe.size(); i++)
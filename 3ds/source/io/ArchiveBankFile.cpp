@@ -0,0 +1,100 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "ArchiveBankFile.hpp"
+#include "FSStream.hpp"
+
+bool ArchiveBankFile::read(const std::string& path, std::vector<u8>& out)
+{
+    FSStream in(archive, path, FS_OPEN_READ);
+    if (!in.good())
+    {
+        in.close();
+        return false;
+    }
+    out.resize(in.size());
+    bool good = in.read(out.data(), out.size()) == out.size();
+    in.close();
+    return good;
+}
+
+bool ArchiveBankFile::read(const std::string& path, u32 offset, u8* data, u32 size)
+{
+    FSStream in(archive, path, FS_OPEN_READ);
+    if (!in.good())
+    {
+        in.close();
+        return false;
+    }
+    in.seek(offset, SEEK_SET);
+    bool good = in.read(data, size) == size;
+    in.close();
+    return good;
+}
+
+bool ArchiveBankFile::write(const std::string& path, u32 offset, const u8* data, u32 size)
+{
+    FSStream out(archive, path, FS_OPEN_WRITE, offset + size);
+    if (!out.good())
+    {
+        return false;
+    }
+    out.seek(offset, SEEK_SET);
+    bool good = out.write(data, size) == size;
+    out.close();
+    return good;
+}
+
+bool ArchiveBankFile::resize(const std::string& path, u32 size)
+{
+    std::u16string path16 = StringUtils::UTF8toUTF16(path);
+    FS_Path fsPath = fsMakePath(PATH_UTF16, path16.c_str());
+    Handle handle;
+    if (R_SUCCEEDED(FSUSER_OpenFile(&handle, archive, fsPath, FS_OPEN_WRITE, 0)))
+    {
+        u64 oldSize = 0;
+        FSFILE_GetSize(handle, &oldSize);
+        Result res = oldSize == size ? 0 : FSFILE_SetSize(handle, size);
+        FSFILE_Close(handle);
+        if (R_SUCCEEDED(res))
+        {
+            return true;
+        }
+    }
+
+    // Extdata files cannot change size, so they are recreated around their contents.
+    // Anything not rewritten afterwards is lost if this is interrupted
+    std::vector<u8> contents;
+    read(path, contents);
+    contents.resize(size, 0xFF);
+    FSUSER_DeleteFile(archive, fsPath);
+    return R_SUCCEEDED(FSUSER_CreateFile(archive, fsPath, 0, size)) && write(path, 0, contents.data(), size);
+}
+
+bool ArchiveBankFile::remove(const std::string& path)
+{
+    return R_SUCCEEDED(FSUSER_DeleteFile(archive, fsMakePath(PATH_UTF16, StringUtils::UTF8toUTF16(path).c_str())));
+}
@@ -25,11 +25,14 @@
 */
 
 #include "loader.hpp"
+#include "BackupStore.hpp"
 #include "Configuration.hpp"
 #include "Directory.hpp"
 #include "FSStream.hpp"
+#include "WriteQueue.hpp"
 #include <ctime>
 #include <sys/stat.h>
+#include <utility>
 
 static constexpr char langIds[8] = {
     'E', //USA
@@ -196,6 +199,72 @@ static std::vector<std::string> scanDirectoryFor(const std::u16string& dir, cons
     return ret;
 }
 
+// Backups are snapshots in a deduplicated store, listed as saves by their manifest paths
+static const std::string backupStore = "/3ds/PKSM/backups/store";
+static const std::string snapshotPrefix = backupStore + "/snapshots/";
+
+static bool isSnapshot(const std::string& path)
+{
+    return path.compare(0, snapshotPrefix.size(), snapshotPrefix) == 0;
+}
+
+static std::string snapshotName(const std::string& path)
+{
+    return path.substr(snapshotPrefix.size(), path.find('/', snapshotPrefix.size()) - snapshotPrefix.size());
+}
+
+// What gets written is a copy, so the save can be edited again while it is
+static std::vector<u8> saveContents()
+{
+    const u8* data = std::as_const(*TitleLoader::save).rawData();
+    return std::vector<u8>(data, data + TitleLoader::save->getLength());
+}
+
+// Replaces a title's save with contents on the writer thread, committing it to the archive
+static void writeTitleSave(std::shared_ptr<Title> title, std::vector<u8> contents)
+{
+    auto failure = std::make_shared<std::pair<std::string, Result>>();
+    WriteQueue::getInstance().push(
+        [title, contents = std::move(contents), failure]() {
+            FS_Archive archive;
+            Archive::save(&archive, title->mediaType(), title->lowId(), title->highId());
+            FSStream out(archive, u"/main", FS_OPEN_WRITE | FS_OPEN_CREATE, contents.size());
+            Result res;
+            if (!out.good())
+            {
+                *failure = {"BAD_OPEN_SAVE", out.result()};
+            }
+            else
+            {
+                out.write(contents.data(), contents.size());
+                if (R_FAILED(res = FSUSER_ControlArchive(archive, ARCHIVE_ACTION_COMMIT_SAVE_DATA, NULL, 0, NULL, 0)))
+                {
+                    *failure = {"FAIL_SAVE_COMMIT", res};
+                }
+            }
+            out.close();
+            FSUSER_CloseArchive(archive);
+            return failure->first.empty();
+        },
+        [failure](bool good) {
+            if (!good)
+            {
+                Gui::error(i18n::localize(failure->first), failure->second);
+            }
+        });
+}
+
+static std::vector<std::string> scanSnapshotsFor(const std::string& id)
+{
+    std::vector<std::string> ret;
+    BackupStore store(backupStore);
+    for (auto& snapshot : store.snapshots(id))
+    {
+        ret.push_back(store.snapshotPath(id, snapshot));
+    }
+    return ret;
+}
+
 void TitleLoader::scanSaves(void)
 {
     static const std::u16string chkpntDir = u"/3ds/Checkpoint/saves";
@@ -208,6 +277,8 @@ void TitleLoader::scanSaves(void)
         {
             std::vector<std::string> moreSaves = scanDirectoryFor(u"/3ds/PKSM/backups", id);
             saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
+            moreSaves = scanSnapshotsFor(id);
+            saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
         }
         auto extraSaves = Configuration::getInstance().extraSaves(id);
         if (!extraSaves.empty())
@@ -233,6 +304,8 @@ void TitleLoader::scanSaves(void)
             {
                 std::vector<std::string> moreSaves = scanDirectoryFor(u"/3ds/PKSM/backups", id);
                 saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
+                moreSaves = scanSnapshotsFor(id);
+                saves.insert(saves.end(), moreSaves.begin(), moreSaves.end());
             }
             auto extraSaves = Configuration::getInstance().extraSaves(id);
             if (!extraSaves.empty())
@@ -256,26 +329,31 @@ void TitleLoader::backupSave(const std::string& id)
     {
         return;
     }
-    Gui::waitFrame(i18n::localize("LOADER_BACKING_UP"));
     char stringTime[15] = {0};
     time_t unixTime = time(NULL);
     struct tm* timeStruct = gmtime((const time_t *)&unixTime);
     std::strftime(stringTime, 14,"%Y%m%d%H%M%S", timeStruct);
-    std::string path = "/3ds/PKSM/backups/" + id;
-    mkdir(path.c_str(), 777);
-    path += '/' + std::string(stringTime);
-    mkdir(path.c_str(), 777);
-    path += idToSaveName(id);
-    FSStream out = FSStream(Archive::sd(), path, FS_OPEN_WRITE | FS_OPEN_CREATE, TitleLoader::save->getLength());
-    if (out.good())
-    {
-        out.write(TitleLoader::save->rawData(), TitleLoader::save->getLength());
-    }
-    else
-    {
-        Gui::warn(i18n::localize("BAD_OPEN_BACKUP"));
-    }
-    out.close();
+    // Only the parts of the save that differ from earlier backups are written. Older snapshots
+    // are only dropped when the configuration sets how many to keep
+    WriteQueue::getInstance().push(
+        [id, snapshot = std::string(stringTime), contents = saveContents(), kept = Configuration::getInstance().keptBackups()]() {
+            BackupStore store(backupStore);
+            if (!store.backup(id, snapshot, contents.data(), contents.size()))
+            {
+                return false;
+            }
+            if (kept > 0 && store.prune(id, kept))
+            {
+                store.collectGarbage();
+            }
+            return true;
+        },
+        [](bool good) {
+            if (!good)
+            {
+                Gui::warn(i18n::localize("BAD_OPEN_BACKUP"));
+            }
+        });
 }
 
 bool TitleLoader::load(u8* data, size_t size)
@@ -349,26 +427,41 @@ bool TitleLoader::load(std::shared_ptr<Title> title, const std::string& savePath
     saveIsFile = true;
     saveFileName = savePath;
     loadedTitle = title;
-    FSStream in(Archive::sd(), StringUtils::UTF8toUTF16(savePath), FS_OPEN_READ);
-    u32 size;
-    u8* saveData = nullptr;
-    if (in.good())
+    if (isSnapshot(savePath))
     {
-        size = in.size();
-        saveData = new u8[size];
-        in.read(saveData, size);
+        std::vector<u8> saveData;
+        if (!BackupStore(backupStore).restore(savePath, saveData))
+        {
+            Gui::warn(savePath, i18n::localize("SAVE_INVALID"));
+            loadedTitle = nullptr;
+            saveFileName = "";
+            return false;
+        }
+        save = Sav::getSave(saveData.data(), saveData.size());
     }
     else
     {
-        Gui::error(i18n::localize("BAD_OPEN_SAVE"), in.result());
-        loadedTitle = nullptr;
-        saveFileName = "";
+        FSStream in(Archive::sd(), StringUtils::UTF8toUTF16(savePath), FS_OPEN_READ);
+        u32 size;
+        u8* saveData = nullptr;
+        if (in.good())
+        {
+            size = in.size();
+            saveData = new u8[size];
+            in.read(saveData, size);
+        }
+        else
+        {
+            Gui::error(i18n::localize("BAD_OPEN_SAVE"), in.result());
+            loadedTitle = nullptr;
+            saveFileName = "";
+            in.close();
+            return false;
+        }
         in.close();
-        return false;
+        save = Sav::getSave(saveData, size);
+        delete[] saveData;
     }
-    in.close();
-    save = Sav::getSave(saveData, size);
-    delete[] saveData;
     if (!save)
     {
         Gui::warn(saveFileName, i18n::localize("SAVE_INVALID"));
@@ -405,7 +498,6 @@ bool TitleLoader::load(std::shared_ptr<Title> title, const std::string& savePath
 
 void TitleLoader::saveToTitle(bool ask)
 {
-    Result res;
     if (loadedTitle)
     {
         if (TitleLoader::cardTitle == loadedTitle && (!ask || Gui::showChoiceMessage(i18n::localize("SAVE_OVERWRITE_1"), i18n::localize("SAVE_OVERWRITE_CARD"))))
@@ -413,34 +505,16 @@ void TitleLoader::saveToTitle(bool ask)
             auto& title = TitleLoader::cardTitle;
             if (title->cardType() == FS_CardType::CARD_CTR)
             {
-                FS_Archive archive;
-                Archive::save(&archive, title->mediaType(), title->lowId(), title->highId());
-                FSStream out(archive, u"/main", FS_OPEN_WRITE | FS_OPEN_CREATE, save->getLength());
-                if (out.good())
-                {
-                    out.write(save->rawData(), save->getLength());
-                    if (R_FAILED(res = FSUSER_ControlArchive(archive, ARCHIVE_ACTION_COMMIT_SAVE_DATA, NULL, 0, NULL, 0)))
-                    {
-                        out.close();
-                        FSUSER_CloseArchive(archive);
-                        Gui::error(i18n::localize("FAIL_SAVE_COMMIT"), res);
-                        return;
-                    }
-                }
-                else
-                {
-                    Gui::error(i18n::localize("BAD_OPEN_SAVE"), out.result());
-                }
-                out.close();
-                FSUSER_CloseArchive(archive);
+                writeTitleSave(title, saveContents());
             }
             else
             {
+                // Written here rather than queued so the progress can be shown
                 Result res = 0;
                 u32 pageSize = SPIGetPageSize(title->SPICardType());
                 for (u32 i = 0; i < save->getLength() / pageSize; ++i)
                 {
-                    res = SPIWriteSaveData(title->SPICardType(), pageSize * i, save->rawData() + pageSize * i, pageSize);
+                    res = SPIWriteSaveData(title->SPICardType(), pageSize * i, (u8*)std::as_const(*save).rawData() + pageSize * i, pageSize);
                     if (R_FAILED(res))
                     {
                         break;
@@ -456,26 +530,7 @@ void TitleLoader::saveToTitle(bool ask)
             {
                 if (title == loadedTitle && (!ask || Gui::showChoiceMessage(i18n::localize("SAVE_OVERWRITE_1"), i18n::localize("SAVE_OVERWRITE_INSTALL"))))
                 {
-                    FS_Archive archive;
-                    Archive::save(&archive, title->mediaType(), title->lowId(), title->highId());
-                    FSStream out(archive, u"/main", FS_OPEN_WRITE | FS_OPEN_CREATE, save->getLength());
-                    if (out.good())
-                    {
-                        out.write(save->rawData(), save->getLength());
-                        if (R_FAILED(res = FSUSER_ControlArchive(archive, ARCHIVE_ACTION_COMMIT_SAVE_DATA, NULL, 0, NULL, 0)))
-                        {
-                            out.close();
-                            FSUSER_CloseArchive(archive);
-                            Gui::error(i18n::localize("FAIL_SAVE_COMMIT"), res);
-                            return;
-                        }
-                    }
-                    else
-                    {
-                        Gui::error(i18n::localize("BAD_OPEN_SAVE"), out.result());
-                    }
-                    out.close();
-                    FSUSER_CloseArchive(archive);
+                    writeTitleSave(title, saveContents());
                     break; // There can only be one match
                 }
             }
@@ -488,10 +543,32 @@ void TitleLoader::saveChanges()
     save->resign();
     if (saveIsFile)
     {
-        // No need to check size; if it was read successfully, that means that it has the correct size
-        FSStream out(Archive::sd(), StringUtils::UTF8toUTF16(saveFileName), FS_OPEN_WRITE);
-        out.write(save->rawData(), save->getLength());
-        out.close();
+        if (isSnapshot(saveFileName))
+        {
+            // Snapshots are never changed; the edited save becomes a new one
+            backupSave(snapshotName(saveFileName));
+        }
+        else
+        {
+            // No need to check size; if it was read successfully, that means that it has the correct size
+            WriteQueue::getInstance().push(
+                [path = StringUtils::UTF8toUTF16(saveFileName), contents = saveContents()]() {
+                    FSStream out(Archive::sd(), path, FS_OPEN_WRITE);
+                    bool good = out.good();
+                    if (good)
+                    {
+                        out.write(contents.data(), contents.size());
+                    }
+                    out.close();
+                    return good;
+                },
+                [](bool good) {
+                    if (!good)
+                    {
+                        Gui::warn(i18n::localize("BAD_OPEN_SAVE"));
+                    }
+                });
+        }
         if (Configuration::getInstance().writeFileSave())
         {
             saveToTitle(true);
@@ -30,293 +30,6 @@
 #include <map>
 #include <queue>
 
-static std::wstring_convert<std::codecvt_utf8_utf16<char16_t>,char16_t> convert;
-
-std::string StringUtils::format(const std::string& fmt_str, ...)
-{
-    va_list ap;
-    char *fp = NULL;
-    va_start(ap, fmt_str);
-    vasprintf(&fp, fmt_str.c_str(), ap);
-    va_end(ap);
-    std::unique_ptr<char, decltype(free)*> formatted(fp, free);
-    return std::string(formatted.get());
-}
-
-std::u16string StringUtils::UTF8toUTF16(const std::string& src)
-{
-    return convert.from_bytes(src);
-}
-
-std::string StringUtils::UTF16toUTF8(const std::u16string& src)
-{
-    return convert.to_bytes(src);
-}
-
-std::string StringUtils::getString(const u8* data, int ofs, int len)
-{
-    len *= 2;
-    u8 buffer[len];
-    std::copy(data + ofs, data + ofs + len, buffer);
-    std::string dst = convert.to_bytes((char16_t*)buffer);
-    return dst;
-}
-
-std::string StringUtils::getTrimmedString(const u8* data, int ofs, int len, char* substr)
-{
-    std::string str = getString(data, ofs, len);
-    size_t found = str.find(substr);
-    return found != std::string::npos ? str.substr(0, found) : str;
-}
-
-void StringUtils::setString(u8* data, const std::string& v, int ofs, int len)
-{
-    len *= 2;
-    u8 toinsert[len] = {0};
-    if (v.empty()) return;
-    
-    char buf;
-    int nicklen = v.length(), r = 0, w = 0, i = 0;
-    while (r < nicklen || w > len)
-    {
-        buf = v[r++];
-        if ((buf & 0x80) == 0)
-        {
-            toinsert[w] = buf & 0x7f;
-            i = 0;
-        }
-        else if ((buf & 0xe0) == 0xc0)
-        {
-            toinsert[w] = buf & 0x1f;
-            i = 1;
-        }
-        else if ((buf & 0xf0) == 0xe0)
-        {
-            toinsert[w] = buf & 0x0f;
-            i = 2;
-        }
-        else break;
-        
-        for (int j = 0; j < i; j++)
-        {
-            buf = v[r++];
-            if (toinsert[w] > 0x04)
-            {
-                toinsert[w + 1] = (toinsert[w + 1] << 6) | (((toinsert[w] & 0xfc) >> 2) & 0x3f);
-                toinsert[w] &= 0x03;
-            }
-            toinsert[w] = (toinsert[w] << 6) | (buf & 0x3f);
-        }
-        w += 2;
-    }
-    memcpy(data + ofs, toinsert, len);
-}
-
-void StringUtils::setStringWithBytes(u8* data, const std::string& v, int ofs, int len, char* padding)
-{
-    setString(data, v + padding, ofs, len);
-}
-
-std::string StringUtils::getString4(const u8* data, int ofs, int len)
-{
-    std::string output;
-    len *= 2;
-    u16 temp;
-    u16 codepoint;
-    for (u8 i = 0; i < len; i += 2)
-    {
-        temp = *(u16*)(data + ofs + i);
-        if (temp == 0xFFFF)
-            break;
-        u16 index = std::distance(G4Values, std::find(G4Values, G4Values + G4TEXT_LENGTH, temp));
-        codepoint = G4Chars[index];
-        if (codepoint == 0xFFFF)
-            break;
-
-        // Stupid stupid stupid
-        switch (codepoint)
-        {
-            case 0x246E:
-                codepoint = 0x2640;
-                break;
-            case 0x246D:
-                codepoint = 0x2642;
-                break;
-        }
-        
-        char* addChar;
-        if (codepoint < 0x0080)
-        {
-            addChar = new char[2];
-            addChar[0] = codepoint;
-            addChar[1] = '\0';
-        }
-        else if (codepoint < 0x0800)
-        {
-            addChar = new char[3];
-            addChar[0] = 0xC0 | ((codepoint >> 6) & 0x1F);
-            addChar[1] = 0x80 | (codepoint & 0x3F);
-            addChar[2] = '\0';
-        }
-        else
-        {
-            addChar = new char[4];
-            addChar[0] = 0xE0 | ((codepoint >> 12) & 0x0F);
-            addChar[1] = 0x80 | ((codepoint >> 6) & 0x3F);
-            addChar[2] = 0x80 | (codepoint & 0x3F);
-            addChar[3] = '\0';
-        }
-        output.append(addChar);
-        delete[] addChar;
-    }
-    return output;
-}
-
-void StringUtils::setString4(u8* data, const std::string& v, int ofs, int len)
-{
-    u16 output[len] = {0};
-    u16 outIndex = 0, charIndex = 0;
-    for (; outIndex < len && charIndex < v.length(); charIndex++, outIndex++)
-    {
-        if (v[charIndex] & 0x80)
-        {
-            u16 codepoint = 0;
-            if (v[charIndex] & 0x80 && v[charIndex] & 0x40 && v[charIndex] & 0x20)
-            {
-                codepoint = v[charIndex] & 0x0F;
-                codepoint = codepoint << 6 | (v[charIndex + 1] & 0x3F);
-                codepoint = codepoint << 6 | (v[charIndex + 2] & 0x3F);
-                charIndex += 2;
-            }
-            else if (v[charIndex] & 0x80 && v[charIndex] & 0x40)
-            {
-                codepoint = v[charIndex] & 0x1F;
-                codepoint = codepoint << 6 | (v[charIndex + 1] & 0x3F);
-                charIndex += 1;
-            }
-            // GAHHHHHH WHY
-            switch (codepoint)
-            {
-                case 0x2640:
-                    codepoint = 0x246E; // Female
-                    break;
-                case 0x2642:
-                    codepoint = 0x246D; // Male
-                    break;
-            }
-            size_t index = std::distance(G4Chars, std::find(G4Chars, G4Chars + G4TEXT_LENGTH, codepoint));
-            output[outIndex] = (index < G4TEXT_LENGTH ? G4Values[index] : 0x0000); 
-        }
-        else
-        {
-            size_t index = std::distance(G4Chars, std::find(G4Chars, G4Chars + G4TEXT_LENGTH, v[charIndex]));
-            output[outIndex] = (index < G4TEXT_LENGTH ? G4Values[index] : 0x0000);
-        }
-    }
-    output[outIndex >= len ? len - 1 : outIndex] = 0xFFFF;
-    memcpy(data + ofs, output, len * 2);
-}
-
-std::string& StringUtils::toUpper(std::string& in)
-{
-    std::transform(in.begin(), in.end(), in.begin(), ::toupper);
-    std::u16string otherIn = StringUtils::UTF8toUTF16(in);
-    for (size_t i = 0; i < otherIn.size(); i++)
-    {
-        switch (otherIn[i])
-        {
-            case u'í':
-                otherIn[i] = u'Í';
-                break;
-            case u'ó':
-                otherIn[i] = u'Ó';
-                break;
-            case u'ú':
-                otherIn[i] = u'Ú';
-                break;
-            case u'é':
-                otherIn[i] = u'É';
-                break;
-            case u'á':
-                otherIn[i] = u'Á';
-                break;
-            case u'ì':
-                otherIn[i] = u'Ì';
-                break;
-            case u'ò':
-                otherIn[i] = u'Ò';
-                break;
-            case u'ù':
-                otherIn[i] = u'Ù';
-                break;
-            case u'è':
-                otherIn[i] = u'È';
-                break;
-            case u'à':
-                otherIn[i] = u'À';
-                break;
-            case u'ñ':
-                otherIn[i] = u'Ñ';
-                break;
-            case u'æ':
-                otherIn[i] = u'Æ';
-                break;
-        }
-    }
-    in = StringUtils::UTF16toUTF8(otherIn);
-    return in;
-}
-
-std::string& StringUtils::toLower(std::string& in)
-{
-    std::transform(in.begin(), in.end(), in.begin(), ::tolower);
-    std::u16string otherIn = StringUtils::UTF8toUTF16(in);
-    for (size_t i = 0; i < otherIn.size(); i++)
-    {
-        switch (otherIn[i])
-        {
-            case u'Í':
-                otherIn[i] = u'í';
-                break;
-            case u'Ó':
-                otherIn[i] = u'ó';
-                break;
-            case u'Ú':
-                otherIn[i] = u'ú';
-                break;
-            case u'É':
-                otherIn[i] = u'é';
-                break;
-            case u'Á':
-                otherIn[i] = u'á';
-                break;
-            case u'Ì':
-                otherIn[i] = u'ì';
-                break;
-            case u'Ò':
-                otherIn[i] = u'ò';
-                break;
-            case u'Ù':
-                otherIn[i] = u'ù';
-                break;
-            case u'È':
-                otherIn[i] = u'è';
-                break;
-            case u'À':
-                otherIn[i] = u'à';
-                break;
-            case u'Ñ':
-                otherIn[i] = u'ñ';
-                break;
-            case u'Æ':
-                otherIn[i] = u'æ';
-                break;
-        }
-    }
-    in = StringUtils::UTF16toUTF8(otherIn);
-    return in;
-}
-
 static std::map<u16, charWidthInfo_s*> widthCache;
 static std::queue<u16> widthCacheOrder;
 
@@ -27,53 +27,82 @@
 #ifndef BANK_HPP
 #define BANK_HPP
 
+#include <string.h>
 #include "Sav.hpp"
-
-extern "C" {
-#include "sha256.h"
-}
+#include "BankBoxStore.hpp"
+#include "BankChangeTracker.hpp"
+#include "BankIndex.hpp"
+#include "BankPager.hpp"
+#include "GlobalBankIndex.hpp"
 
 class Bank
 {
 public:
     Bank(const std::string& name, int maxBoxes);
-    ~Bank()
-    {
-        delete[] data;
-    }
+    ~Bank();
     std::shared_ptr<PKX> pkm(int box, int slot) const;
     void pkm(std::shared_ptr<PKX> pkm, int box, int slot);
+    // Calls func with a PKXView of the slot in place; empty slots call nothing
+    template <typename Func>
+    auto view(int box, int slot, Func&& func) const
+    {
+        const u8* entry = pages.box(box) + slot * sizeof(BankEntry);
+        Generation gen;
+        memcpy(&gen, entry, sizeof(Generation));
+        return visitPKX(gen, entry + sizeof(Generation), func);
+    }
     void resize(int boxes);
     void load(int maxBoxes);
     bool save() const;
     void backup() const;
-    std::string boxName(int box) const;
+    const std::string& boxName(int box) const;
     void boxName(std::string name, int box);
     bool hasChanged() const;
     int boxes() const;
     const std::string& name() const;
     bool setName(const std::string& name);
+    // Built the first time it is asked for, which reads every box
+    const BankIndex& index() const;
+    const BankPager::Stats& pageStats() const;
+    // How many boxes to keep in memory. Edited boxes stay until saved regardless
+    void pageBudget(size_t boxes);
 private:
-    static constexpr int BANK_VERSION = 2;
+    static constexpr int BANK_VERSION = 3;
+    static constexpr size_t PAGE_BUDGET = 16;
     static constexpr std::string_view BANK_MAGIC = "PKSMBANK";
     void createJSON();
+    std::string namesJson() const;
     void createBank(int maxBoxes);
     void convert();
+    void indexGlobal();
+    // Brings the cross-bank index up to date with boxes as just saved, whose contents data gives,
+    // and with the revision of the file they were saved to
+    void indexBoxes(const std::vector<int>& boxes, const BankChangeTracker::Boxes& data, u32 revision) const;
+    bool loadBox(int box, u8* out) const;
     struct BankHeader {
-        const char MAGIC[8];
+        char MAGIC[8];
         int version;
         int boxes;
+        u32 revision; // Version 3 only. Counts saves, so the cross-bank index can tell the file changed
     };
     struct BankEntry {
         Generation gen;
         u8 data[260];
     };
-    u8* data = nullptr;
-    nlohmann::json boxNames;
-    size_t size;
-    mutable std::array<u8, SHA256_BLOCK_SIZE> prevHash;
-    mutable bool needsCheck = false;
+    mutable BankHeader header{};
+    std::unique_ptr<BankFile> file;
+    mutable BankBoxStore store;
+    mutable BankPager pages{sizeof(BankEntry) * 30, PAGE_BUDGET};
+    std::vector<std::string> boxNames;
+    mutable BankChangeTracker changes;
+    // Whether the header and box names differ from what is on disk, or will once queued saves finish
+    mutable bool headerChanged = false;
+    mutable bool namesChanged = false;
+    // Whether the file has a journal that could not be replayed, so it is neither read nor written
+    bool damaged = false;
     std::string bankName;
+    mutable BankIndex slotIndex;
+    mutable bool indexed = false;
 };
 
 #endif
@@ -35,7 +35,7 @@
 class Configuration
 {
 public:
-    static constexpr int CURRENT_VERSION = 6;
+    static constexpr int CURRENT_VERSION = 7;
 
     static Configuration& getInstance(void)
     {
@@ -131,6 +131,12 @@ public:
         return mJson["showBackups"];
     }
 
+    // Snapshots of each file the automatic backups keep in the backup store; 0 keeps all of them
+    size_t keptBackups(void) const
+    {
+        return mJson["keptBackups"];
+    }
+
     void language(Language lang)
     {
         mJson["language"] = lang;
@@ -221,6 +227,11 @@ public:
         mJson["showBackups"] = value;
     }
 
+    void keptBackups(size_t kept)
+    {
+        mJson["keptBackups"] = kept;
+    }
+
     void save(void);
 
 private:
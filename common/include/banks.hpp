@@ -28,6 +28,8 @@
 #define BANKS_HPP
 #include "types.h"
 #include "Bank.hpp"
+#include "DuplicateFinder.hpp"
+#include "GlobalBankIndex.hpp"
 
 #define BANKS_VERSION 1
 #define BANK_DEFAULT_SIZE 50
@@ -42,7 +44,15 @@ namespace Banks
     void removeBank(const std::string& name);
     void renameBank(const std::string& oldName, const std::string& newName);
     void setBankSize(const std::string& name, int size);
+    // Puts back the bank's newest backup, reloading it if it is the one loaded. Unsaved changes are lost
+    bool restoreBank(const std::string& name);
     std::vector<std::pair<std::string, int>> bankNames();
+    // Where Pokémon are across every bank, as of each bank's last save
+    GlobalBankIndex& index();
+    // Queues the index to be written out
+    void saveIndex();
+    // Copies of one Pokémon within and between save (source 0) and the loaded bank (source 1)
+    std::vector<std::vector<DuplicateFinder::Location>> duplicates(const Sav* save, DuplicateFinder::Match match);
 }
 
 #endif
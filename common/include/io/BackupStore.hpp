@@ -0,0 +1,68 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BACKUPSTORE_HPP
+#define BACKUPSTORE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "types.h"
+
+// Deduplicated backups. Files are cut into fixed-size chunks stored under the
+// hash of their contents, and each snapshot is a manifest listing its chunks,
+// so a backup only writes the chunks no earlier backup already has:
+//   <root>/chunks/<first two hex digits>/<hash>
+//   <root>/snapshots/<name>/<snapshot>
+class BackupStore
+{
+public:
+    // Saves change in place rather than shifting, so fixed chunks line up between backups
+    static constexpr u32 CHUNK_SIZE = 0x1000;
+
+    BackupStore(const std::string& root) : root(root) {}
+    bool backup(const std::string& name, const std::string& snapshot, const u8* data, u32 size);
+    // Every snapshot of name, oldest first when snapshots are named by time
+    std::vector<std::string> snapshots(const std::string& name) const;
+    // Fails if the snapshot is missing or any of its chunks is missing or damaged
+    bool restore(const std::string& name, const std::string& snapshot, std::vector<u8>& out) const;
+    bool restore(const std::string& snapshotPath, std::vector<u8>& out) const;
+    bool remove(const std::string& name, const std::string& snapshot);
+    // Removes all but the newest keep snapshots of name, returning how many went
+    size_t prune(const std::string& name, size_t keep);
+    // Deletes chunks no snapshot refers to any more, returning how many
+    size_t collectGarbage();
+    std::string snapshotPath(const std::string& name, const std::string& snapshot) const;
+
+private:
+    static constexpr std::string_view MAGIC = "PKSMSNAP";
+    std::string chunkPath(const std::string& hash) const;
+    bool readManifest(const std::string& path, u32& size, std::vector<std::string>& hashes) const;
+
+    std::string root;
+};
+
+#endif
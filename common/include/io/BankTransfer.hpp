@@ -0,0 +1,67 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKTRANSFER_HPP
+#define BANKTRANSFER_HPP
+
+#include <functional>
+#include <memory>
+#include "BankFile.hpp"
+#include "PKX.hpp"
+
+// Moves Pokémon between a version 3 bank file and a folder holding one .pk4,
+// .pk5, .pk6, .pk7 or .pb7 file per Pokémon. Both directions work a box at a
+// time and save in batches, so memory stays the same however large either is.
+namespace BankTransfer
+{
+    static constexpr u32 HEADER_SIZE = 20;
+    static constexpr int BATCH_BOXES = 8;
+
+    struct Report
+    {
+        u32 moved = 0;    // Pokémon written out or taken in
+        u32 rejected = 0; // files that are not a Pokémon, or fail validation
+        u32 unplaced = 0; // valid files left over once the bank was full
+        bool good = true; // false if the bank or a file could not be read or written
+    };
+
+    // Whether a Pokémon may go into the bank; the console checks it against the loaded save
+    using Validator = std::function<bool(PKX& pkm)>;
+
+    // Writes an empty bank of boxes boxes, replacing whatever was at path
+    bool create(BankFile& file, const std::string& bankPath, int boxes);
+    // Writes every occupied slot to its own file in dir, which is created if needed
+    Report exportBank(BankFile& file, const std::string& bankPath, const std::string& dir);
+    // Puts each Pokémon file in dir, in name order, into the next empty slot
+    Report importFolder(BankFile& file, const std::string& bankPath, const std::string& dir, const Validator& valid = nullptr);
+
+    // The Pokémon in a file's contents, or nullptr. The format comes from the length and
+    // PKX::genFromBytes; only the .pb7 extension is needed, to tell LGPE from a Gen 6/7 party file
+    std::shared_ptr<PKX> parse(const std::string& name, u8* data, size_t length);
+    std::string fileName(int box, int slot, PKX& pkm);
+}
+
+#endif
@@ -30,3 +30,21 @@
 #ifdef __SWITCH__
  #include <switch/types.h>
 #endif
+#if !defined(_3DS) && !defined(__SWITCH__)
+ #include <stdint.h>
+ #include <stddef.h>
+
+ typedef uint8_t u8;
+ typedef uint16_t u16;
+ typedef uint32_t u32;
+ typedef uint64_t u64;
+ typedef int8_t s8;
+ typedef int16_t s16;
+ typedef int32_t s32;
+ typedef int64_t s64;
+ typedef s32 Result;
+
+ #define BIT(n) (1U<<(n))
+ #define R_SUCCEEDED(res) ((res)>=0)
+ #define R_FAILED(res) ((res)<0)
+#endif
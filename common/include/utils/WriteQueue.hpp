@@ -0,0 +1,99 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef WRITEQUEUE_HPP
+#define WRITEQUEUE_HPP
+
+#include <functional>
+#include <list>
+#include <utility>
+#include "platform.h"
+#ifndef _3DS
+ #include <condition_variable>
+ #include <mutex>
+ #include <thread>
+#endif
+
+// Runs file writes on a thread of their own so the interface keeps drawing while
+// they happen. Jobs run one at a time in the order they were pushed and must own
+// whatever they write, so copy a buffer into the job rather than pointing at one
+// that may still be edited. Completions come back on the thread that calls poll
+// or flush, which makes them the place to show errors.
+class WriteQueue
+{
+public:
+    using Job = std::function<bool(void)>;
+    using Done = std::function<void(bool)>;
+
+    static WriteQueue& getInstance(void)
+    {
+        static WriteQueue queue;
+        return queue;
+    }
+
+    WriteQueue();
+    ~WriteQueue() { stop(); }
+    // Until started, and once stopped, jobs run as they are pushed
+    void start(void);
+    void stop(void);
+    void push(Job job, Done done = nullptr);
+    // Runs the completions of the jobs that have finished
+    void poll(void);
+    // Waits for every job pushed so far to finish, without running completions
+    void wait(void);
+    // Waits for every job pushed so far and runs their completions
+    void flush(void);
+    bool busy(void);
+
+private:
+    static void entry(void* queue) { ((WriteQueue*)queue)->run(); }
+    void run(void);
+    void lock(void);
+    void unlock(void);
+    // Called and returns with the lock held
+    void waitForWork(void);
+    void waitForIdle(void);
+    void signalWork(void);
+    void signalIdle(void);
+
+    std::list<std::pair<Job, Done>> jobs;
+    std::list<std::pair<Done, bool>> finished;
+    bool running = false;
+    bool stopping = false;
+    bool working = false;
+#ifdef _3DS
+    LightLock mutex;
+    LightEvent work;
+    LightEvent idle;
+#else
+    std::mutex mutex;
+    std::condition_variable work;
+    std::condition_variable idle;
+    std::thread thread;
+#endif
+};
+
+#endif
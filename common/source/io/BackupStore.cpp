@@ -0,0 +1,259 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <set>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "BackupStore.hpp"
+#include "STDirectory.hpp"
+#include "io.hpp"
+
+extern "C" {
+#include "sha256.h"
+}
+
+namespace
+{
+    std::string hashChunk(const u8* data, u32 size)
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+        u8 hash[SHA256_BLOCK_SIZE];
+        sha256(hash, (u8*)data, size);
+        std::string ret;
+        for (u8 byte : hash)
+        {
+            ret += digits[byte >> 4];
+            ret += digits[byte & 15];
+        }
+        return ret;
+    }
+
+    bool readFile(const std::string& path, std::vector<u8>& out)
+    {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in)
+        {
+            return false;
+        }
+        fseek(in, 0, SEEK_END);
+        out.resize(ftell(in));
+        fseek(in, 0, SEEK_SET);
+        bool good = fread(out.data(), 1, out.size(), in) == out.size();
+        fclose(in);
+        return good;
+    }
+
+    // Written under a temporary name first, so an interrupted write never leaves a
+    // damaged file under the real one
+    bool writeFile(const std::string& path, const u8* data, u32 size)
+    {
+        std::string tmpPath = path + ".tmp";
+        FILE* out = fopen(tmpPath.c_str(), "wb");
+        if (!out)
+        {
+            return false;
+        }
+        bool good = fwrite(data, 1, size, out) == size;
+        good = fclose(out) == 0 && good;
+        if (good)
+        {
+            ::remove(path.c_str());
+            good = rename(tmpPath.c_str(), path.c_str()) == 0;
+        }
+        if (!good)
+        {
+            ::remove(tmpPath.c_str());
+        }
+        return good;
+    }
+
+    std::vector<std::string> listDirectory(const std::string& path, bool folders)
+    {
+        std::vector<std::string> ret;
+        STDirectory dir(path);
+        for (size_t i = 0; i < dir.count(); i++)
+        {
+            std::string item = dir.item(i);
+            if (dir.folder(i) == folders && item != "." && item != "..")
+            {
+                ret.push_back(item);
+            }
+        }
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+}
+
+std::string BackupStore::chunkPath(const std::string& hash) const
+{
+    return root + "/chunks/" + hash.substr(0, 2) + "/" + hash;
+}
+
+std::string BackupStore::snapshotPath(const std::string& name, const std::string& snapshot) const
+{
+    return root + "/snapshots/" + name + "/" + snapshot;
+}
+
+bool BackupStore::backup(const std::string& name, const std::string& snapshot, const u8* data, u32 size)
+{
+    mkdir(root.c_str(), 0777);
+    mkdir((root + "/chunks").c_str(), 0777);
+    mkdir((root + "/snapshots").c_str(), 0777);
+    mkdir((root + "/snapshots/" + name).c_str(), 0777);
+
+    std::vector<u8> manifest(MAGIC.begin(), MAGIC.end());
+    manifest.insert(manifest.end(), (u8*)&size, (u8*)&size + 4);
+    for (u32 offset = 0; offset < size; offset += CHUNK_SIZE)
+    {
+        u32 length = std::min(CHUNK_SIZE, size - offset);
+        std::string hash = hashChunk(data + offset, length);
+        std::string path = chunkPath(hash);
+        if (!io::exists(path))
+        {
+            mkdir((root + "/chunks/" + hash.substr(0, 2)).c_str(), 0777);
+            if (!writeFile(path, data + offset, length))
+            {
+                return false;
+            }
+        }
+        manifest.insert(manifest.end(), hash.begin(), hash.end());
+    }
+    // The manifest goes last, so a snapshot only exists once all of its chunks do
+    return writeFile(snapshotPath(name, snapshot), manifest.data(), manifest.size());
+}
+
+bool BackupStore::readManifest(const std::string& path, u32& size, std::vector<std::string>& hashes) const
+{
+    std::vector<u8> manifest;
+    if (!readFile(path, manifest) || manifest.size() < MAGIC.size() + 4 || memcmp(manifest.data(), MAGIC.data(), MAGIC.size()))
+    {
+        return false;
+    }
+    memcpy(&size, manifest.data() + MAGIC.size(), 4);
+    size_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    size_t hashLength = SHA256_BLOCK_SIZE * 2;
+    if (manifest.size() != MAGIC.size() + 4 + chunks * hashLength)
+    {
+        return false;
+    }
+    hashes.clear();
+    for (size_t i = 0; i < chunks; i++)
+    {
+        const char* hash = (const char*)manifest.data() + MAGIC.size() + 4 + i * hashLength;
+        hashes.emplace_back(hash, hashLength);
+    }
+    return true;
+}
+
+std::vector<std::string> BackupStore::snapshots(const std::string& name) const
+{
+    std::vector<std::string> ret = listDirectory(root + "/snapshots/" + name, false);
+    ret.erase(std::remove_if(ret.begin(), ret.end(), [](const std::string& item) {
+        return item.size() > 4 && item.compare(item.size() - 4, 4, ".tmp") == 0;
+    }), ret.end());
+    return ret;
+}
+
+bool BackupStore::restore(const std::string& name, const std::string& snapshot, std::vector<u8>& out) const
+{
+    return restore(snapshotPath(name, snapshot), out);
+}
+
+bool BackupStore::restore(const std::string& snapshotPath, std::vector<u8>& out) const
+{
+    u32 size;
+    std::vector<std::string> hashes;
+    if (!readManifest(snapshotPath, size, hashes))
+    {
+        return false;
+    }
+    out.resize(size);
+    std::vector<u8> chunk;
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        u32 length = std::min(CHUNK_SIZE, size - (u32)i * CHUNK_SIZE);
+        if (!readFile(chunkPath(hashes[i]), chunk) || chunk.size() != length || hashChunk(chunk.data(), length) != hashes[i])
+        {
+            return false;
+        }
+        std::copy(chunk.begin(), chunk.end(), out.begin() + i * CHUNK_SIZE);
+    }
+    return true;
+}
+
+bool BackupStore::remove(const std::string& name, const std::string& snapshot)
+{
+    return ::remove(snapshotPath(name, snapshot).c_str()) == 0;
+}
+
+size_t BackupStore::prune(const std::string& name, size_t keep)
+{
+    std::vector<std::string> all = snapshots(name);
+    size_t removed = 0;
+    for (size_t i = 0; i + keep < all.size(); i++)
+    {
+        if (remove(name, all[i]))
+        {
+            removed++;
+        }
+    }
+    return removed;
+}
+
+size_t BackupStore::collectGarbage()
+{
+    std::set<std::string> live;
+    for (auto& name : listDirectory(root + "/snapshots", true))
+    {
+        for (auto& snapshot : snapshots(name))
+        {
+            u32 size;
+            std::vector<std::string> hashes;
+            // Without knowing what a snapshot uses, nothing is safe to delete
+            if (!readManifest(snapshotPath(name, snapshot), size, hashes))
+            {
+                return 0;
+            }
+            live.insert(hashes.begin(), hashes.end());
+        }
+    }
+
+    // Leftover temporary files are from interrupted writes, and go too
+    size_t removed = 0;
+    for (auto& shard : listDirectory(root + "/chunks", true))
+    {
+        for (auto& chunk : listDirectory(root + "/chunks/" + shard, false))
+        {
+            if (!live.count(chunk) && ::remove((root + "/chunks/" + shard + "/" + chunk).c_str()) == 0)
+            {
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
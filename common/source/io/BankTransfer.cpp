@@ -0,0 +1,346 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "BankTransfer.hpp"
+#include "BankBoxStore.hpp"
+#include "PB7.hpp"
+#include "PK4.hpp"
+#include "PK5.hpp"
+#include "PK6.hpp"
+#include "PK7.hpp"
+#include "STDirectory.hpp"
+
+namespace
+{
+    constexpr char MAGIC[] = "PKSMBANK";
+    constexpr int VERSION = 3;
+    // Nothing larger than a party PB7 or a Gen 6/7 party file is a Pokémon
+    constexpr long MAX_FILE = 260;
+
+    std::vector<u8> makeHeader(int boxes)
+    {
+        std::vector<u8> header(BankTransfer::HEADER_SIZE);
+        memcpy(header.data(), MAGIC, 8);
+        memcpy(header.data() + 8, &VERSION, sizeof(int));
+        memcpy(header.data() + 12, &boxes, sizeof(int));
+        return header;
+    }
+
+    // Moves the header's revision on, which is how the cross-bank index learns the bank changed
+    void countSave(std::vector<u8>& header)
+    {
+        u32 revision;
+        memcpy(&revision, header.data() + 16, sizeof(u32));
+        revision++;
+        memcpy(header.data() + 16, &revision, sizeof(u32));
+    }
+
+    // Recovers any interrupted save and opens the box directory; returns the box count, or 0
+    int openBank(BankFile& file, const std::string& bankPath, BankBoxStore& store, std::vector<u8>& header)
+    {
+        // A bank its journal could not bring up to date is only half written
+        if (!BankJournal(file, bankPath).recover())
+        {
+            return 0;
+        }
+        header.resize(BankTransfer::HEADER_SIZE);
+        int version, boxes;
+        if (!file.read(bankPath, 0, header.data(), header.size()))
+        {
+            return 0;
+        }
+        memcpy(&version, header.data() + 8, sizeof(int));
+        memcpy(&boxes, header.data() + 12, sizeof(int));
+        if (memcmp(header.data(), MAGIC, 8) || version != VERSION || boxes <= 0 || !store.open(file, bankPath, header.size(), boxes))
+        {
+            return 0;
+        }
+        return boxes;
+    }
+
+    bool readFile(const std::string& path, u8* data, size_t& length)
+    {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in)
+        {
+            return false;
+        }
+        fseek(in, 0, SEEK_END);
+        long size = ftell(in);
+        fseek(in, 0, SEEK_SET);
+        bool good = size > 0 && size <= MAX_FILE && fread(data, 1, size, in) == (size_t)size;
+        fclose(in);
+        length = size;
+        return good;
+    }
+
+    bool writeFile(const std::string& path, const u8* data, u32 size)
+    {
+        FILE* out = fopen(path.c_str(), "wb");
+        if (!out)
+        {
+            return false;
+        }
+        bool good = fwrite(data, 1, size, out) == size;
+        return fclose(out) == 0 && good;
+    }
+}
+
+std::shared_ptr<PKX> BankTransfer::parse(const std::string& name, u8* data, size_t length)
+{
+    std::shared_ptr<PKX> pkm;
+    size_t dot = name.rfind('.');
+    std::string extension = dot == std::string::npos ? "" : name.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (length == 260 && extension == "pb7")
+    {
+        pkm = PKXPool::make<PB7>(data);
+    }
+    else
+    {
+        size_t boxLength;
+        switch (length)
+        {
+            case 136:
+            case 220:
+            case 236:
+                boxLength = 136;
+                break;
+            case 232:
+            case 260:
+                boxLength = 232;
+                break;
+            default:
+                return nullptr;
+        }
+        switch (PKX::genFromBytes(data, boxLength))
+        {
+            case 4:
+                pkm = PKXPool::make<PK4>(data, false, length == 236);
+                break;
+            case 5:
+                pkm = PKXPool::make<PK5>(data, false, length == 220);
+                break;
+            case 6:
+                pkm = PKXPool::make<PK6>(data, false, length == 260);
+                break;
+            case 7:
+                pkm = PKXPool::make<PK7>(data, false, length == 260);
+                break;
+            default:
+                return nullptr;
+        }
+    }
+    return pkm->species() == 0 ? nullptr : pkm;
+}
+
+std::string BankTransfer::fileName(int box, int slot, PKX& pkm)
+{
+    std::string extension = pkm.generation() == Generation::LGPE ? "pb7" : "pk" + genToString(pkm.generation());
+    return StringUtils::format("%03d-%02d - %d - %08X.", box + 1, slot + 1, pkm.species(), pkm.PID()) + extension;
+}
+
+bool BankTransfer::create(BankFile& file, const std::string& bankPath, int boxes)
+{
+    if (boxes <= 0)
+    {
+        return false;
+    }
+    std::vector<u8> empty(BankBoxStore::BOX_SIZE, 0xFF);
+    BankBoxStore store;
+    store.attach(file, bankPath, HEADER_SIZE);
+    return store.save(makeHeader(boxes), boxes, [&empty](int) { return empty.data(); }, {}, true, true);
+}
+
+BankTransfer::Report BankTransfer::exportBank(BankFile& file, const std::string& bankPath, const std::string& dir)
+{
+    Report report;
+    BankBoxStore store;
+    std::vector<u8> header;
+    int boxes = openBank(file, bankPath, store, header);
+    if (boxes == 0)
+    {
+        report.good = false;
+        return report;
+    }
+    mkdir(dir.c_str(), 0777);
+
+    std::vector<u8> box(BankBoxStore::BOX_SIZE);
+    for (int i = 0; i < boxes; i++)
+    {
+        if (!store.readBox(i, box.data()))
+        {
+            report.good = false;
+            continue;
+        }
+        for (int slot = 0; slot < 30; slot++)
+        {
+            const u8* entry = box.data() + slot * BankBoxStore::ENTRY_SIZE;
+            if (BankBoxStore::emptyEntry(entry))
+            {
+                continue;
+            }
+            auto pkm = BankBoxStore::readEntry(entry);
+            if (writeFile(dir + "/" + fileName(i, slot, *pkm), pkm->rawData(), pkm->getLength()))
+            {
+                report.moved++;
+            }
+            else
+            {
+                report.good = false;
+            }
+        }
+    }
+    return report;
+}
+
+BankTransfer::Report BankTransfer::importFolder(BankFile& file, const std::string& bankPath, const std::string& dir, const Validator& valid)
+{
+    Report report;
+    BankBoxStore store;
+    std::vector<u8> header;
+    int boxes = openBank(file, bankPath, store, header);
+    STDirectory directory(dir);
+    if (boxes == 0 || !directory.good())
+    {
+        report.good = false;
+        return report;
+    }
+    std::vector<std::string> names;
+    for (size_t i = 0; i < directory.count(); i++)
+    {
+        if (!directory.folder(i))
+        {
+            names.emplace_back(directory.item(i));
+        }
+    }
+    std::sort(names.begin(), names.end());
+
+    // Only the boxes written since the last save are held, so memory stays bounded
+    std::map<int, std::vector<u8>> batch;
+    std::vector<u8> scratch(BankBoxStore::BOX_SIZE);
+    auto flush = [&]() {
+        if (batch.empty())
+        {
+            return;
+        }
+        std::vector<int> changed;
+        for (auto& i : batch)
+        {
+            changed.emplace_back(i.first);
+        }
+        auto data = [&](int box) -> const u8* {
+            auto i = batch.find(box);
+            if (i != batch.end())
+            {
+                return i->second.data();
+            }
+            // Only asked for when the store rewrites the whole file. A box that cannot be read is
+            // copied across as stored rather than replaced with whatever scratch holds
+            return store.readBox(box, scratch.data()) ? scratch.data() : nullptr;
+        };
+        countSave(header);
+        if (!store.save(header, boxes, data, changed, false, true))
+        {
+            report.good = false;
+        }
+        batch.clear();
+    };
+
+    int box = 0, slot = 0, lastWritten = -1;
+    // Moves to the next empty slot, loading boxes as they are reached; false once the bank is full
+    auto nextSlot = [&]() -> u8* {
+        while (box < boxes)
+        {
+            auto i = batch.find(box);
+            if (i == batch.end())
+            {
+                if ((int)batch.size() >= BATCH_BOXES)
+                {
+                    flush();
+                }
+                i = batch.emplace(box, std::vector<u8>(BankBoxStore::BOX_SIZE)).first;
+                if (!store.readBox(box, i->second.data()))
+                {
+                    // An unreadable box is left alone rather than overwritten
+                    report.good = false;
+                    batch.erase(i);
+                    box++;
+                    slot = 0;
+                    continue;
+                }
+            }
+            for (; slot < 30; slot++)
+            {
+                u8* entry = i->second.data() + slot * BankBoxStore::ENTRY_SIZE;
+                if (BankBoxStore::emptyEntry(entry))
+                {
+                    return entry;
+                }
+            }
+            // A box that was already full goes back unchanged
+            if (box != lastWritten)
+            {
+                batch.erase(i);
+            }
+            box++;
+            slot = 0;
+        }
+        return nullptr;
+    };
+
+    u8 data[MAX_FILE];
+    size_t length;
+    for (auto& name : names)
+    {
+        std::shared_ptr<PKX> pkm;
+        if (readFile(dir + "/" + name, data, length))
+        {
+            pkm = parse(name, data, length);
+        }
+        if (!pkm || (valid && !valid(*pkm)))
+        {
+            report.rejected++;
+            continue;
+        }
+        u8* entry = nextSlot();
+        if (!entry)
+        {
+            report.unplaced++;
+            continue;
+        }
+        BankBoxStore::writeEntry(*pkm, entry);
+        lastWritten = box;
+        report.moved++;
+    }
+    flush();
+    return report;
+}
@@ -0,0 +1,237 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "WriteQueue.hpp"
+#ifdef _3DS
+ #include "thread.hpp"
+#endif
+
+WriteQueue::WriteQueue()
+{
+#ifdef _3DS
+    LightLock_Init(&mutex);
+    LightEvent_Init(&work, RESET_ONESHOT);
+    LightEvent_Init(&idle, RESET_STICKY);
+    LightEvent_Signal(&idle);
+#endif
+}
+
+void WriteQueue::start()
+{
+    if (running)
+    {
+        return;
+    }
+    running = true;
+    stopping = false;
+#ifdef _3DS
+    // Below the interface's priority, so drawing comes first and writes fill the gaps
+    Threads::create(&WriteQueue::entry, this, 32 * 1024, 1);
+#else
+    thread = std::thread(&WriteQueue::run, this);
+#endif
+}
+
+void WriteQueue::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+    lock();
+    stopping = true;
+    signalWork();
+    waitForIdle();
+    running = false;
+    unlock();
+#ifndef _3DS
+    thread.join();
+#endif
+    poll();
+}
+
+void WriteQueue::push(Job job, Done done)
+{
+    lock();
+    if (!running)
+    {
+        unlock();
+        bool good = job();
+        if (done)
+        {
+            done(good);
+        }
+        return;
+    }
+    jobs.emplace_back(std::move(job), std::move(done));
+#ifdef _3DS
+    LightEvent_Clear(&idle);
+#endif
+    signalWork();
+    unlock();
+}
+
+void WriteQueue::poll()
+{
+    lock();
+    std::list<std::pair<Done, bool>> done;
+    done.swap(finished);
+    unlock();
+    for (auto& result : done)
+    {
+        if (result.first)
+        {
+            result.first(result.second);
+        }
+    }
+}
+
+void WriteQueue::wait()
+{
+    lock();
+    waitForIdle();
+    unlock();
+}
+
+void WriteQueue::flush()
+{
+    wait();
+    poll();
+}
+
+bool WriteQueue::busy()
+{
+    lock();
+    bool ret = working || !jobs.empty();
+    unlock();
+    return ret;
+}
+
+void WriteQueue::run()
+{
+    lock();
+    while (true)
+    {
+        if (jobs.empty())
+        {
+            if (stopping)
+            {
+                break;
+            }
+            waitForWork();
+            continue;
+        }
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+        working = true;
+        unlock();
+
+        bool good = job.first();
+
+        lock();
+        working = false;
+        finished.emplace_back(std::move(job.second), good);
+        if (jobs.empty())
+        {
+            signalIdle();
+        }
+    }
+    unlock();
+}
+
+#ifdef _3DS
+void WriteQueue::lock()
+{
+    LightLock_Lock(&mutex);
+}
+
+void WriteQueue::unlock()
+{
+    LightLock_Unlock(&mutex);
+}
+
+void WriteQueue::waitForWork()
+{
+    // The event stays signalled until it is waited on, so a push between these can't be missed
+    unlock();
+    LightEvent_Wait(&work);
+    lock();
+}
+
+void WriteQueue::waitForIdle()
+{
+    while (working || !jobs.empty())
+    {
+        unlock();
+        LightEvent_Wait(&idle);
+        lock();
+    }
+}
+
+void WriteQueue::signalWork()
+{
+    LightEvent_Signal(&work);
+}
+
+void WriteQueue::signalIdle()
+{
+    LightEvent_Signal(&idle);
+}
+#else
+void WriteQueue::lock()
+{
+    mutex.lock();
+}
+
+void WriteQueue::unlock()
+{
+    mutex.unlock();
+}
+
+void WriteQueue::waitForWork()
+{
+    std::unique_lock<std::mutex> guard(mutex, std::adopt_lock);
+    work.wait(guard);
+    guard.release();
+}
+
+void WriteQueue::waitForIdle()
+{
+    std::unique_lock<std::mutex> guard(mutex, std::adopt_lock);
+    idle.wait(guard, [this] { return !working && jobs.empty(); });
+    guard.release();
+}
+
+void WriteQueue::signalWork()
+{
+    work.notify_one();
+}
+
+void WriteQueue::signalIdle()
+{
+    idle.notify_all();
+}
+#endif
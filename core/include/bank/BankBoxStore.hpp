@@ -0,0 +1,96 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKBOXSTORE_HPP
+#define BANKBOXSTORE_HPP
+
+#include <memory>
+#include "BankChangeTracker.hpp"
+#include "BankJournal.hpp"
+#include "PKX.hpp"
+
+// The box area of a version 3 bank: a directory giving each box's place in the
+// file, then the boxes. A box is stored as its occupied slots only, each trimmed
+// of trailing padding, and compressed when that makes it smaller. In memory a box
+// is always 30 fixed-size entries, so only loading and saving see the difference.
+class BankBoxStore
+{
+public:
+    static constexpr u32 ENTRY_SIZE = 264; // Generation, then 260 bytes of data
+    static constexpr u32 BOX_SIZE = ENTRY_SIZE * 30;
+
+    // An entry's Pokémon, with party data if it was stored with any. Empty entries give an empty PK7
+    static std::shared_ptr<PKX> readEntry(const u8* entry);
+    // Stores pkm in entry, or empties it if pkm has no species
+    static void writeEntry(PKX& pkm, u8* entry);
+    static bool emptyEntry(const u8* entry);
+    // Converts every entry of box to target, one after another in target's stored format.
+    // Empty entries and Pokémon that cannot reach target come out zeroed. Returns how many were converted
+    static int convertBox(const u8* box, Generation target, u8* out);
+
+    static std::vector<u8> encodeBox(const u8* box, bool compress, bool& compressed);
+    static bool decodeBox(const u8* blob, u32 length, bool compressed, u8* box);
+
+    ~BankBoxStore() { unmap(); }
+    // Forgets any previous file; the next save writes path whole
+    void attach(BankFile& file, const std::string& path, u32 headerSize);
+    // Reads the directory of a bank whose header takes headerSize bytes
+    bool open(BankFile& file, const std::string& path, u32 headerSize, int boxes);
+    void moved(const std::string& path) { this->path = path; }
+    bool readBox(int box, u8* out) const;
+    // Writes header and the changed boxes, or everything if rewrite is set, the box count
+    // changed or the file has become mostly dead space. Boxes that outgrow their place move
+    // to the end of the file; without resizable the file is rewritten whole instead.
+    // data gives nullptr for a box it could not read, which keeps that box as stored: a
+    // rewrite copies it across as it is, and fails if it was never stored or cannot be read
+    bool save(const std::vector<u8>& header, int boxes, const BankChangeTracker::Boxes& data, const std::vector<int>& changed, bool rewrite, bool resizable);
+    u32 fileSize() const { return end; }
+    void compression(bool v) { compress = v; }
+
+private:
+    static constexpr u32 COMPRESSED = 1;
+    struct Location
+    {
+        u32 offset;
+        u32 capacity;
+        u32 length;
+        u32 flags;
+    };
+    bool readStored(int box, std::vector<u8>& blob) const;
+    void map();
+    void unmap();
+
+    BankFile* file = nullptr;
+    std::string path;
+    u32 headerSize = 0;
+    u32 end = 0;
+    std::vector<Location> directory;
+    const u8* mapping = nullptr;
+    u32 mappedSize = 0;
+    bool compress = true;
+};
+
+#endif
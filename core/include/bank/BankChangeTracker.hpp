@@ -0,0 +1,91 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKCHANGETRACKER_HPP
+#define BANKCHANGETRACKER_HPP
+
+#include <array>
+#include <functional>
+#include <vector>
+#include "types.h"
+
+extern "C" {
+#include "sha256.h"
+}
+
+// Remembers a hash of every box as last saved, and which boxes have been written
+// since, so checking for changes only rehashes the boxes that were touched.
+// A box written back to its saved contents counts as unchanged.
+class BankChangeTracker
+{
+public:
+    // Gives the contents of a box, for banks that are not one contiguous block
+    using Boxes = std::function<const u8*(int box)>;
+
+    // Records data, laid out as boxes of boxSize bytes each, as the saved state
+    void reset(const Boxes& data, size_t boxSize, int boxes);
+    void reset(const u8* data, size_t boxSize, int boxes) { reset(contiguous(data, boxSize), boxSize, boxes); }
+    // Starts over without hashing anything: each box's saved state is taken from loaded,
+    // which must see a box before it is first written
+    void reset(size_t boxSize, int boxes);
+    // Records a box as read from the file, unless its saved state is already known
+    void loaded(const u8* boxData, int box)
+    {
+        if (!known[box])
+        {
+            saved(boxData, box);
+        }
+    }
+    // Boxes added by growing have never been saved, so they start out changed
+    void resize(int boxes);
+    void markDirty(int box) { dirty[box] = true; }
+    // Rehashes the written boxes, forgetting those that match their saved hash
+    bool changed(const Boxes& data);
+    bool changed(const u8* data) { return changed(contiguous(data, boxSize)); }
+    // Like changed, but lists every box that differs from its saved state
+    std::vector<int> changedBoxes(const Boxes& data);
+    std::vector<int> changedBoxes(const u8* data) { return changedBoxes(contiguous(data, boxSize)); }
+    // Records a box's current contents as saved
+    void saved(const u8* boxData, int box);
+    // Forgets every saved hash, for when the file is about to be rewritten from scratch
+    void invalidate();
+
+private:
+    using Hash = std::array<u8, SHA256_BLOCK_SIZE>;
+    static Boxes contiguous(const u8* data, size_t boxSize)
+    {
+        return [data, boxSize](int box) { return data + box * boxSize; };
+    }
+    Hash hashBox(const u8* boxData) const;
+
+    std::vector<Hash> hashes;
+    std::vector<bool> dirty;
+    // Whether hashes holds a box's saved state; one never loaded cannot have been written
+    std::vector<bool> known;
+    size_t boxSize = 0;
+};
+
+#endif
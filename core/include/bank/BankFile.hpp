@@ -0,0 +1,55 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKFILE_HPP
+#define BANKFILE_HPP
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+// The file operations bank persistence needs, so saving can be written once
+// and run against the console's archives or a plain directory.
+class BankFile
+{
+public:
+    virtual ~BankFile() {}
+    // Replaces out with the whole file; false if it cannot be opened
+    virtual bool read(const std::string& path, std::vector<u8>& out) = 0;
+    // Reads size bytes at offset
+    virtual bool read(const std::string& path, u32 offset, u8* data, u32 size) = 0;
+    // Writes size bytes at offset, leaving the rest of the file alone. Creates the file if needed
+    virtual bool write(const std::string& path, u32 offset, const u8* data, u32 size) = 0;
+    // Truncates or extends the file to size bytes
+    virtual bool resize(const std::string& path, u32 size) = 0;
+    virtual bool remove(const std::string& path) = 0;
+    // Maps the first size bytes of the file read-only where the platform can, or returns nullptr.
+    // The mapping follows later writes, but not a shrink past it
+    virtual const u8* map(const std::string& path, u32 size) { return nullptr; }
+    virtual void unmap(const u8* data, u32 size) {}
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKINDEX_HPP
+#define BANKINDEX_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "PKX.hpp"
+
+// Column-per-field summary of a bank's slots, so searches and filters
+// never have to construct PKX objects
+class BankIndex
+{
+public:
+    enum class Column : u8
+    {
+        SPECIES,
+        FORM,
+        LEVEL,
+        NATURE,
+        SHINY,
+        BALL,
+        TID,
+        SID,
+        IV_TOTAL,
+        HELD_ITEM,
+        GENERATION,
+        // Interned: values are ids from otNameId, numbered in the order names were first seen
+        OT_NAME
+    };
+
+    // Inclusive range of accepted values for one column
+    struct Filter
+    {
+        Column column;
+        u32 min;
+        u32 max;
+    };
+
+    void resize(size_t slots);
+    size_t size() const { return species.size(); }
+    // pkm is a PKX or a PKXView; either way an empty one clears the slot
+    template <typename Pkm>
+    void set(size_t slot, const Pkm& pkm)
+    {
+        if (pkm.species() == 0)
+        {
+            clear(slot);
+            return;
+        }
+        species[slot] = pkm.species();
+        forms[slot] = pkm.alternativeForm();
+        levels[slot] = pkm.level();
+        natures[slot] = pkm.nature();
+        shinies[slot] = pkm.shiny() ? 1 : 0;
+        balls[slot] = pkm.ball();
+        tids[slot] = pkm.TID();
+        sids[slot] = pkm.SID();
+        u8 ivTotal = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            ivTotal += pkm.iv(i);
+        }
+        ivTotals[slot] = ivTotal;
+        heldItems[slot] = pkm.heldItem();
+        generations[slot] = (u8)pkm.generation();
+        otNames[slot] = intern(pkm.otName());
+    }
+    void clear(size_t slot);
+    bool occupied(size_t slot) const { return species[slot] != 0; }
+    u32 value(Column column, size_t slot) const;
+    // Id to filter OT_NAME on. A name no slot has had gives an id no slot matches
+    u32 otNameId(const std::string& name) const;
+    const std::string& otName(u32 id) const { return otNameTable[id]; }
+
+    // Occupied slots passing every filter, in slot order or stably ordered on a column
+    std::vector<u32> query(const std::vector<Filter>& filters) const;
+    std::vector<u32> query(const std::vector<Filter>& filters, Column orderBy, bool descending = false) const;
+
+private:
+    template <typename T>
+    static void filterColumn(const std::vector<T>& column, u32 min, u32 max, std::vector<u8>& keep);
+    u32 intern(const std::string& name);
+
+    std::vector<u16> species;
+    std::vector<u8> forms;
+    std::vector<u8> levels;
+    std::vector<u8> natures;
+    std::vector<u8> shinies;
+    std::vector<u8> balls;
+    std::vector<u16> tids;
+    std::vector<u16> sids;
+    std::vector<u8> ivTotals;
+    std::vector<u16> heldItems;
+    std::vector<u8> generations;
+    std::vector<u32> otNames;
+    // Names are never forgotten, so ids stay valid for as long as the index lives
+    std::vector<std::string> otNameTable;
+    std::unordered_map<std::string, u32> otNameIds;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKJOURNAL_HPP
+#define BANKJOURNAL_HPP
+
+#include <functional>
+#include <string_view>
+#include <utility>
+#include "BankFile.hpp"
+
+// Writes ranges of a bank image into its file in place. The ranges are first
+// recorded, with a checksum, in a journal next to the bank; only once that
+// record is complete is the bank itself touched. A save interrupted before then
+// leaves the old bank, and one interrupted after is finished by recover().
+// Ranges are recorded a batch at a time: full batches go to part files beside
+// the journal, which holds their checksums, so a large write is never held whole.
+class BankJournal
+{
+public:
+    using Range = std::pair<u32, u32>; // offset, length
+    // Copies the new contents of a range to out, for banks that are not one contiguous block
+    using Source = std::function<void(const Range& range, u8* out)>;
+    // An offset and the bytes to put there
+    using Write = std::pair<u32, std::vector<u8>>;
+    // Most bytes of ranges held in memory, and written to each part file
+    static constexpr u32 BATCH = 0x10000;
+
+    BankJournal(BankFile& file, const std::string& bankPath);
+    // Brings the bank file to size bytes with the given ranges of image written
+    bool commit(const Source& image, u32 size, const std::vector<Range>& ranges);
+    bool commit(const u8* image, u32 size, const std::vector<Range>& ranges);
+    bool commit(const std::vector<Write>& writes, u32 size);
+    // First half of commit: records the write without touching the bank
+    bool prepare(const u8* image, u32 size, const std::vector<Range>& ranges);
+    // Records a write a range at a time, for callers that produce it piece by piece.
+    // begin() discards any earlier record; prepare() or commit() then finish this one
+    void begin();
+    bool add(u32 offset, const u8* data, u32 length);
+    bool prepare(u32 size);
+    bool commit(u32 size);
+    // Replays a complete record and removes it, discarding an incomplete one.
+    // Must run before the bank is read; false if the bank could not be brought up to date
+    bool recover();
+
+private:
+    static constexpr std::string_view MAGIC = "PKSMJRN2";
+    std::string partPath(u32 part) const { return journalPath + "." + std::to_string(part); }
+    void flush();
+    bool finish(u32 size, std::vector<u8>& record);
+    static bool valid(const std::vector<u8>& record);
+    bool apply(const std::vector<u8>& record);
+    bool applyRanges(const u8* ranges, u32 length);
+    void removeParts();
+
+    BankFile& file;
+    std::string bankPath;
+    std::string journalPath;
+    std::vector<u8> pending;
+    std::vector<u8> parts;
+    u32 partCount = 0;
+    bool good = true;
+};
+
+#endif
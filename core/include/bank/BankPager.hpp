@@ -0,0 +1,111 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef BANKPAGER_HPP
+#define BANKPAGER_HPP
+
+#include <functional>
+#include <list>
+#include <memory>
+#include "BankFile.hpp"
+
+// Keeps a bounded set of a bank's boxes in memory, reading the rest from its
+// file as they are asked for. Boxes that have been edited stay resident until
+// they are saved, so the file itself only ever changes through a save.
+// Where the file can be mapped, unedited boxes are read through the mapping.
+class BankPager
+{
+public:
+    struct Stats
+    {
+        u32 hits = 0;      // box was resident
+        u32 misses = 0;    // box was read from the file
+        u32 mapped = 0;    // box was served from the file mapping
+        u32 evictions = 0; // resident box dropped to stay within budget
+        u32 failures = 0;  // box could not be read and was filled in empty
+    };
+
+    // Fills out with a box's contents, for files that do not store boxes as they are in memory
+    using Loader = std::function<bool(int box, u8* out)>;
+    // Sees a box's contents as they were read from the file, whether paged in or mapped
+    using Observer = std::function<void(int box, const u8* data)>;
+
+    BankPager(size_t boxSize, size_t budget) : boxSize(boxSize), pageBudget(budget) {}
+    ~BankPager() { close(); }
+    // Drops every page and serves boxes boxes stored from offset on in path.
+    // Only call once edits have been saved, or to discard them
+    void open(BankFile& file, const std::string& path, u32 offset, int boxes);
+    void open(const Loader& loader, int boxes);
+    void close();
+    // Kept across opens
+    void observe(const Observer& observer) { this->observer = observer; }
+    // Follows the file to a new name without dropping anything
+    void moved(const std::string& path) { this->path = path; }
+    // Valid until the next call that pages a box in
+    const u8* box(int box);
+    // Valid until the next open
+    u8* edit(int box);
+    // An edited box now matches the file, so it may be dropped like any other
+    void saved(int box);
+    // False once a box failed to load since the last open. Its page is then empty filler,
+    // which must never be saved in place of what the file holds
+    bool readable(int box) const { return !unreadable[box]; }
+    // Boxes added by growing start out empty and edited
+    void resize(int boxes);
+    int boxes() const { return where.size(); }
+
+    size_t budget() const { return pageBudget; }
+    void budget(size_t boxes);
+    size_t resident() const { return pages.size(); }
+    const Stats& stats() const { return counters; }
+
+private:
+    struct Page
+    {
+        int box;
+        bool pinned;
+        std::unique_ptr<u8[]> data;
+    };
+    std::list<Page>::iterator load(int box);
+    void evict();
+
+    Loader loader;
+    Observer observer;
+    BankFile* file = nullptr;
+    std::string path;
+    u32 offset = 0;
+    const u8* mapping = nullptr;
+    u32 mappedSize = 0;
+    size_t boxSize;
+    size_t pageBudget;
+    // Most recently used first
+    std::list<Page> pages;
+    std::vector<std::list<Page>::iterator> where;
+    std::vector<bool> unreadable;
+    Stats counters;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef GLOBALBANKINDEX_HPP
+#define GLOBALBANKINDEX_HPP
+
+#include <map>
+#include <optional>
+#include <string_view>
+#include "BankFile.hpp"
+#include "PKX.hpp"
+
+// What every bank holds and where, kept in a file of its own so a Pokémon can be
+// found without loading the banks. Each bank's record is brought up to date from
+// the boxes it saves, so it only ever describes what is on disk. The revision the
+// bank's header had then goes with it, to catch a file changed behind the index's back.
+class GlobalBankIndex
+{
+public:
+    struct Location
+    {
+        std::string bank;
+        int box;
+        int slot;
+    };
+
+    // Fields left empty match anything
+    struct Query
+    {
+        std::optional<u16> species;
+        std::optional<u8> form;
+        std::optional<bool> shiny;
+        std::optional<std::string> otName;
+        std::optional<u32> PID;
+        std::optional<u32> encryptionConstant;
+    };
+
+    // False, leaving the index empty, if the file is missing or damaged
+    bool load(BankFile& file, const std::string& path);
+    bool save(BankFile& file, const std::string& path) const { return save(file, path, serialize()); }
+    // The file's contents, to be written later by save
+    std::vector<u8> serialize() const;
+    static bool save(BankFile& file, const std::string& path, const std::vector<u8>& contents);
+
+    bool contains(const std::string& bank) const { return banks.count(bank) > 0; }
+    int boxes(const std::string& bank) const;
+    // Whether the bank's record was made from the file at this revision
+    bool current(const std::string& bank, u32 revision) const;
+    void revision(const std::string& bank, u32 revision) { revisions[bank] = revision; }
+    // Adds a bank with boxes empty boxes, or grows or shrinks one already there
+    void resize(const std::string& bank, int boxes);
+    void set(const std::string& bank, int box, int slot, const PKX& pkm);
+    void clear(const std::string& bank, int box, int slot);
+    void remove(const std::string& bank);
+    void rename(const std::string& oldName, const std::string& newName);
+
+    // Matches ordered by bank name, then box and slot
+    std::vector<Location> find(const Query& query) const;
+    size_t size() const;
+
+private:
+    static constexpr std::string_view MAGIC = "PKSMBIDX";
+    static constexpr u32 VERSION = 3;
+    struct Entry
+    {
+        u8 slot;
+        u8 form;
+        bool shiny;
+        u16 species;
+        u32 PID;
+        u32 encryptionConstant;
+        std::string otName;
+    };
+    // Occupied slots of each box, in slot order
+    using Boxes = std::vector<std::vector<Entry>>;
+
+    std::map<std::string, Boxes> banks;
+    // Banks without one are never current
+    std::map<std::string, u32> revisions;
+};
+
+#endif
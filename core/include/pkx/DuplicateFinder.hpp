@@ -0,0 +1,122 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef DUPLICATEFINDER_HPP
+#define DUPLICATEFINDER_HPP
+
+#include <unordered_map>
+#include <vector>
+#include "PKX.hpp"
+
+// Groups Pokémon that are copies of each other. Each one added is reduced to a
+// 64-bit fingerprint and filed in a hash map, so a whole save and bank take one
+// pass. EXACT matches the stored bytes apart from the checksum and party stats;
+// IDENTITY matches encryption constant, PID, trainer IDs and IVs, which survive
+// trading, evolving and moving between games.
+class DuplicateFinder
+{
+public:
+    enum class Match : u8
+    {
+        EXACT,
+        IDENTITY
+    };
+
+    struct Location
+    {
+        int source; // which save or bank, as numbered by the caller
+        int box;
+        int slot;
+    };
+
+    DuplicateFinder(Match match = Match::IDENTITY) : match(match) {}
+    // Sizes the map for this many slots up front
+    void reserve(size_t slots);
+    // Empty slots are skipped. pkm is a PKX or a PKXView
+    template <typename Pkm>
+    void add(int source, int box, int slot, const Pkm& pkm)
+    {
+        if (pkm.species() != 0)
+        {
+            file(fingerprint(pkm, match), {source, box, slot});
+        }
+    }
+    // Every fingerprint seen more than once, in the order first seen
+    std::vector<std::vector<Location>> groups() const;
+    size_t size() const { return count; }
+    void clear();
+
+    template <typename Pkm>
+    static u64 fingerprint(const Pkm& pkm, Match match)
+    {
+        if (match == Match::IDENTITY)
+        {
+            u64 h = hash(pkm.encryptionConstant(), FNV_OFFSET);
+            h = hash(pkm.PID(), h);
+            h = hash(pkm.TID(), h);
+            h = hash(pkm.SID(), h);
+            for (int i = 0; i < 6; i++)
+            {
+                h = hash(pkm.iv(i), h);
+            }
+            return h;
+        }
+
+        // Box data only: party stats follow it, and the checksum at 6 changes with them in some games
+        u32 boxLength = pkm.generation() == Generation::FOUR || pkm.generation() == Generation::FIVE ? 136 : 232;
+        const u8* data = pkm.rawData();
+        u64 h = hash(pkm.generation(), FNV_OFFSET);
+        h = hash(data, 6, h);
+        return hash(data + 8, std::min(pkm.getLength(), boxLength) - 8, h);
+    }
+
+private:
+    static constexpr u64 FNV_OFFSET = 0xCBF29CE484222325;
+    static constexpr u64 FNV_PRIME = 0x100000001B3;
+
+    static u64 hash(const u8* data, size_t length, u64 h = FNV_OFFSET)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            h = (h ^ data[i]) * FNV_PRIME;
+        }
+        return h;
+    }
+    template <typename T>
+    static u64 hash(T value, u64 h)
+    {
+        return hash((const u8*)&value, sizeof(T), h);
+    }
+    void file(u64 key, const Location& location);
+
+    Match match;
+    size_t count = 0;
+    std::unordered_map<u64, std::vector<Location>> seen;
+    // Fingerprints in the order they were first seen, so results do not depend on hashing
+    std::vector<u64> order;
+};
+
+#endif
@@ -40,9 +40,9 @@ protected:
     void reorderMoves(void) override;
 
 public:
-    PB7() { length = 260; data = new u8[length]; std::fill_n(data, length, 0); }
+    PB7() { length = 260; data = (u8*)PKXPool::allocate(length); std::fill_n(data, length, 0); }
     PB7(u8* dt, bool ekx = false);
-    virtual ~PB7() { delete[] data; }
+    virtual ~PB7() { PKXPool::release(data, length); }
 
     std::shared_ptr<PKX> clone(void) override;
 
@@ -31,6 +31,8 @@
 #include "PK5.hpp"
 #include "time.h"
 
+class PK5;
+
 class PK4 : public PKX
 {
 protected:
@@ -41,9 +43,9 @@ protected:
     void crypt(void) override;
 
 public:
-    PK4() { length = 136; data = new u8[length]; std::fill_n(data, length, 0); }
+    PK4() { length = 136; data = (u8*)PKXPool::allocate(length); std::fill_n(data, length, 0); }
     PK4(u8* dt, bool ekx = false, bool party = false);
-    virtual ~PK4() { delete[] data; };
+    virtual ~PK4() { PKXPool::release(data, length); };
 
     std::shared_ptr<PKX> clone(void) override;
 
@@ -176,6 +178,8 @@ public:
     void partyLevel(u8 v) override;
     
     std::shared_ptr<PKX> next(void) const override;
+    // Writes this Pokémon's gen 5 counterpart over out, leaving its checksum stale
+    void convertTo(PK5& out) const;
 
     inline u8 baseHP(void) const override { return PersonalDPPtHGSS::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalDPPtHGSS::baseAtk(formSpecies()); }
@@ -32,6 +32,9 @@
 #include "PK4.hpp"
 #include "i18n.hpp"
 
+class PK4;
+class PK6;
+
 class PK5 : public PKX
 {
 protected:
@@ -39,9 +42,9 @@ protected:
     void crypt(void) override;
 
 public:
-    PK5() { length = 136; data = new u8[length]; std::fill_n(data, length, 0); }
+    PK5() { length = 136; data = (u8*)PKXPool::allocate(length); std::fill_n(data, length, 0); }
     PK5(u8* dt, bool ekx = false, bool party = false);
-    virtual ~PK5() { delete[] data; };
+    virtual ~PK5() { PKXPool::release(data, length); };
 
     std::shared_ptr<PKX> clone(void) override;
 
@@ -172,6 +175,9 @@ public:
     
     std::shared_ptr<PKX> next(void) const override;
     std::shared_ptr<PKX> previous(void) const override;
+    // Write this Pokémon's counterpart over out, leaving its checksum stale
+    void convertTo(PK4& out) const;
+    void convertTo(PK6& out) const;
 
     inline u8 baseHP(void) const override { return PersonalBWB2W2::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalBWB2W2::baseAtk(formSpecies()); }
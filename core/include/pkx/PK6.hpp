@@ -31,6 +31,9 @@
 #include "PK7.hpp"
 #include "PK5.hpp"
 
+class PK5;
+class PK7;
+
 class PK6 : public PKX
 {
 protected:
@@ -39,9 +42,9 @@ protected:
     void reorderMoves(void) override;
 
 public:
-    PK6() { length = 232; data = new u8[length]; std::fill_n(data, length, 0); }
+    PK6() { length = 232; data = (u8*)PKXPool::allocate(length); std::fill_n(data, length, 0); }
     PK6(u8* dt, bool ekx = false, bool party = false);
-    virtual ~PK6() { delete[] data; };
+    virtual ~PK6() { PKXPool::release(data, length); };
 
     std::shared_ptr<PKX> clone(void) override;
 
@@ -229,6 +232,9 @@ public:
     
     std::shared_ptr<PKX> next(void) const override;
     std::shared_ptr<PKX> previous(void) const override;
+    // Write this Pokémon's counterpart over out, leaving its checksum stale
+    void convertTo(PK5& out) const;
+    void convertTo(PK7& out) const;
 
     inline u8 baseHP(void) const override { return PersonalXYORAS::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalXYORAS::baseAtk(formSpecies()); }
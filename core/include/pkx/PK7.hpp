@@ -30,6 +30,8 @@
 #include "PKX.hpp"
 #include "PK6.hpp"
 
+class PK6;
+
 class PK7 : public PKX
 {
 protected:
@@ -40,9 +42,9 @@ protected:
     void reorderMoves(void) override;
 
 public:
-    PK7() { length = 232; data = new u8[length]; std::fill_n(data, length, 0); }
+    PK7() { length = 232; data = (u8*)PKXPool::allocate(length); std::fill_n(data, length, 0); }
     PK7(u8* dt, bool ekx = false, bool party = false);
-    virtual ~PK7() { delete[] data; };
+    virtual ~PK7() { PKXPool::release(data, length); };
 
     std::shared_ptr<PKX> clone(void) override;
 
@@ -218,6 +220,8 @@ public:
     void partyLevel(u8 v) override;
     
     std::shared_ptr<PKX> previous(void) const override;
+    // Writes this Pokémon's gen 6 counterpart over out, leaving its checksum stale
+    void convertTo(PK6& out) const;
 
     inline u8 baseHP(void) const override { return PersonalSMUSUM::baseHP(formSpecies()); }
     inline u8 baseAtk(void) const override { return PersonalSMUSUM::baseAtk(formSpecies()); }
@@ -38,14 +38,14 @@
 #include "generation.hpp"
 #include "Item.hpp"
 #include "random.hpp"
+#include "PKXPool.hpp"
 
 class PKX
 {
 protected:
-    u32 expTable(u8 row, u8 col) const;
-    u8 blockPosition(u8 index) const;
-    u8 blockPositionInvert(u8 index) const;
-    u32 seedStep(u32 seed);
+    static u8 blockPosition(u8 index);
+    static u8 blockPositionInvert(u8 index);
+    static u32 seedStep(u32 seed);
     virtual void reorderMoves(void);
 
     virtual void crypt(void) = 0;
@@ -57,8 +57,17 @@ protected:
 
 public:
     virtual u8* rawData(void) { return data; }
+    const u8* rawData(void) const { return data; }
     void decrypt(void);
     void encrypt(void);
+    // Crypt raw stored data of the given generation in place, without building a PKX
+    static void decrypt(u8* dt, u32 length, Generation gen);
+    static void encrypt(u8* dt, u32 length, Generation gen);
+    // XOR the crypt keystream over [8, length), restarting from the first word at partyStart
+    static void cryptData(u8* dt, u32 length, u32 seed, u32 partyStart);
+    // Reorder the four data blocks in place for shuffle value sv, and undo that order
+    static void shuffleData(u8* dt, u32 blockLength, u8 sv);
+    static void unshuffleData(u8* dt, u32 blockLength, u8 sv);
     virtual std::shared_ptr<PKX> clone(void) = 0;
     virtual ~PKX() { };
 
@@ -71,7 +80,13 @@ public:
     int genNumber(void) const;
     void fixMoves(void);
 
+    // Experience needed to reach level row + 1, and the level a given amount reaches
+    static u32 expTable(u8 row, u8 expType);
+    static u8 levelFromExp(u32 exp, u8 expType);
     static u32 getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u32 oldPid, Generation gen);
+    // The same, but shiny or not as asked for the trainer tid/sid. Shiny PIDs are built from their low half
+    // rather than drawn until one fits
+    static u32 getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u16 tid, u16 sid, bool shiny, Generation gen);
 
     // BLOCK A
     virtual u32 encryptionConstant(void) const = 0;
@@ -212,8 +227,9 @@ public:
     virtual int partyLevel(void) const = 0;
     virtual void partyLevel(u8 v) = 0;
 
-    virtual std::shared_ptr<PKX> previous(void) const { return std::shared_ptr<PKX>(const_cast<PKX*>(this)); }
-    virtual std::shared_ptr<PKX> next(void) const { return std::shared_ptr<PKX>(const_cast<PKX*>(this)); }
+    // A new Pokémon one generation back or on; formats with nothing there give a copy of themselves
+    virtual std::shared_ptr<PKX> previous(void) const { return const_cast<PKX*>(this)->clone(); }
+    virtual std::shared_ptr<PKX> next(void) const { return const_cast<PKX*>(this)->clone(); }
 
     u32 getLength(void) const { return length; }
     static u8 genFromBytes(u8* data, size_t length, bool ekx = false);
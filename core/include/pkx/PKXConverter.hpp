@@ -0,0 +1,60 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+#ifndef PKXCONVERTER_HPP
+#define PKXCONVERTER_HPP
+
+#include "PKX.hpp"
+
+// Moves Pokémon between generations in one call. Each pair of neighbouring formats
+// has its own field map (the PKX convertTo overloads); a conversion runs those maps
+// back to back, through a Pokémon per generation crossed that the converter keeps
+// for the next call, and works out the checksum of the result only. Keep one
+// converter around to convert many Pokémon in a row.
+class PKXConverter
+{
+public:
+    // Let's Go Pokémon have no way to or from the other generations
+    static bool supported(Generation from, Generation to);
+    // Length of the stored, party-less data of gen
+    static u32 boxLength(Generation gen);
+
+    // Converts the decrypted data src of generation from into out, in target's stored format
+    bool convert(Generation from, const u8* src, Generation target, u8* out);
+    bool convert(const PKX& pk, Generation target, u8* out);
+    // A new Pokémon of generation target, or nullptr when pk cannot get there
+    static std::shared_ptr<PKX> convert(const PKX& pk, Generation target);
+
+private:
+    static std::shared_ptr<PKX> make(Generation gen);
+    // The converter's own Pokémon of gen, made the first time it is needed
+    PKX& stage(Generation gen);
+    // Runs the field maps from pk's generation to target, the last of them writing over out
+    void run(const PKX& pk, Generation target, PKX& out);
+
+    std::shared_ptr<PKX> stages[4];
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef PKXPOOL_HPP
+#define PKXPOOL_HPP
+
+#include <memory>
+#include <new>
+#include <vector>
+#include "types.h"
+
+// Fixed-size pools for the memory a PKX takes: its payload, and the object together
+// with its shared_ptr control block. Each block size has a pool of its own, carved from
+// slabs and recycled through a free list, so making and dropping Pokémon in bulk neither
+// goes to the heap nor fragments it. Slabs are kept once taken, ready for the next batch.
+namespace PKXPool
+{
+    // Blocks larger than this go straight to the heap
+    static constexpr size_t MAX_BLOCK = 512;
+
+    struct Stats
+    {
+        u32 size;        // bytes per block
+        u32 live;        // blocks in use
+        u32 peak;        // most blocks in use at once
+        u32 allocations; // blocks handed out so far
+        u32 slabs;       // slabs taken from the heap
+    };
+
+    void* allocate(size_t size);
+    void release(void* block, size_t size);
+    // One entry per block size used so far
+    std::vector<Stats> stats(void);
+
+    template <typename T>
+    struct Allocator
+    {
+        using value_type = T;
+
+        Allocator() = default;
+        template <typename U>
+        Allocator(const Allocator<U>&) {}
+
+        T* allocate(size_t n) { return (T*)(n == 1 ? PKXPool::allocate(sizeof(T)) : ::operator new(n * sizeof(T))); }
+        void deallocate(T* p, size_t n)
+        {
+            if (n == 1)
+            {
+                PKXPool::release(p, sizeof(T));
+            }
+            else
+            {
+                ::operator delete(p);
+            }
+        }
+
+        template <typename U>
+        bool operator==(const Allocator<U>&) const { return true; }
+        template <typename U>
+        bool operator!=(const Allocator<U>&) const { return false; }
+    };
+
+    // std::make_shared, with the object and control block in one pooled block
+    template <typename T, typename... Args>
+    std::shared_ptr<T> make(Args&&... args)
+    {
+        return std::allocate_shared<T>(Allocator<T>(), std::forward<Args>(args)...);
+    }
+}
+
+#endif
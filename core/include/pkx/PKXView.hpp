@@ -0,0 +1,203 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef PKXVIEW_HPP
+#define PKXVIEW_HPP
+
+#include "PKX.hpp"
+
+// The personal table each generation's Pokémon are read against
+template <Generation G>
+struct PKXPersonal;
+template <>
+struct PKXPersonal<Generation::FOUR>
+{
+    static constexpr auto formCount = &PersonalDPPtHGSS::formCount;
+    static constexpr auto formStatIndex = &PersonalDPPtHGSS::formStatIndex;
+    static constexpr auto expType = &PersonalDPPtHGSS::expType;
+    static constexpr auto type1 = &PersonalDPPtHGSS::type1;
+    static constexpr auto type2 = &PersonalDPPtHGSS::type2;
+};
+template <>
+struct PKXPersonal<Generation::FIVE>
+{
+    static constexpr auto formCount = &PersonalBWB2W2::formCount;
+    static constexpr auto formStatIndex = &PersonalBWB2W2::formStatIndex;
+    static constexpr auto expType = &PersonalBWB2W2::expType;
+    static constexpr auto type1 = &PersonalBWB2W2::type1;
+    static constexpr auto type2 = &PersonalBWB2W2::type2;
+};
+template <>
+struct PKXPersonal<Generation::SIX>
+{
+    static constexpr auto formCount = &PersonalXYORAS::formCount;
+    static constexpr auto formStatIndex = &PersonalXYORAS::formStatIndex;
+    static constexpr auto expType = &PersonalXYORAS::expType;
+    static constexpr auto type1 = &PersonalXYORAS::type1;
+    static constexpr auto type2 = &PersonalXYORAS::type2;
+};
+template <>
+struct PKXPersonal<Generation::SEVEN>
+{
+    static constexpr auto formCount = &PersonalSMUSUM::formCount;
+    static constexpr auto formStatIndex = &PersonalSMUSUM::formStatIndex;
+    static constexpr auto expType = &PersonalSMUSUM::expType;
+    static constexpr auto type1 = &PersonalSMUSUM::type1;
+    static constexpr auto type2 = &PersonalSMUSUM::type2;
+};
+template <>
+struct PKXPersonal<Generation::LGPE>
+{
+    static constexpr auto formCount = &PersonalLGPE::formCount;
+    static constexpr auto formStatIndex = &PersonalLGPE::formStatIndex;
+    static constexpr auto expType = &PersonalLGPE::expType;
+    static constexpr auto type1 = &PersonalLGPE::type1;
+    static constexpr auto type2 = &PersonalLGPE::type2;
+};
+
+// Read-only access to a decrypted Pokémon where it already lies, such as a save's box
+// storage after cryptBoxData(true) or a bank entry. Nothing is copied or allocated, and
+// every field is a load at an offset known at compile time. The accessors are named as
+// in PKX, so algorithms written as templates over the Pokémon type run on either: the
+// virtual PKX interface where one already exists, and an inlined copy per generation
+// over stored data. Stat formulas are left to PKX, and otName, the one string read, is
+// decoded on every call.
+template <Generation G>
+class PKXView
+{
+private:
+    static constexpr bool ds = G == Generation::FOUR || G == Generation::FIVE;
+    const u8* data;
+
+public:
+    explicit PKXView(const u8* dt) : data(dt) {}
+
+    static constexpr Generation generation(void) { return G; }
+    const u8* rawData(void) const { return data; }
+    // Box data only; party data, where present, is not part of the view
+    static constexpr u32 getLength(void) { return ds ? 136 : G == Generation::LGPE ? 260 : 232; }
+
+    u32 encryptionConstant(void) const { return ds ? PID() : *(u32*)data; }
+    u16 checksum(void) const { return *(u16*)(data + 0x06); }
+    u16 species(void) const { return *(u16*)(data + 0x08); }
+    u16 heldItem(void) const { return *(u16*)(data + 0x0A); }
+    u16 TID(void) const { return *(u16*)(data + 0x0C); }
+    u16 SID(void) const { return *(u16*)(data + 0x0E); }
+    u32 experience(void) const { return *(u32*)(data + 0x10); }
+    u8 ability(void) const { return data[ds ? 0x15 : 0x14]; }
+    u32 PID(void) const { return *(u32*)(data + (ds ? 0x00 : 0x18)); }
+    u8 nature(void) const
+    {
+        if (G == Generation::FOUR)
+        {
+            return PID() % 25;
+        }
+        return data[G == Generation::FIVE ? 0x41 : 0x1C];
+    }
+    bool fatefulEncounter(void) const { return (data[ds ? 0x40 : 0x1D] & 1) == 1; }
+    u8 gender(void) const { return (data[ds ? 0x40 : 0x1D] >> 1) & 0x3; }
+    u8 alternativeForm(void) const { return data[ds ? 0x40 : 0x1D] >> 3; }
+    u8 ev(u8 ev) const { return data[(ds ? 0x18 : 0x1E) + ev]; }
+    u16 move(u8 move) const { return *(u16*)(data + (ds ? 0x28 : 0x5A) + move * 2); }
+    u8 PP(u8 move) const { return data[(ds ? 0x30 : 0x62) + move]; }
+    u8 iv(u8 iv) const { return (u8)((ivWord() >> 5 * iv) & 0x1F); }
+    bool egg(void) const { return ((ivWord() >> 30) & 0x1) == 1; }
+    bool nicknamed(void) const { return ((ivWord() >> 31) & 0x1) == 1; }
+    u8 ball(void) const
+    {
+        if (G == Generation::FOUR)
+        {
+            return data[0x83] > data[0x86] ? data[0x83] : data[0x86];
+        }
+        return data[ds ? 0x83 : 0xDC];
+    }
+    u8 metLevel(void) const { return data[ds ? 0x84 : 0xDD] & ~0x80; }
+    u8 otGender(void) const { return data[ds ? 0x84 : 0xDD] >> 7; }
+    u8 version(void) const { return data[ds ? 0x5F : 0xDF]; }
+    u8 language(void) const { return data[ds ? 0x17 : 0xE3]; }
+    std::string otName(void) const
+    {
+        if (G == Generation::FOUR)
+        {
+            return StringUtils::getString4(data, 0x68, 8);
+        }
+        else if (G == Generation::FIVE)
+        {
+            return StringUtils::getTrimmedString(data, 0x68, 8, (char*)"\uFFFF");
+        }
+        return StringUtils::getString(data, 0xB0, G == Generation::LGPE ? 12 : 13);
+    }
+    u16 TSV(void) const { return (TID() ^ SID()) >> (ds ? 3 : 4); }
+    u16 PSV(void) const { return ((PID() >> 16) ^ (PID() & 0xFFFF)) >> (ds ? 3 : 4); }
+    bool shiny(void) const { return TSV() == PSV(); }
+
+    u16 formSpecies(void) const
+    {
+        u16 tmpSpecies = species();
+        u8 form = alternativeForm();
+        if (form && form < PKXPersonal<G>::formCount(tmpSpecies))
+        {
+            u16 statIndex = PKXPersonal<G>::formStatIndex(tmpSpecies);
+            if (statIndex)
+            {
+                tmpSpecies = statIndex + form - 1;
+            }
+        }
+        return tmpSpecies;
+    }
+    u8 expType(void) const { return PKXPersonal<G>::expType(formSpecies()); }
+    u8 level(void) const { return PKX::levelFromExp(experience(), expType()); }
+    u8 type1(void) const { return PKXPersonal<G>::type1(formSpecies()); }
+    u8 type2(void) const { return PKXPersonal<G>::type2(formSpecies()); }
+
+private:
+    u32 ivWord(void) const { return *(u32*)(data + (ds ? 0x38 : 0x74)); }
+};
+
+// Calls func with a view of data as the given generation's format, and returns what it does.
+// Nothing is called for Generation::UNUSED, and a default result is returned instead
+template <typename Func>
+auto visitPKX(Generation gen, const u8* data, Func&& func) -> decltype(func(PKXView<Generation::SEVEN>(data)))
+{
+    switch (gen)
+    {
+        case Generation::FOUR:
+            return func(PKXView<Generation::FOUR>(data));
+        case Generation::FIVE:
+            return func(PKXView<Generation::FIVE>(data));
+        case Generation::SIX:
+            return func(PKXView<Generation::SIX>(data));
+        case Generation::SEVEN:
+            return func(PKXView<Generation::SEVEN>(data));
+        case Generation::LGPE:
+            return func(PKXView<Generation::LGPE>(data));
+        case Generation::UNUSED:
+        default:
+            return decltype(func(PKXView<Generation::SEVEN>(data)))();
+    }
+}
+
+#endif
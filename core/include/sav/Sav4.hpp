@@ -41,9 +41,12 @@ protected:
 
     int gbo = -1;
     int sbo = -1;
+    // General and storage block bounds of the active partitions
+    u32 chkofs[2], chklen[2];
 
     void GBO(void);
     void SBO(void);
+    void initBlocks(void);
 
     bool checkInsertForm(std::vector<u8> &forms, u8 formNum);
     std::vector<u8> getForms(u16 species);
@@ -108,7 +111,6 @@ public:
     std::vector<MysteryGift::giftData> currentGifts(void) const override;
     void mysteryGift(WCX& wc, int& pos) override;
     std::unique_ptr<WCX> mysteryGift(int pos) const override;
-    void cryptBoxData(bool crypted) override;
     std::string boxName(u8 box) const override;
     void boxName(u8 box, const std::string& name) override;
     u8 partyCount(void) const override;
@@ -97,7 +97,6 @@ public:
     std::vector<MysteryGift::giftData> currentGifts(void) const override;
     void mysteryGift(WCX& wc, int& pos) override;
     std::unique_ptr<WCX> mysteryGift(int pos) const override;
-    void cryptBoxData(bool crypted) override;
     void cryptMysteryGiftData(void);
     std::string boxName(u8 box) const override;
     void boxName(u8 box, const std::string& name) override;
@@ -52,7 +52,7 @@ private:
     bool sanitizeFormsToIterate(int species, int& fs, int& fe, int formIn) const;
 
 public:
-    u16 check16(u8* buf, u32 blockID, u32 len) const;
+    u16 check16(const u8* buf, u32 blockID, u32 len) const;
     virtual void resign(void) = 0;
 
     u16 TID(void) const override;
@@ -110,7 +110,6 @@ public:
     std::vector<MysteryGift::giftData> currentGifts(void) const override;
     void mysteryGift(WCX& wc, int& pos) override;
     std::unique_ptr<WCX> mysteryGift(int pos) const override;
-    void cryptBoxData(bool crypted) override;
     std::string boxName(u8 box) const override;
     void boxName(u8 box, const std::string& name) override;
     u8 partyCount(void) const override;
@@ -32,7 +32,7 @@
 class SavB2W2 : public Sav5
 {
 private:
-    static constexpr u16 lengths[74] = {
+    static constexpr u32 lengths[74] = {
         0x03e0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0,
         0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0,
         0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0, 0x0ff0,
@@ -32,7 +32,7 @@
 class SavBW : public Sav5
 {
 private:
-    static constexpr u16 lengths[70] = {
+    static constexpr u32 lengths[70] = {
         0x03E0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0,
         0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0,
         0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0, 0x0FF0,
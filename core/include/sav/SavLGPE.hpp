@@ -62,7 +62,7 @@ public:
     SavLGPE(u8* dt);
     ~SavLGPE();
 
-    u16 check16(u8* buf, u32 blockID, u32 len) const;
+    u16 check16(const u8* buf, u32 blockID, u32 len) const;
     void resign(void) override;
 
     u16 boxedPkm(void) const;
@@ -129,7 +129,6 @@ public:
     std::vector<MysteryGift::giftData> currentGifts(void) const override { return {}; } // Data not stored
     void mysteryGift(WCX& wc, int& pos) override;
     std::unique_ptr<WCX> mysteryGift(int pos) const override;
-    void cryptBoxData(bool crypted) override;
     std::string boxName(u8 box) const override;
     void boxName(u8 box, const std::string& name) override;
     u8 partyCount(void) const override;
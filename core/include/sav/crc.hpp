@@ -0,0 +1,54 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+
+#ifndef CRC_HPP
+#define CRC_HPP
+
+#include <array>
+#include <stddef.h>
+#include "types.h"
+
+// Number of bytes consumed per table-driven step. 8 (slice-by-8) is fastest on
+// the 3DS and desktops alike; 4 halves the table footprint and 1 is the classic
+// byte-at-a-time algorithm.
+#ifndef CRC_SLICES
+#define CRC_SLICES 8
+#endif
+
+static_assert(CRC_SLICES == 1 || CRC_SLICES == 4 || CRC_SLICES == 8, "CRC_SLICES must be 1, 4 or 8");
+
+namespace CRC
+{
+    // CRC-16/CCITT: polynomial 0x1021, not reflected. Gen 4-6 block checksums.
+    u16 ccitt16(const u8* buf, size_t len, u16 crc = 0xFFFF);
+    // CRC-16/ARC: polynomial 0x8005, reflected (0xA001). Gen 7 and LGPE block checksums.
+    u16 crc16(const u8* buf, size_t len, u16 crc = 0);
+    // As crc16, but the maskLen bytes at maskOfs are read as zero
+    u16 crc16(const u8* buf, size_t len, u16 crc, size_t maskOfs, size_t maskLen);
+}
+
+#endif
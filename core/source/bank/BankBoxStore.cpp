@@ -0,0 +1,385 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <string.h>
+#include "BankBoxStore.hpp"
+#include "BlockCompression.hpp"
+#include "PB7.hpp"
+#include "PK4.hpp"
+#include "PK5.hpp"
+#include "PK6.hpp"
+#include "PK7.hpp"
+#include "PKXConverter.hpp"
+
+namespace
+{
+    // Slot markers; anything below them is the generation of a trimmed entry
+    constexpr u8 RAW_ENTRY = 0xFE;
+    constexpr u8 EMPTY_ENTRY = 0xFF;
+}
+
+std::shared_ptr<PKX> BankBoxStore::readEntry(const u8* entry)
+{
+    Generation gen;
+    memcpy(&gen, entry, sizeof(Generation));
+    u8* data = (u8*)entry + sizeof(Generation);
+    // Party data is kept whenever anything past the box data is set
+    auto party = [data](int boxLength) { return std::any_of(data + boxLength, data + 260, [](u8 v) { return v != 0xFF; }); };
+    switch (gen)
+    {
+        case Generation::FOUR:
+            return PKXPool::make<PK4>(data, false, party(136));
+        case Generation::FIVE:
+            return PKXPool::make<PK5>(data, false, party(136));
+        case Generation::SIX:
+            return PKXPool::make<PK6>(data, false, party(232));
+        case Generation::SEVEN:
+            return PKXPool::make<PK7>(data, false, party(232));
+        case Generation::LGPE:
+            return PKXPool::make<PB7>(data, false);
+        case Generation::UNUSED:
+        default:
+            return PKXPool::make<PK7>();
+    }
+}
+
+void BankBoxStore::writeEntry(PKX& pkm, u8* entry)
+{
+    std::fill_n(entry, ENTRY_SIZE, 0xFF);
+    if (pkm.species() == 0)
+    {
+        return;
+    }
+    Generation gen = pkm.generation();
+    memcpy(entry, &gen, sizeof(Generation));
+    std::copy(pkm.rawData(), pkm.rawData() + std::min(pkm.getLength(), ENTRY_SIZE - (u32)sizeof(Generation)), entry + sizeof(Generation));
+}
+
+bool BankBoxStore::emptyEntry(const u8* entry)
+{
+    Generation gen;
+    memcpy(&gen, entry, sizeof(Generation));
+    return (u32)gen > (u32)Generation::LGPE;
+}
+
+int BankBoxStore::convertBox(const u8* box, Generation target, u8* out)
+{
+    const u32 length = PKXConverter::boxLength(target);
+    PKXConverter converter;
+    int converted = 0;
+    for (int slot = 0; slot < 30; slot++)
+    {
+        const u8* entry = box + slot * ENTRY_SIZE;
+        u8* dest = out + slot * length;
+        Generation gen;
+        memcpy(&gen, entry, sizeof(Generation));
+        if (!emptyEntry(entry) && converter.convert(gen, entry + sizeof(Generation), target, dest))
+        {
+            converted++;
+        }
+        else
+        {
+            std::fill_n(dest, length, 0);
+        }
+    }
+    return converted;
+}
+
+std::vector<u8> BankBoxStore::encodeBox(const u8* box, bool compress, bool& compressed)
+{
+    std::vector<u8> out;
+    for (int slot = 0; slot < 30; slot++)
+    {
+        const u8* entry = box + slot * ENTRY_SIZE;
+        const u8* entryEnd = entry + ENTRY_SIZE;
+        if (std::all_of(entry, entryEnd, [](u8 v) { return v == 0xFF; }))
+        {
+            out.push_back(EMPTY_ENTRY);
+            continue;
+        }
+        u32 gen;
+        memcpy(&gen, entry, 4);
+        if (gen >= RAW_ENTRY)
+        {
+            out.push_back(RAW_ENTRY);
+            out.insert(out.end(), entry, entryEnd);
+            continue;
+        }
+        const u8* data = entry + 4;
+        u16 length = 260;
+        while (length > 0 && data[length - 1] == 0xFF)
+        {
+            length--;
+        }
+        out.push_back(gen);
+        out.push_back(length & 0xFF);
+        out.push_back(length >> 8);
+        out.insert(out.end(), data, data + length);
+    }
+
+    compressed = false;
+    if (compress)
+    {
+        std::vector<u8> packed = BlockCompression::compress(out.data(), out.size());
+        if (packed.size() + 4 < out.size())
+        {
+            u32 size = out.size();
+            packed.insert(packed.begin(), (u8*)&size, (u8*)&size + 4);
+            compressed = true;
+            return packed;
+        }
+    }
+    return out;
+}
+
+bool BankBoxStore::decodeBox(const u8* blob, u32 length, bool compressed, u8* box)
+{
+    std::vector<u8> unpacked;
+    if (compressed)
+    {
+        u32 size;
+        if (length < 4 || (memcpy(&size, blob, 4), size > 30 * (1 + ENTRY_SIZE)))
+        {
+            return false;
+        }
+        unpacked.resize(size);
+        if (!BlockCompression::decompress(blob + 4, length - 4, unpacked.data(), size))
+        {
+            return false;
+        }
+        blob = unpacked.data();
+        length = size;
+    }
+
+    std::fill_n(box, BOX_SIZE, 0xFF);
+    u32 pos = 0;
+    for (int slot = 0; slot < 30; slot++)
+    {
+        u8* entry = box + slot * ENTRY_SIZE;
+        if (pos >= length)
+        {
+            return false;
+        }
+        u8 marker = blob[pos++];
+        if (marker == EMPTY_ENTRY)
+        {
+            continue;
+        }
+        if (marker == RAW_ENTRY)
+        {
+            if (length - pos < ENTRY_SIZE)
+            {
+                return false;
+            }
+            std::copy(blob + pos, blob + pos + ENTRY_SIZE, entry);
+            pos += ENTRY_SIZE;
+            continue;
+        }
+        if (length - pos < 2)
+        {
+            return false;
+        }
+        u16 dataLength = blob[pos] | (blob[pos + 1] << 8);
+        pos += 2;
+        if (dataLength > 260 || length - pos < dataLength)
+        {
+            return false;
+        }
+        u32 gen = marker;
+        memcpy(entry, &gen, 4);
+        std::copy(blob + pos, blob + pos + dataLength, entry + 4);
+        pos += dataLength;
+    }
+    return pos == length;
+}
+
+void BankBoxStore::attach(BankFile& file, const std::string& path, u32 headerSize)
+{
+    unmap();
+    this->file = &file;
+    this->path = path;
+    this->headerSize = headerSize;
+    directory.clear();
+    end = 0;
+}
+
+bool BankBoxStore::open(BankFile& file, const std::string& path, u32 headerSize, int boxes)
+{
+    attach(file, path, headerSize);
+    directory.resize(boxes);
+    if (!file.read(path, headerSize, (u8*)directory.data(), boxes * sizeof(Location)))
+    {
+        directory.clear();
+        return false;
+    }
+    end = headerSize + boxes * sizeof(Location);
+    for (auto& location : directory)
+    {
+        if (location.length > location.capacity || location.offset < headerSize + boxes * sizeof(Location))
+        {
+            directory.clear();
+            return false;
+        }
+        end = std::max(end, location.offset + location.capacity);
+    }
+    map();
+    return true;
+}
+
+bool BankBoxStore::readBox(int box, u8* out) const
+{
+    const Location& location = directory[box];
+    if (mapping)
+    {
+        return decodeBox(mapping + location.offset, location.length, location.flags & COMPRESSED, out);
+    }
+    std::vector<u8> blob(location.length);
+    return file->read(path, location.offset, blob.data(), blob.size()) && decodeBox(blob.data(), blob.size(), location.flags & COMPRESSED, out);
+}
+
+bool BankBoxStore::readStored(int box, std::vector<u8>& blob) const
+{
+    if (box >= (int)directory.size())
+    {
+        return false;
+    }
+    const Location& location = directory[box];
+    if (mapping)
+    {
+        blob.assign(mapping + location.offset, mapping + location.offset + location.length);
+        return true;
+    }
+    blob.resize(location.length);
+    return file->read(path, location.offset, blob.data(), blob.size());
+}
+
+bool BankBoxStore::save(const std::vector<u8>& header, int boxes, const BankChangeTracker::Boxes& data, const std::vector<int>& changed, bool rewrite, bool resizable)
+{
+    u32 boxesStart = headerSize + boxes * sizeof(Location);
+    std::vector<Location> newDirectory = directory;
+    std::vector<BankJournal::Write> writes;
+    u32 newEnd = end;
+    bool compressed;
+
+    rewrite = rewrite || (int)directory.size() != boxes;
+    if (!rewrite)
+    {
+        for (int box : changed)
+        {
+            const u8* boxData = data(box);
+            if (!boxData)
+            {
+                continue;
+            }
+            std::vector<u8> blob = encodeBox(boxData, compress, compressed);
+            Location& location = newDirectory[box];
+            if (blob.size() > location.capacity)
+            {
+                location.offset = newEnd;
+                location.capacity = blob.size();
+                newEnd += blob.size();
+            }
+            location.length = blob.size();
+            location.flags = compressed ? COMPRESSED : 0;
+            writes.emplace_back(location.offset, std::move(blob));
+        }
+        u32 live = boxesStart;
+        for (auto& location : newDirectory)
+        {
+            live += location.capacity;
+        }
+        rewrite = newEnd > 2 * live || (!resizable && newEnd != end);
+    }
+    BankJournal journal(*file, path);
+    journal.begin();
+    if (rewrite)
+    {
+        // Each box goes to the journal as soon as it is encoded, so only a batch of the
+        // new file is held at a time rather than all of it
+        newDirectory.resize(boxes);
+        newEnd = boxesStart;
+        for (int box = 0; box < boxes; box++)
+        {
+            const u8* boxData = data(box);
+            std::vector<u8> blob;
+            u32 flags;
+            if (boxData)
+            {
+                blob = encodeBox(boxData, compress, compressed);
+                flags = compressed ? COMPRESSED : 0;
+            }
+            else if (readStored(box, blob))
+            {
+                flags = directory[box].flags;
+            }
+            else
+            {
+                return false;
+            }
+            newDirectory[box] = {newEnd, (u32)blob.size(), (u32)blob.size(), flags};
+            newEnd += blob.size();
+            if (!journal.add(newDirectory[box].offset, blob.data(), blob.size()))
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        for (auto& write : writes)
+        {
+            journal.add(write.first, write.second.data(), write.second.size());
+        }
+    }
+    journal.add(0, header.data(), header.size());
+    journal.add(headerSize, (u8*)newDirectory.data(), boxes * sizeof(Location));
+
+    unmap();
+    bool good = journal.commit(newEnd);
+    if (good)
+    {
+        directory = newDirectory;
+        end = newEnd;
+    }
+    map();
+    return good;
+}
+
+void BankBoxStore::map()
+{
+    mappedSize = end;
+    mapping = end > 0 ? file->map(path, end) : nullptr;
+}
+
+void BankBoxStore::unmap()
+{
+    if (mapping)
+    {
+        file->unmap(mapping, mappedSize);
+        mapping = nullptr;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include "BankChangeTracker.hpp"
+
+BankChangeTracker::Hash BankChangeTracker::hashBox(const u8* boxData) const
+{
+    Hash hash;
+    sha256(hash.data(), (u8*)boxData, boxSize);
+    return hash;
+}
+
+void BankChangeTracker::reset(const Boxes& data, size_t boxSize, int boxes)
+{
+    this->boxSize = boxSize;
+    hashes.resize(boxes);
+    dirty.assign(boxes, false);
+    known.assign(boxes, true);
+    for (int box = 0; box < boxes; box++)
+    {
+        hashes[box] = hashBox(data(box));
+    }
+}
+
+void BankChangeTracker::reset(size_t boxSize, int boxes)
+{
+    this->boxSize = boxSize;
+    hashes.assign(boxes, Hash{});
+    dirty.assign(boxes, false);
+    known.assign(boxes, false);
+}
+
+void BankChangeTracker::resize(int boxes)
+{
+    hashes.resize(boxes, Hash{});
+    dirty.resize(boxes, true);
+    known.resize(boxes, true);
+}
+
+bool BankChangeTracker::changed(const Boxes& data)
+{
+    for (size_t box = 0; box < dirty.size(); box++)
+    {
+        if (dirty[box])
+        {
+            if (!known[box] || hashBox(data(box)) != hashes[box])
+            {
+                return true;
+            }
+            dirty[box] = false;
+        }
+    }
+    return false;
+}
+
+std::vector<int> BankChangeTracker::changedBoxes(const Boxes& data)
+{
+    std::vector<int> ret;
+    for (size_t box = 0; box < dirty.size(); box++)
+    {
+        if (dirty[box])
+        {
+            if (!known[box] || hashBox(data(box)) != hashes[box])
+            {
+                ret.push_back(box);
+            }
+            else
+            {
+                dirty[box] = false;
+            }
+        }
+    }
+    return ret;
+}
+
+void BankChangeTracker::saved(const u8* boxData, int box)
+{
+    hashes[box] = hashBox(boxData);
+    dirty[box] = false;
+    known[box] = true;
+}
+
+void BankChangeTracker::invalidate()
+{
+    std::fill(hashes.begin(), hashes.end(), Hash{});
+    dirty.assign(dirty.size(), true);
+    known.assign(known.size(), true);
+}
@@ -0,0 +1,195 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "BankIndex.hpp"
+
+void BankIndex::resize(size_t slots)
+{
+    species.resize(slots, 0);
+    forms.resize(slots, 0);
+    levels.resize(slots, 0);
+    natures.resize(slots, 0);
+    shinies.resize(slots, 0);
+    balls.resize(slots, 0);
+    tids.resize(slots, 0);
+    sids.resize(slots, 0);
+    ivTotals.resize(slots, 0);
+    heldItems.resize(slots, 0);
+    generations.resize(slots, (u8)Generation::UNUSED);
+    otNames.resize(slots, 0);
+}
+
+void BankIndex::clear(size_t slot)
+{
+    species[slot] = 0;
+    forms[slot] = 0;
+    levels[slot] = 0;
+    natures[slot] = 0;
+    shinies[slot] = 0;
+    balls[slot] = 0;
+    tids[slot] = 0;
+    sids[slot] = 0;
+    ivTotals[slot] = 0;
+    heldItems[slot] = 0;
+    generations[slot] = (u8)Generation::UNUSED;
+    otNames[slot] = 0;
+}
+
+u32 BankIndex::value(Column column, size_t slot) const
+{
+    switch (column)
+    {
+        case Column::SPECIES:
+            return species[slot];
+        case Column::FORM:
+            return forms[slot];
+        case Column::LEVEL:
+            return levels[slot];
+        case Column::NATURE:
+            return natures[slot];
+        case Column::SHINY:
+            return shinies[slot];
+        case Column::BALL:
+            return balls[slot];
+        case Column::TID:
+            return tids[slot];
+        case Column::SID:
+            return sids[slot];
+        case Column::IV_TOTAL:
+            return ivTotals[slot];
+        case Column::HELD_ITEM:
+            return heldItems[slot];
+        case Column::GENERATION:
+            return generations[slot];
+        case Column::OT_NAME:
+            return otNames[slot];
+    }
+    return 0;
+}
+
+u32 BankIndex::otNameId(const std::string& name) const
+{
+    auto found = otNameIds.find(name);
+    return found != otNameIds.end() ? found->second : 0xFFFFFFFF;
+}
+
+u32 BankIndex::intern(const std::string& name)
+{
+    auto found = otNameIds.find(name);
+    if (found != otNameIds.end())
+    {
+        return found->second;
+    }
+    u32 id = otNameTable.size();
+    otNameTable.push_back(name);
+    otNameIds.emplace(name, id);
+    return id;
+}
+
+template <typename T>
+void BankIndex::filterColumn(const std::vector<T>& column, u32 min, u32 max, std::vector<u8>& keep)
+{
+    for (size_t i = 0; i < column.size(); i++)
+    {
+        keep[i] &= column[i] >= min && column[i] <= max;
+    }
+}
+
+std::vector<u32> BankIndex::query(const std::vector<Filter>& filters) const
+{
+    // One pass per filtered column keeps each scan on a single contiguous array
+    std::vector<u8> keep(size());
+    for (size_t i = 0; i < size(); i++)
+    {
+        keep[i] = species[i] != 0;
+    }
+    for (auto& filter : filters)
+    {
+        switch (filter.column)
+        {
+            case Column::SPECIES:
+                filterColumn(species, filter.min, filter.max, keep);
+                break;
+            case Column::FORM:
+                filterColumn(forms, filter.min, filter.max, keep);
+                break;
+            case Column::LEVEL:
+                filterColumn(levels, filter.min, filter.max, keep);
+                break;
+            case Column::NATURE:
+                filterColumn(natures, filter.min, filter.max, keep);
+                break;
+            case Column::SHINY:
+                filterColumn(shinies, filter.min, filter.max, keep);
+                break;
+            case Column::BALL:
+                filterColumn(balls, filter.min, filter.max, keep);
+                break;
+            case Column::TID:
+                filterColumn(tids, filter.min, filter.max, keep);
+                break;
+            case Column::SID:
+                filterColumn(sids, filter.min, filter.max, keep);
+                break;
+            case Column::IV_TOTAL:
+                filterColumn(ivTotals, filter.min, filter.max, keep);
+                break;
+            case Column::HELD_ITEM:
+                filterColumn(heldItems, filter.min, filter.max, keep);
+                break;
+            case Column::GENERATION:
+                filterColumn(generations, filter.min, filter.max, keep);
+                break;
+            case Column::OT_NAME:
+                filterColumn(otNames, filter.min, filter.max, keep);
+                break;
+        }
+    }
+
+    std::vector<u32> ret;
+    for (size_t i = 0; i < size(); i++)
+    {
+        if (keep[i])
+        {
+            ret.push_back(i);
+        }
+    }
+    return ret;
+}
+
+std::vector<u32> BankIndex::query(const std::vector<Filter>& filters, Column orderBy, bool descending) const
+{
+    std::vector<u32> ret = query(filters);
+    std::vector<u32> keys(size());
+    for (u32 slot : ret)
+    {
+        keys[slot] = value(orderBy, slot);
+    }
+    std::stable_sort(ret.begin(), ret.end(), [&keys, descending](u32 slot1, u32 slot2) {
+        return descending ? keys[slot2] < keys[slot1] : keys[slot1] < keys[slot2];
+    });
+    return ret;
+}
@@ -0,0 +1,251 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <string.h>
+#include "BankJournal.hpp"
+
+extern "C" {
+#include "sha256.h"
+}
+
+// Record layout: magic, final bank size, part count, each part's length and
+// SHA-256, then each remaining range's offset, length and bytes, and finally a
+// SHA-256 of everything before it. A part holds ranges in the same form
+BankJournal::BankJournal(BankFile& file, const std::string& bankPath) : file(file), bankPath(bankPath), journalPath(bankPath + ".journal")
+{
+}
+
+void BankJournal::begin()
+{
+    // The old record goes first, as it does not describe the parts written from here on
+    file.remove(journalPath);
+    removeParts();
+    pending.clear();
+    parts.clear();
+    partCount = 0;
+    good = true;
+}
+
+bool BankJournal::add(u32 offset, const u8* data, u32 length)
+{
+    // Longer ranges are split so that no batch outgrows BATCH
+    do
+    {
+        u32 piece = std::min(length, BATCH);
+        if (!pending.empty() && pending.size() + 8 + piece > BATCH)
+        {
+            flush();
+        }
+        u32 range[2] = {offset, piece};
+        pending.insert(pending.end(), (u8*)range, (u8*)(range + 2));
+        pending.insert(pending.end(), data, data + piece);
+        offset += piece;
+        data += piece;
+        length -= piece;
+    } while (length > 0);
+    return good;
+}
+
+void BankJournal::flush()
+{
+    u32 length = pending.size();
+    u8 hash[SHA256_BLOCK_SIZE];
+    sha256(hash, pending.data(), length);
+    parts.insert(parts.end(), (u8*)&length, (u8*)&length + 4);
+    parts.insert(parts.end(), hash, hash + SHA256_BLOCK_SIZE);
+    // A part left over from an older record may be longer than this one
+    std::string path = partPath(partCount++);
+    file.remove(path);
+    good = file.write(path, 0, pending.data(), length) && good;
+    pending.clear();
+}
+
+bool BankJournal::finish(u32 size, std::vector<u8>& record)
+{
+    record.assign(MAGIC.begin(), MAGIC.end());
+    u32 header[2] = {size, partCount};
+    record.insert(record.end(), (u8*)header, (u8*)(header + 2));
+    record.insert(record.end(), parts.begin(), parts.end());
+    record.insert(record.end(), pending.begin(), pending.end());
+    record.resize(record.size() + SHA256_BLOCK_SIZE);
+    sha256(record.data() + record.size() - SHA256_BLOCK_SIZE, record.data(), record.size() - SHA256_BLOCK_SIZE);
+    pending.clear();
+    parts.clear();
+    // Written only once every part is, so a complete record never names a missing one
+    return good && file.write(journalPath, 0, record.data(), record.size());
+}
+
+bool BankJournal::prepare(u32 size)
+{
+    std::vector<u8> record;
+    return finish(size, record);
+}
+
+bool BankJournal::commit(u32 size)
+{
+    std::vector<u8> record;
+    if (!finish(size, record) || !apply(record) || !file.remove(journalPath))
+    {
+        return false;
+    }
+    removeParts();
+    return true;
+}
+
+bool BankJournal::prepare(const u8* image, u32 size, const std::vector<Range>& ranges)
+{
+    begin();
+    for (auto& range : ranges)
+    {
+        add(range.first, image + range.first, range.second);
+    }
+    return prepare(size);
+}
+
+bool BankJournal::commit(const u8* image, u32 size, const std::vector<Range>& ranges)
+{
+    begin();
+    for (auto& range : ranges)
+    {
+        add(range.first, image + range.first, range.second);
+    }
+    return commit(size);
+}
+
+bool BankJournal::commit(const Source& image, u32 size, const std::vector<Range>& ranges)
+{
+    begin();
+    std::vector<u8> buffer;
+    for (auto& range : ranges)
+    {
+        buffer.resize(range.second);
+        image(range, buffer.data());
+        add(range.first, buffer.data(), range.second);
+    }
+    return commit(size);
+}
+
+bool BankJournal::commit(const std::vector<Write>& writes, u32 size)
+{
+    begin();
+    for (auto& write : writes)
+    {
+        add(write.first, write.second.data(), write.second.size());
+    }
+    return commit(size);
+}
+
+bool BankJournal::recover()
+{
+    std::vector<u8> record;
+    if (!file.read(journalPath, record))
+    {
+        // Parts left by a record that was never finished
+        removeParts();
+        return true;
+    }
+    // A record that never finished writing means the bank was never touched.
+    // One that fails to apply is kept so the next load can try again
+    if (valid(record) && !apply(record))
+    {
+        return false;
+    }
+    if (!file.remove(journalPath))
+    {
+        return false;
+    }
+    removeParts();
+    return true;
+}
+
+bool BankJournal::valid(const std::vector<u8>& record)
+{
+    if (record.size() < MAGIC.size() + 8 + SHA256_BLOCK_SIZE || memcmp(record.data(), MAGIC.data(), MAGIC.size()))
+    {
+        return false;
+    }
+    size_t bodySize = record.size() - SHA256_BLOCK_SIZE;
+    u8 hash[SHA256_BLOCK_SIZE];
+    sha256(hash, (u8*)record.data(), bodySize);
+    return !memcmp(hash, record.data() + bodySize, SHA256_BLOCK_SIZE);
+}
+
+bool BankJournal::apply(const std::vector<u8>& record)
+{
+    u32 header[2];
+    memcpy(header, record.data() + MAGIC.size(), sizeof(header));
+    // Size first, so ranges past the old end have somewhere to go
+    if (!file.resize(bankPath, header[0]))
+    {
+        return false;
+    }
+    size_t pos = MAGIC.size() + sizeof(header);
+    std::vector<u8> part;
+    u8 hash[SHA256_BLOCK_SIZE];
+    for (u32 i = 0; i < header[1]; i++)
+    {
+        u32 length;
+        memcpy(&length, record.data() + pos, 4);
+        // Only the part this record was written with is replayed
+        if (!file.read(partPath(i), part) || part.size() != length)
+        {
+            return false;
+        }
+        sha256(hash, part.data(), part.size());
+        if (memcmp(hash, record.data() + pos + 4, SHA256_BLOCK_SIZE) || !applyRanges(part.data(), part.size()))
+        {
+            return false;
+        }
+        pos += 4 + SHA256_BLOCK_SIZE;
+    }
+    return applyRanges(record.data() + pos, record.size() - SHA256_BLOCK_SIZE - pos);
+}
+
+bool BankJournal::applyRanges(const u8* ranges, u32 length)
+{
+    for (u32 pos = 0; pos < length;)
+    {
+        u32 offset, size;
+        memcpy(&offset, ranges + pos, 4);
+        memcpy(&size, ranges + pos + 4, 4);
+        if (!file.write(bankPath, offset, ranges + pos + 8, size))
+        {
+            return false;
+        }
+        pos += 8 + size;
+    }
+    return true;
+}
+
+void BankJournal::removeParts()
+{
+    // Parts are written in order, so the first one missing ends them. A straggler past a gap
+    // does no harm: flush() recreates any part it reuses and apply() checks each one's hash
+    for (u32 part = 0; file.remove(partPath(part)); part++)
+    {
+    }
+}
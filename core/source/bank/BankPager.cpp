@@ -0,0 +1,193 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include "BankPager.hpp"
+
+void BankPager::open(BankFile& file, const std::string& path, u32 offset, int boxes)
+{
+    open([this](int box, u8* out) { return this->file->read(this->path, this->offset + box * boxSize, out, boxSize); }, boxes);
+    this->file = &file;
+    this->path = path;
+    this->offset = offset;
+    if (boxes > 0)
+    {
+        mappedSize = offset + boxes * boxSize;
+        mapping = file.map(path, mappedSize);
+    }
+}
+
+void BankPager::open(const Loader& loader, int boxes)
+{
+    close();
+    this->loader = loader;
+    where.assign(boxes, pages.end());
+    unreadable.assign(boxes, false);
+}
+
+void BankPager::close()
+{
+    pages.clear();
+    where.clear();
+    unreadable.clear();
+    if (mapping)
+    {
+        file->unmap(mapping, mappedSize);
+        mapping = nullptr;
+    }
+    mappedSize = 0;
+    loader = nullptr;
+    file = nullptr;
+}
+
+std::list<BankPager::Page>::iterator BankPager::load(int box)
+{
+    u32 start = offset + box * boxSize;
+    Page page{box, false, std::unique_ptr<u8[]>(new u8[boxSize])};
+    if (mapping && start + boxSize <= mappedSize)
+    {
+        std::copy(mapping + start, mapping + start + boxSize, page.data.get());
+        counters.mapped++;
+        if (observer)
+        {
+            observer(box, page.data.get());
+        }
+    }
+    else
+    {
+        if (!loader)
+        {
+            std::fill_n(page.data.get(), boxSize, 0xFF);
+        }
+        else if (!loader(box, page.data.get()))
+        {
+            std::fill_n(page.data.get(), boxSize, 0xFF);
+            unreadable[box] = true;
+            counters.failures++;
+        }
+        else if (observer)
+        {
+            observer(box, page.data.get());
+        }
+        counters.misses++;
+    }
+    pages.push_front(std::move(page));
+    where[box] = pages.begin();
+    evict();
+    return pages.begin();
+}
+
+void BankPager::evict()
+{
+    // Never the front page: it is the one just asked for
+    auto page = pages.end();
+    while (pages.size() > pageBudget && --page != pages.begin())
+    {
+        if (!page->pinned)
+        {
+            where[page->box] = pages.end();
+            page = pages.erase(page);
+            counters.evictions++;
+        }
+    }
+}
+
+const u8* BankPager::box(int box)
+{
+    auto page = where[box];
+    if (page != pages.end())
+    {
+        pages.splice(pages.begin(), pages, page);
+        counters.hits++;
+        return page->data.get();
+    }
+    u32 start = offset + box * boxSize;
+    if (mapping && start + boxSize <= mappedSize)
+    {
+        counters.mapped++;
+        if (observer)
+        {
+            observer(box, mapping + start);
+        }
+        return mapping + start;
+    }
+    return load(box)->data.get();
+}
+
+u8* BankPager::edit(int box)
+{
+    auto page = where[box];
+    if (page != pages.end())
+    {
+        pages.splice(pages.begin(), pages, page);
+        counters.hits++;
+    }
+    else
+    {
+        page = load(box);
+    }
+    page->pinned = true;
+    return page->data.get();
+}
+
+void BankPager::saved(int box)
+{
+    if (where[box] != pages.end())
+    {
+        where[box]->pinned = false;
+        evict();
+    }
+}
+
+void BankPager::resize(int boxes)
+{
+    for (int box = boxes; box < (int)where.size(); box++)
+    {
+        if (where[box] != pages.end())
+        {
+            pages.erase(where[box]);
+        }
+    }
+    int oldBoxes = where.size();
+    where.resize(boxes, pages.end());
+    unreadable.resize(boxes, false);
+    for (int box = oldBoxes; box < boxes; box++)
+    {
+        Page page{box, true, std::unique_ptr<u8[]>(new u8[boxSize])};
+        std::fill_n(page.data.get(), boxSize, 0xFF);
+        pages.push_front(std::move(page));
+        where[box] = pages.begin();
+    }
+}
+
+void BankPager::budget(size_t boxes)
+{
+    pageBudget = boxes;
+    if (!pages.empty())
+    {
+        evict();
+    }
+}
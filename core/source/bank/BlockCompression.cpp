@@ -0,0 +1,184 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <string.h>
+#include "BlockCompression.hpp"
+
+namespace
+{
+    constexpr int HASH_BITS = 12;
+    constexpr size_t MIN_MATCH = 4;
+    // The format ends every block with at least this many literals
+    constexpr size_t LAST_LITERALS = 5;
+    constexpr size_t MATCH_LIMIT = 12;
+
+    void writeLength(std::vector<u8>& out, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            out.push_back(255);
+        }
+        out.push_back(length);
+    }
+
+    bool readLength(const u8* in, size_t inSize, size_t& pos, size_t& length)
+    {
+        u8 byte;
+        do
+        {
+            if (pos >= inSize)
+            {
+                return false;
+            }
+            byte = in[pos++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    void writeSequence(std::vector<u8>& out, const u8* literals, size_t literalLength, u16 offset, size_t matchLength)
+    {
+        size_t matchCode = matchLength - MIN_MATCH;
+        out.push_back((std::min(literalLength, (size_t)15) << 4) | std::min(matchCode, (size_t)15));
+        if (literalLength >= 15)
+        {
+            writeLength(out, literalLength - 15);
+        }
+        out.insert(out.end(), literals, literals + literalLength);
+        out.push_back(offset & 0xFF);
+        out.push_back(offset >> 8);
+        if (matchCode >= 15)
+        {
+            writeLength(out, matchCode - 15);
+        }
+    }
+}
+
+std::vector<u8> BlockCompression::compress(const u8* in, size_t size)
+{
+    std::vector<u8> out;
+    out.reserve(size + size / 255 + 16);
+    // 16 KiB, too much for the stack of the writer thread this runs on
+    std::vector<int> table(1 << HASH_BITS, -1);
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    size_t limit = size > MATCH_LIMIT ? size - MATCH_LIMIT : 0;
+    while (pos < limit)
+    {
+        u32 sequence;
+        memcpy(&sequence, in + pos, 4);
+        u32 hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        int candidate = table[hash];
+        table[hash] = pos;
+        if (candidate < 0 || pos - candidate > 0xFFFF || memcmp(in + candidate, in + pos, 4))
+        {
+            pos++;
+            continue;
+        }
+        size_t length = MIN_MATCH;
+        while (pos + length < size - LAST_LITERALS && in[candidate + length] == in[pos + length])
+        {
+            length++;
+        }
+        writeSequence(out, in + anchor, pos - anchor, pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+
+    size_t literalLength = size - anchor;
+    out.push_back(std::min(literalLength, (size_t)15) << 4);
+    if (literalLength >= 15)
+    {
+        writeLength(out, literalLength - 15);
+    }
+    out.insert(out.end(), in + anchor, in + size);
+    return out;
+}
+
+bool BlockCompression::decompress(const u8* in, size_t inSize, u8* out, size_t size)
+{
+    size_t pos = 0;
+    size_t written = 0;
+    while (pos < inSize)
+    {
+        u8 token = in[pos++];
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, inSize, pos, literalLength))
+        {
+            return false;
+        }
+        if (literalLength > inSize - pos || literalLength > size - written)
+        {
+            return false;
+        }
+        std::copy(in + pos, in + pos + literalLength, out + written);
+        pos += literalLength;
+        written += literalLength;
+        // The last sequence has no match
+        if (pos == inSize)
+        {
+            break;
+        }
+
+        if (inSize - pos < 2)
+        {
+            return false;
+        }
+        size_t offset = in[pos] | (in[pos + 1] << 8);
+        pos += 2;
+        size_t matchLength = (token & 15) + MIN_MATCH;
+        if ((token & 15) == 15 && !readLength(in, inSize, pos, matchLength))
+        {
+            return false;
+        }
+        if (offset == 0 || offset > written || matchLength > size - written)
+        {
+            return false;
+        }
+        u8* match = out + written;
+        if (offset >= matchLength)
+        {
+            std::copy(match - offset, match - offset + matchLength, match);
+        }
+        else if (offset == 1)
+        {
+            // A run of one byte, which is most of what banks compress
+            std::fill_n(match, matchLength, match[-1]);
+        }
+        else
+        {
+            // Byte by byte, since the match overlaps the bytes it produces
+            for (size_t i = 0; i < matchLength; i++)
+            {
+                out[written + i] = out[written + i - offset];
+            }
+        }
+        written += matchLength;
+    }
+    return written == size;
+}
@@ -0,0 +1,301 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <string.h>
+#include "GlobalBankIndex.hpp"
+#include "BankJournal.hpp"
+
+extern "C" {
+#include "sha256.h"
+}
+
+// File layout: magic, version, bank count, then for each bank its name, revision (0 for
+// none), box count and every box's occupied slots, and finally a SHA-256 of everything
+// before it. Version 1 files lack the revisions and version 2 ones hold hashes of the
+// bank files instead, so both are rebuilt like damaged ones
+namespace
+{
+    template <typename T>
+    void put(std::vector<u8>& out, T value)
+    {
+        size_t at = out.size();
+        out.resize(at + sizeof(T));
+        memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    void putString(std::vector<u8>& out, const std::string& value)
+    {
+        put<u16>(out, value.size());
+        out.insert(out.end(), value.begin(), value.end());
+    }
+
+    // Reads forward through a buffer, failing once anything would run past its end
+    struct Reader
+    {
+        const u8* data;
+        size_t size;
+        size_t at = 0;
+        bool good = true;
+
+        template <typename T>
+        T get()
+        {
+            T ret{};
+            if (at + sizeof(T) > size)
+            {
+                good = false;
+                return ret;
+            }
+            memcpy(&ret, data + at, sizeof(T));
+            at += sizeof(T);
+            return ret;
+        }
+
+        std::string getString()
+        {
+            u16 length = get<u16>();
+            if (!good || at + length > size)
+            {
+                good = false;
+                return "";
+            }
+            std::string ret((const char*)data + at, length);
+            at += length;
+            return ret;
+        }
+    };
+}
+
+bool GlobalBankIndex::load(BankFile& file, const std::string& path)
+{
+    banks.clear();
+    revisions.clear();
+    std::vector<u8> data;
+    // A half replayed index is rebuilt from the banks like a missing one
+    if (!BankJournal(file, path).recover() || !file.read(path, data) || data.size() < MAGIC.size() + 8 + SHA256_BLOCK_SIZE)
+    {
+        return false;
+    }
+    size_t bodySize = data.size() - SHA256_BLOCK_SIZE;
+    u8 hash[SHA256_BLOCK_SIZE];
+    sha256(hash, data.data(), bodySize);
+    if (memcmp(hash, data.data() + bodySize, SHA256_BLOCK_SIZE) || memcmp(data.data(), MAGIC.data(), MAGIC.size()))
+    {
+        return false;
+    }
+
+    Reader in{data.data(), bodySize, MAGIC.size()};
+    if (in.get<u32>() != VERSION)
+    {
+        return false;
+    }
+    u32 count = in.get<u32>();
+    for (u32 i = 0; in.good && i < count; i++)
+    {
+        std::string name = in.getString();
+        Boxes& boxes = banks[name];
+        if (u32 revision = in.get<u32>())
+        {
+            revisions[name] = revision;
+        }
+        u32 boxCount = in.get<u32>();
+        // Every box takes at least a byte, which keeps a damaged count from allocating wildly
+        if (!in.good || boxCount > bodySize - in.at)
+        {
+            in.good = false;
+            break;
+        }
+        boxes.resize(boxCount);
+        for (auto& box : boxes)
+        {
+            box.resize(in.get<u8>());
+            for (auto& entry : box)
+            {
+                entry.slot = in.get<u8>();
+                entry.form = in.get<u8>();
+                entry.shiny = in.get<u8>();
+                entry.species = in.get<u16>();
+                entry.PID = in.get<u32>();
+                entry.encryptionConstant = in.get<u32>();
+                entry.otName = in.getString();
+            }
+            if (!in.good)
+            {
+                break;
+            }
+        }
+    }
+    if (!in.good || in.at != bodySize)
+    {
+        banks.clear();
+        revisions.clear();
+        return false;
+    }
+    return true;
+}
+
+std::vector<u8> GlobalBankIndex::serialize() const
+{
+    std::vector<u8> out(MAGIC.begin(), MAGIC.end());
+    put<u32>(out, VERSION);
+    put<u32>(out, banks.size());
+    for (auto& bank : banks)
+    {
+        putString(out, bank.first);
+        auto found = revisions.find(bank.first);
+        put<u32>(out, found == revisions.end() ? 0 : found->second);
+        put<u32>(out, bank.second.size());
+        for (auto& box : bank.second)
+        {
+            put<u8>(out, box.size());
+            for (auto& entry : box)
+            {
+                put<u8>(out, entry.slot);
+                put<u8>(out, entry.form);
+                put<u8>(out, entry.shiny);
+                put<u16>(out, entry.species);
+                put<u32>(out, entry.PID);
+                put<u32>(out, entry.encryptionConstant);
+                putString(out, entry.otName);
+            }
+        }
+    }
+    size_t bodySize = out.size();
+    out.resize(bodySize + SHA256_BLOCK_SIZE);
+    sha256(out.data() + bodySize, out.data(), bodySize);
+    return out;
+}
+
+bool GlobalBankIndex::save(BankFile& file, const std::string& path, const std::vector<u8>& contents)
+{
+    return BankJournal(file, path).commit({{0, contents}}, contents.size());
+}
+
+bool GlobalBankIndex::current(const std::string& bank, u32 revision) const
+{
+    auto found = revisions.find(bank);
+    return found != revisions.end() && found->second == revision;
+}
+
+int GlobalBankIndex::boxes(const std::string& bank) const
+{
+    auto found = banks.find(bank);
+    return found == banks.end() ? 0 : found->second.size();
+}
+
+void GlobalBankIndex::resize(const std::string& bank, int boxes)
+{
+    banks[bank].resize(boxes);
+}
+
+void GlobalBankIndex::set(const std::string& bank, int box, int slot, const PKX& pkm)
+{
+    if (pkm.species() == 0)
+    {
+        clear(bank, box, slot);
+        return;
+    }
+    auto& entries = banks[bank][box];
+    auto entry = std::find_if(entries.begin(), entries.end(), [slot](const Entry& entry) { return entry.slot >= slot; });
+    if (entry == entries.end() || entry->slot != slot)
+    {
+        entry = entries.insert(entry, Entry{});
+    }
+    entry->slot = slot;
+    entry->form = pkm.alternativeForm();
+    entry->shiny = pkm.shiny();
+    entry->species = pkm.species();
+    entry->PID = pkm.PID();
+    entry->encryptionConstant = pkm.encryptionConstant();
+    entry->otName = pkm.otName();
+}
+
+void GlobalBankIndex::clear(const std::string& bank, int box, int slot)
+{
+    auto& entries = banks[bank][box];
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [slot](const Entry& entry) { return entry.slot == slot; }), entries.end());
+}
+
+void GlobalBankIndex::remove(const std::string& bank)
+{
+    banks.erase(bank);
+    revisions.erase(bank);
+}
+
+void GlobalBankIndex::rename(const std::string& oldName, const std::string& newName)
+{
+    auto found = banks.find(oldName);
+    if (found != banks.end() && oldName != newName)
+    {
+        banks[newName] = std::move(found->second);
+        banks.erase(oldName);
+        // The file keeps its header under its new name
+        auto revision = revisions.find(oldName);
+        if (revision != revisions.end())
+        {
+            revisions[newName] = revision->second;
+            revisions.erase(revision);
+        }
+        else
+        {
+            revisions.erase(newName);
+        }
+    }
+}
+
+std::vector<GlobalBankIndex::Location> GlobalBankIndex::find(const Query& query) const
+{
+    std::vector<Location> ret;
+    for (auto& bank : banks)
+    {
+        for (size_t box = 0; box < bank.second.size(); box++)
+        {
+            for (auto& entry : bank.second[box])
+            {
+                if ((!query.species || entry.species == *query.species) && (!query.form || entry.form == *query.form) &&
+                    (!query.shiny || entry.shiny == *query.shiny) && (!query.otName || entry.otName == *query.otName) &&
+                    (!query.PID || entry.PID == *query.PID) && (!query.encryptionConstant || entry.encryptionConstant == *query.encryptionConstant))
+                {
+                    ret.push_back({bank.first, (int)box, entry.slot});
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+size_t GlobalBankIndex::size() const
+{
+    size_t ret = 0;
+    for (auto& bank : banks)
+    {
+        for (auto& box : bank.second)
+        {
+            ret += box.size();
+        }
+    }
+    return ret;
+}
@@ -101,7 +101,7 @@ void LanguageStrings::load(Language lang, const std::string name, std::vector<st
     while (!feof(values) && !ferror(values))
     {
         size = std::max(size, (size_t)128);
-        if (__getline(&data, &size, values) >= 0)
+        if (getline(&data, &size, values) >= 0)
         {
             tmp = std::string(data);
             tmp = tmp.substr(0, tmp.find('\n'));
@@ -133,7 +133,7 @@ void LanguageStrings::loadMap(Language lang, const std::string name, std::unorde
     while (!feof(values) && !ferror(values))
     {
         size = std::max(size, (size_t)128);
-        if (__getline(&data, &size, values) >= 0)
+        if (getline(&data, &size, values) >= 0)
         {
             tmp = std::string(data);
             tmp = tmp.substr(0, tmp.find('\n'));
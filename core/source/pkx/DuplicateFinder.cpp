@@ -0,0 +1,65 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "DuplicateFinder.hpp"
+
+void DuplicateFinder::reserve(size_t slots)
+{
+    seen.reserve(slots);
+    order.reserve(slots);
+}
+
+void DuplicateFinder::file(u64 key, const Location& location)
+{
+    count++;
+    auto& locations = seen[key];
+    if (locations.empty())
+    {
+        order.push_back(key);
+    }
+    locations.push_back(location);
+}
+
+std::vector<std::vector<DuplicateFinder::Location>> DuplicateFinder::groups() const
+{
+    std::vector<std::vector<Location>> ret;
+    for (u64 key : order)
+    {
+        auto& locations = seen.at(key);
+        if (locations.size() > 1)
+        {
+            ret.push_back(locations);
+        }
+    }
+    return ret;
+}
+
+void DuplicateFinder::clear()
+{
+    count = 0;
+    seen.clear();
+    order.clear();
+}
@@ -29,47 +29,18 @@
 
 void PB7::shuffleArray(u8 sv)
 {
-    static const int blockLength = 56;
-    u8 index = sv * 4;
-    
-    u8 cdata[length];
-    std::copy(data, data + length, cdata);
-
-    for (u8 block = 0; block < 4; block++)
-    {
-        u8 ofs = blockPosition(index + block);
-        std::copy(
-            cdata + 8 + blockLength * ofs, 
-            cdata + 8 + blockLength * ofs + blockLength, 
-            data + 8 + blockLength * block
-        );
-    }
+    shuffleData(data, 56, sv);
 }
 
 void PB7::crypt(void)
 {
-    u32 seed = encryptionConstant();
-    for (int i = 0x08; i < 232; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
-    seed = encryptionConstant();
-    for (u32 i = 232; i < length; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
+    cryptData(data, length, encryptionConstant(), 232);
 }
 
 PB7::PB7(u8* dt, bool ekx)
 {
     length = 260;
-    data = new u8[length];
+    data = (u8*)PKXPool::allocate(length);
     std::fill_n(data, length, 0);
 
     std::copy(dt, dt + length, data);
@@ -79,7 +50,7 @@ PB7::PB7(u8* dt, bool ekx)
     }
 }
 
-std::shared_ptr<PKX> PB7::clone(void) { return std::make_shared<PB7>(data); }
+std::shared_ptr<PKX> PB7::clone(void) { return PKXPool::make<PB7>(data); }
 
 Generation PB7::generation(void) const { return Generation::LGPE; }
 
@@ -359,10 +330,7 @@ u16 PB7::PSV(void) const { return ((PID() >> 16) ^ (PID() & 0xFFFF)) >> 4; }
 
 u8 PB7::level(void) const
 {
-    u8 i = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100);
-    return i;
+    return levelFromExp(experience(), expType());
 }
 
 void PB7::level(u8 v)
@@ -373,19 +341,9 @@ void PB7::level(u8 v)
 bool PB7::shiny(void) const { return TSV() == PSV(); }
 void PB7::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), v, generation()));
     }
 }
 
@@ -29,47 +29,18 @@
 
 void PK4::shuffleArray(u8 sv)
 {
-    static const int blockLength = 32;
-    u8 index = sv * 4;
-    
-    u8 cdata[length];
-    std::copy(data, data + length, cdata);
-
-    for (u8 block = 0; block < 4; block++)
-    {
-        u8 ofs = blockPosition(index + block);
-        std::copy(
-            cdata + 8 + blockLength * ofs, 
-            cdata + 8 + blockLength * ofs + blockLength, 
-            data + 8 + blockLength * block
-        );
-    }
+    shuffleData(data, 32, sv);
 }
 
 void PK4::crypt(void)
 {
-	u32 seed = checksum();
-
-    for (int i = 0x08; i < 136; i += 2)
-    {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i+1] ^= (seed >> 24);
-    }
-
-    seed = PID();
-    for (u32 i = 136; i < length; i += 2)
-    {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i+1] ^= (seed >> 24);
-    }
+    cryptData(data, length, checksum(), 136);
 }
 
 PK4::PK4(u8* dt, bool ekx, bool party)
 {
     length = party ? 236 : 136;
-    data = new u8[length];
+    data = (u8*)PKXPool::allocate(length);
     std::fill_n(data, length, 0);
     
     std::copy(dt, dt + length, data);
@@ -77,7 +48,7 @@ PK4::PK4(u8* dt, bool ekx, bool party)
         decrypt();
 }
 
-std::shared_ptr<PKX> PK4::clone(void) { return std::make_shared<PK4>(data, false, length == 236); }
+std::shared_ptr<PKX> PK4::clone(void) { return PKXPool::make<PK4>(data, false, length == 236); }
 
 Generation PK4::generation(void) const { return Generation::FOUR; }
 
@@ -93,22 +64,7 @@ void PK4::currentHandler(u8 v) { (void)v; }
 u8 PK4::abilityNumber(void) const { return 1 << ((PID() >> 16) & 1); }
 void PK4::abilityNumber(u8 v)
 {
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        }
-        while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        }
-        while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, TID(), SID(), shiny(), generation()));
 }
 
 u32 PK4::PID(void) const { return *(u32*)(data); }
@@ -213,22 +169,7 @@ u8 PK4::gender(void) const { return (data[0x40] >> 1) & 0x3; }
 void PK4::gender(u8 g)
 {
     data[0x40] = u8((data[0x40] & ~0x06) | (g << 1));
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-        while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-        while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), shiny(), generation()));
 }
 
 u8 PK4::alternativeForm(void) const { return data[0x40] >> 3; }
@@ -237,22 +178,7 @@ void PK4::alternativeForm(u8 v) { data[0x40] = u8((data[0x40] & 0x07) | (v << 3)
 u8 PK4::nature(void) const { return PID() % 25; }
 void PK4::nature(u8 v)
 {
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), v, alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-        while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), v, alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-        while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), gender(), version(), v, alternativeForm(), abilityNumber(), TID(), SID(), shiny(), generation()));
 }
 
 u8 PK4::shinyLeaf(void) const { return *(u8*)(data + 0x41); }
@@ -425,10 +351,7 @@ u16 PK4::PSV(void) const { return ((PID() >> 16) ^ (PID() & 0xFFFF)) >> 3; }
 
 u8 PK4::level(void) const
 {
-    u8 i = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100);
-    return i;
+    return levelFromExp(experience(), expType());
 }
 
 void PK4::level(u8 v)
@@ -439,19 +362,9 @@ void PK4::level(u8 v)
 bool PK4::shiny(void) const { return TSV() == PSV(); }
 void PK4::shiny(bool v)
 {
-    if (v)
-    {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
+    if (shiny() != v)
     {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), v, generation()));
     }
 }
 
@@ -501,7 +414,15 @@ u16 PK4::stat(const u8 stat) const
 
 std::shared_ptr<PKX> PK4::next(void) const
 {
-    u8 dt[136];
+    std::shared_ptr<PK5> pk5 = PKXPool::make<PK5>();
+    convertTo(*pk5);
+    pk5->refreshChecksum();
+    return pk5;
+}
+
+void PK4::convertTo(PK5& pk5) const
+{
+    u8* dt = pk5.rawData();
     std::copy(data, data + 136, dt);
 
     // Clear HGSS data
@@ -510,38 +431,36 @@ std::shared_ptr<PKX> PK4::next(void) const
     // Clear PtHGSS met data
     *(u32*)(dt + 0x44) = 0;
 
-    std::shared_ptr<PKX> pk5 = std::make_shared<PK5>(dt);
-
     time_t t = time(NULL);
     struct tm* timeStruct = gmtime((const time_t *) &t);
 
-    pk5->otFriendship(70);
-    pk5->metYear(timeStruct->tm_year - 100);
-    pk5->metMonth(timeStruct->tm_mon + 1);
-    pk5->metDay(timeStruct->tm_mday);
+    pk5.otFriendship(70);
+    pk5.metYear(timeStruct->tm_year - 100);
+    pk5.metMonth(timeStruct->tm_mon + 1);
+    pk5.metDay(timeStruct->tm_mday);
 
     // Force normal Arceus form
-    if (pk5->species() == 493)
+    if (pk5.species() == 493)
     {
-        pk5->alternativeForm(0);
+        pk5.alternativeForm(0);
     }
 
-    pk5->heldItem(0);
+    pk5.heldItem(0);
 
-    pk5->nature(nature());
+    pk5.nature(nature());
 
     // Check met location
-    pk5->metLocation(pk5->gen4() && pk5->fatefulEncounter() && std::find(beasts, beasts + 4, pk5->species()) != beasts + 4
-                ? (pk5->species() == 251 ? 30010 : 30012) // Celebi : Beast
+    pk5.metLocation(pk5.gen4() && pk5.fatefulEncounter() && std::find(beasts, beasts + 4, pk5.species()) != beasts + 4
+                ? (pk5.species() == 251 ? 30010 : 30012) // Celebi : Beast
                 : 30001); // Pokétransfer (not Crown)
 
-    pk5->ball(ball());
+    pk5.ball(ball());
 
-    pk5->nickname(nickname());
-    pk5->otName(otName());
+    pk5.nickname(nickname());
+    pk5.otName(otName());
 
     // Check level
-    pk5->metLevel(pk5->level());
+    pk5.metLevel(pk5.level());
     
     //Remove HM
     u16 moves[4] = { move(0), move(1), move(2), move(3) };
@@ -552,12 +471,9 @@ std::shared_ptr<PKX> PK4::next(void) const
         {
             moves[i] = 0;
         }
-        pk5->move(i, moves[i]);
+        pk5.move(i, moves[i]);
     }
-    pk5->fixMoves();
-
-    pk5->refreshChecksum();
-    return pk5;
+    pk5.fixMoves();
 }
 
 int PK4::partyCurrHP(void) const
@@ -30,47 +30,18 @@
 
 void PK5::shuffleArray(u8 sv)
 {
-    static const int blockLength = 32;
-    u8 index = sv * 4;
-    
-    u8 cdata[length];
-    std::copy(data, data + length, cdata);
-
-    for (u8 block = 0; block < 4; block++)
-    {
-        u8 ofs = blockPosition(index + block);
-        std::copy(
-            cdata + 8 + blockLength * ofs, 
-            cdata + 8 + blockLength * ofs + blockLength, 
-            data + 8 + blockLength * block
-        );
-    }
+    shuffleData(data, 32, sv);
 }
 
 void PK5::crypt(void)
 {
-    u32 seed = checksum();
-
-    for (int i = 0x08; i < 136; i += 2)
-    {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i+1] ^= (seed >> 24);
-    }
-
-    seed = PID();
-    for (u32 i = 136; i < length; i += 2)
-    {
-        seed = seedStep(seed);
-        data[i] ^= (seed >> 16);
-        data[i+1] ^= (seed >> 24);
-    }
+    cryptData(data, length, checksum(), 136);
 }
 
 PK5::PK5(u8* dt, bool ekx, bool party)
 {
     length = party ? 220 : 136;
-    data = new u8[length];
+    data = (u8*)PKXPool::allocate(length);
     std::fill_n(data, length, 0);
 
     std::copy(dt, dt + length, data);
@@ -78,7 +49,7 @@ PK5::PK5(u8* dt, bool ekx, bool party)
         decrypt();
 }
 
-std::shared_ptr<PKX> PK5::clone(void) { return std::make_shared<PK5>(data, false, length == 236); }
+std::shared_ptr<PKX> PK5::clone(void) { return PKXPool::make<PK5>(data, false, length == 220); }
 
 Generation PK5::generation(void) const { return Generation::FIVE; }
 
@@ -94,22 +65,7 @@ void PK5::currentHandler(u8 v) { (void)v; }
 u8 PK5::abilityNumber(void) const { return hiddenAbility() ? 4 : 1 << ((PID() >> 16) & 1); }
 void PK5::abilityNumber(u8 v)
 {
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        }
-        while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, PID(), generation()));
-        }
-        while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), v, TID(), SID(), shiny(), generation()));
 }
 
 u32 PK5::PID(void) const { return *(u32*)(data); }
@@ -214,22 +170,7 @@ u8 PK5::gender(void) const { return (data[0x40] >> 1) & 0x3; }
 void PK5::gender(u8 g)
 {
     data[0x40] = u8((data[0x40] & ~0x06) | (g << 1));
-    if (shiny())
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-        while (!shiny());
-    }
-    else
-    {
-        do
-        {
-            PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-        while (shiny());
-    }
+    PID(PKX::getRandomPID(species(), g, version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), shiny(), generation()));
 }
 
 u8 PK5::alternativeForm(void) const { return data[0x40] >> 3; }
@@ -341,10 +282,7 @@ u16 PK5::PSV(void) const { return ((PID() >> 16) ^ (PID() & 0xFFFF)) >> 3; }
 
 u8 PK5::level(void) const
 {
-    u8 i = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100);
-    return i;
+    return levelFromExp(experience(), expType());
 }
 
 void PK5::level(u8 v)
@@ -355,19 +293,9 @@ void PK5::level(u8 v)
 bool PK5::shiny(void) const { return TSV() == PSV(); }
 void PK5::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), v, generation()));
     }
 }
 
@@ -500,90 +428,97 @@ static void fixString(std::u16string& fixString)
 
 std::shared_ptr<PKX> PK5::next(void) const
 {
-    u8 dt[232] = {0};
-    PK6 *pk6 = new PK6(dt);
+    std::shared_ptr<PK6> pk6 = PKXPool::make<PK6>();
+    convertTo(*pk6);
+    pk6->refreshChecksum();
+    return pk6;
+}
 
-    pk6->encryptionConstant(PID());
-    pk6->species(species());
-    pk6->TID(TID());
-    pk6->SID(SID());
-    pk6->experience(experience());
-    pk6->PID(PID());
-    pk6->ability(ability());
+void PK5::convertTo(PK6& pk6) const
+{
+    std::fill_n(pk6.rawData(), pk6.getLength(), 0);
+
+    pk6.encryptionConstant(PID());
+    pk6.species(species());
+    pk6.TID(TID());
+    pk6.SID(SID());
+    pk6.experience(experience());
+    pk6.PID(PID());
+    pk6.ability(ability());
 
     u8 pkmAbilities[3] = { abilities(0), abilities(1), abilities(2) };
     u8 abilVal = std::distance(pkmAbilities, std::find(pkmAbilities, pkmAbilities + 3, ability()));
-    if (abilVal <= 3 && pkmAbilities[abilVal] == pkmAbilities[2] && hiddenAbility())
+    if (abilVal < 3 && pkmAbilities[abilVal] == pkmAbilities[2] && hiddenAbility())
     {
         abilVal = 2; // HA shared by normal ability
     }
-    if (abilVal <= 3)
+    if (abilVal < 3)
     {
-        pk6->abilityNumber(1 << abilVal);
+        pk6.abilityNumber(1 << abilVal);
     }
     else // Shouldn't happen
     {
         if (hiddenAbility())
         {
-            pk6->abilityNumber(4);
+            pk6.abilityNumber(4);
         }
         else
         {
-            pk6->abilityNumber(gen5() ? ((PID() >> 16) & 1) : 1 << (PID() & 1));
+            pk6.abilityNumber(gen5() ? ((PID() >> 16) & 1) : 1 << (PID() & 1));
         }
     }
 
-    pk6->markValue(markValue());
-    pk6->language(language());
+    pk6.markValue(markValue());
+    pk6.language(language());
     
     for (int i = 0; i < 6; i++)
     {
         // EV Cap
-        pk6->ev(i, ev(i) > 252 ? 252 : ev(i));
-        pk6->iv(i, iv(i));
-        pk6->contest(i, contest(i));
+        pk6.ev(i, ev(i) > 252 ? 252 : ev(i));
+        pk6.iv(i, iv(i));
+        pk6.contest(i, contest(i));
     }
 
     for (int i = 0; i < 4; i++)
     {
-        pk6->move(i, move(i));
-        pk6->PPUp(i, PPUp(i));
-        pk6->PP(i, PP(i));
+        pk6.move(i, move(i));
+        pk6.PPUp(i, PPUp(i));
+        pk6.PP(i, PP(i));
     }
 
-    pk6->egg(egg());
-    pk6->nicknamed(nicknamed());
+    pk6.egg(egg());
+    pk6.nicknamed(nicknamed());
 
-    pk6->fatefulEncounter(fatefulEncounter());
-    pk6->gender(gender());
-    pk6->alternativeForm(alternativeForm());
-    pk6->nature(nature());
+    pk6.fatefulEncounter(fatefulEncounter());
+    pk6.gender(gender());
+    pk6.alternativeForm(alternativeForm());
+    pk6.nature(nature());
 
-    pk6->nickname(i18n::species(pk6->language(), pk6->species()));
-    if (nicknamed())
-        pk6->nickname(nickname());
+    // Looked up only when there is no nickname to cover it
+    std::string name = nicknamed() ? nickname() : std::string();
+    pk6.nickname(name.empty() ? i18n::species(pk6.language(), pk6.species()) : name);
 
-    pk6->version(version());
+    pk6.version(version());
 
-    pk6->otName(otName());
+    pk6.otName(otName());
 
-    pk6->metYear(metYear());
-    pk6->metMonth(metMonth());
-    pk6->metDay(metDay());
-    pk6->eggYear(eggYear());
-    pk6->eggMonth(eggMonth());
-    pk6->eggDay(eggDay());
+    pk6.metYear(metYear());
+    pk6.metMonth(metMonth());
+    pk6.metDay(metDay());
+    pk6.eggYear(eggYear());
+    pk6.eggMonth(eggMonth());
+    pk6.eggDay(eggDay());
 
-    pk6->metLocation(metLocation());
-    pk6->eggLocation(eggLocation());
+    pk6.metLocation(metLocation());
+    pk6.eggLocation(eggLocation());
 
-    pk6->pkrsStrain(pkrsStrain());
-    pk6->pkrsDays(pkrsDays());
-    pk6->ball(ball());
+    pk6.pkrsStrain(pkrsStrain());
+    pk6.pkrsDays(pkrsDays());
+    pk6.ball(ball());
 
-    pk6->metLevel(metLevel());
-    pk6->otGender(otGender());
-    pk6->encounterType(encounterType());
+    pk6.metLevel(metLevel());
+    pk6.otGender(otGender());
+    pk6.encounterType(encounterType());
 
     // Ribbon
     u8 contestRibbon = 0;
@@ -609,113 +544,113 @@ std::shared_ptr<PKX> PK5::next(void) const
     for (int i = 1; i < 7; i++) // Sinnoh Battle Ribbons
         if (((data[0x24] >> i) & 1) == 1) battleRibbon++;
 
-    pk6->ribbonContestCount(contestRibbon);
-    pk6->ribbonBattleCount(battleRibbon);
-
-    pk6->ribbon(0, 1, ribbon(6, 4)); // Hoenn Champion
-    pk6->ribbon(0, 2, ribbon(0, 0)); // Sinnoh Champ
-    pk6->ribbon(0, 7, ribbon(7, 0)); // Effort Ribbon
-
-    pk6->ribbon(1, 0, ribbon(0, 7)); // Alert
-    pk6->ribbon(1, 1, ribbon(1, 0)); // Shock
-    pk6->ribbon(1, 2, ribbon(1, 1)); // Downcast
-    pk6->ribbon(1, 3, ribbon(1, 2)); // Careless
-    pk6->ribbon(1, 4, ribbon(1, 3)); // Relax
-    pk6->ribbon(1, 5, ribbon(1, 4)); // Snooze
-    pk6->ribbon(1, 6, ribbon(1, 5)); // Smile
-    pk6->ribbon(1, 7, ribbon(1, 6)); // Gorgeous
-
-    pk6->ribbon(2, 0, ribbon(1, 7)); // Royal
-    pk6->ribbon(2, 1, ribbon(2, 0)); // Gorgeous Royal
-    pk6->ribbon(2, 2, ribbon(6, 7)); // Artist
-    pk6->ribbon(2, 3, ribbon(2, 1)); // Footprint
-    pk6->ribbon(2, 4, ribbon(2, 2)); // Record
-    pk6->ribbon(2, 5, ribbon(2, 4)); // Legend
-    pk6->ribbon(2, 6, ribbon(7, 4)); // Country
-    pk6->ribbon(2, 7, ribbon(7, 5)); // National
-
-    pk6->ribbon(3, 0, ribbon(7, 6)); // Earth
-    pk6->ribbon(3, 1, ribbon(7, 7)); // World
-    pk6->ribbon(3, 2, ribbon(3, 2)); // Classic
-    pk6->ribbon(3, 3, ribbon(3, 3)); // Premier
-    pk6->ribbon(3, 4, ribbon(2, 3)); // Event
-    pk6->ribbon(3, 5, ribbon(2, 6)); // Birthday
-    pk6->ribbon(3, 6, ribbon(2, 7)); // Special
-    pk6->ribbon(3, 7, ribbon(3, 0)); // Souvenir
-
-    pk6->ribbon(4, 0, ribbon(3, 1)); // Wishing Ribbon
-    pk6->ribbon(4, 1, ribbon(7, 1)); // Battle Champion
-    pk6->ribbon(4, 2, ribbon(7, 2)); // Regional Champion
-    pk6->ribbon(4, 3, ribbon(7, 3)); // National Champion
-    pk6->ribbon(4, 4, ribbon(2, 5)); // World Champion
-
-    pk6->region(TitleLoader::save->subRegion());
-    pk6->country(TitleLoader::save->country());
-    pk6->consoleRegion(TitleLoader::save->consoleRegion());
-
-    pk6->currentHandler(1);
-    pk6->htName(TitleLoader::save->otName());
-    pk6->htGender(TitleLoader::save->gender());
-    pk6->geoRegion(0, TitleLoader::save->subRegion());
-    pk6->geoCountry(0, TitleLoader::save->country());
-    pk6->htIntensity(1);
-    pk6->htMemory(4);
-    pk6->htFeeling(randomNumbers() % 10);
-    pk6->otFriendship(pk6->baseFriendship());
-    pk6->htFriendship(pk6->baseFriendship());
+    pk6.ribbonContestCount(contestRibbon);
+    pk6.ribbonBattleCount(battleRibbon);
+
+    pk6.ribbon(0, 1, ribbon(6, 4)); // Hoenn Champion
+    pk6.ribbon(0, 2, ribbon(0, 0)); // Sinnoh Champ
+    pk6.ribbon(0, 7, ribbon(7, 0)); // Effort Ribbon
+
+    pk6.ribbon(1, 0, ribbon(0, 7)); // Alert
+    pk6.ribbon(1, 1, ribbon(1, 0)); // Shock
+    pk6.ribbon(1, 2, ribbon(1, 1)); // Downcast
+    pk6.ribbon(1, 3, ribbon(1, 2)); // Careless
+    pk6.ribbon(1, 4, ribbon(1, 3)); // Relax
+    pk6.ribbon(1, 5, ribbon(1, 4)); // Snooze
+    pk6.ribbon(1, 6, ribbon(1, 5)); // Smile
+    pk6.ribbon(1, 7, ribbon(1, 6)); // Gorgeous
+
+    pk6.ribbon(2, 0, ribbon(1, 7)); // Royal
+    pk6.ribbon(2, 1, ribbon(2, 0)); // Gorgeous Royal
+    pk6.ribbon(2, 2, ribbon(6, 7)); // Artist
+    pk6.ribbon(2, 3, ribbon(2, 1)); // Footprint
+    pk6.ribbon(2, 4, ribbon(2, 2)); // Record
+    pk6.ribbon(2, 5, ribbon(2, 4)); // Legend
+    pk6.ribbon(2, 6, ribbon(7, 4)); // Country
+    pk6.ribbon(2, 7, ribbon(7, 5)); // National
+
+    pk6.ribbon(3, 0, ribbon(7, 6)); // Earth
+    pk6.ribbon(3, 1, ribbon(7, 7)); // World
+    pk6.ribbon(3, 2, ribbon(3, 2)); // Classic
+    pk6.ribbon(3, 3, ribbon(3, 3)); // Premier
+    pk6.ribbon(3, 4, ribbon(2, 3)); // Event
+    pk6.ribbon(3, 5, ribbon(2, 6)); // Birthday
+    pk6.ribbon(3, 6, ribbon(2, 7)); // Special
+    pk6.ribbon(3, 7, ribbon(3, 0)); // Souvenir
+
+    pk6.ribbon(4, 0, ribbon(3, 1)); // Wishing Ribbon
+    pk6.ribbon(4, 1, ribbon(7, 1)); // Battle Champion
+    pk6.ribbon(4, 2, ribbon(7, 2)); // Regional Champion
+    pk6.ribbon(4, 3, ribbon(7, 3)); // National Champion
+    pk6.ribbon(4, 4, ribbon(2, 5)); // World Champion
+
+    pk6.region(TitleLoader::save->subRegion());
+    pk6.country(TitleLoader::save->country());
+    pk6.consoleRegion(TitleLoader::save->consoleRegion());
+
+    pk6.currentHandler(1);
+    pk6.htName(TitleLoader::save->otName());
+    pk6.htGender(TitleLoader::save->gender());
+    pk6.geoRegion(0, TitleLoader::save->subRegion());
+    pk6.geoCountry(0, TitleLoader::save->country());
+    pk6.htIntensity(1);
+    pk6.htMemory(4);
+    pk6.htFeeling(randomNumbers() % 10);
+    pk6.otFriendship(pk6.baseFriendship());
+    pk6.htFriendship(pk6.baseFriendship());
 
     u32 shiny = 0;
     shiny = (PID() >> 16) ^ (PID() & 0xFFFF) ^ TID() ^ SID();
     if (shiny >= 8 && shiny < 16) // Illegal shiny transfer
-        pk6->PID(pk6->PID() ^ 0x80000000);
+        pk6.PID(pk6.PID() ^ 0x80000000);
 
-    pk6->fixMoves();
+    pk6.fixMoves();
 
-    std::u16string toFix = StringUtils::UTF8toUTF16(pk6->otName());
+    std::u16string toFix = StringUtils::UTF8toUTF16(pk6.otName());
     fixString(toFix);
-    pk6->otName(StringUtils::UTF16toUTF8(toFix));
+    pk6.otName(StringUtils::UTF16toUTF8(toFix));
 
-    toFix = StringUtils::UTF8toUTF16(pk6->nickname());
+    toFix = StringUtils::UTF8toUTF16(pk6.nickname());
     fixString(toFix);
-    pk6->nickname(StringUtils::UTF16toUTF8(toFix));
-
-    pk6->refreshChecksum();
-    return std::shared_ptr<PKX>(pk6);
+    pk6.nickname(StringUtils::UTF16toUTF8(toFix));
 }
 
 std::shared_ptr<PKX> PK5::previous(void) const
 {
-    u8 dt[136];
+    std::shared_ptr<PK4> pk4 = PKXPool::make<PK4>();
+    convertTo(*pk4);
+    pk4->refreshChecksum();
+    return pk4;
+}
+
+void PK5::convertTo(PK4& pk4) const
+{
+    u8* dt = pk4.rawData();
     std::copy(data, data + 136, dt);
 
     // Clear nature field
     dt[0x41] = 0;
 
-    std::shared_ptr<PKX> pk4 = std::make_shared<PK4>(dt);
-
     // Force normal Arceus form
-    if (pk4->species() == 493)
+    if (pk4.species() == 493)
     {
-        pk4->alternativeForm(0);
+        pk4.alternativeForm(0);
     }
 
-    pk4->nickname(nickname());
-    pk4->otName(otName());
-    pk4->heldItem(0);
-    pk4->otFriendship(70);
-    pk4->ball(ball());
+    pk4.nickname(nickname());
+    pk4.otName(otName());
+    pk4.heldItem(0);
+    pk4.otFriendship(70);
+    pk4.ball(ball());
     // met location ???
     for (int i = 0; i < 4; i++)
     {
-        if (pk4->move(i) > TitleLoader::save->maxMove())
+        if (pk4.move(i) > TitleLoader::save->maxMove())
         {
-            pk4->move(i, 0);
+            pk4.move(i, 0);
         }
     }
-    pk4->fixMoves();
-
-    pk4->refreshChecksum();
-    return pk4;
+    pk4.fixMoves();
 }
 
 int PK5::partyCurrHP(void) const
@@ -30,47 +30,18 @@
 
 void PK6::shuffleArray(u8 sv)
 {
-    static const int blockLength = 56;
-    u8 index = sv * 4;
-    
-    u8 cdata[length];
-    std::copy(data, data + length, cdata);
-
-    for (u8 block = 0; block < 4; block++)
-    {
-        u8 ofs = blockPosition(index + block);
-        std::copy(
-            cdata + 8 + blockLength * ofs, 
-            cdata + 8 + blockLength * ofs + blockLength, 
-            data + 8 + blockLength * block
-        );
-    }
+    shuffleData(data, 56, sv);
 }
 
 void PK6::crypt(void)
 {
-    u32 seed = encryptionConstant();
-    for (int i = 0x08; i < 232; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
-    seed = encryptionConstant();
-    for (u32 i = 232; i < length; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
+    cryptData(data, length, encryptionConstant(), 232);
 }
 
 PK6::PK6(u8* dt, bool ekx, bool party)
 {
     length = party ? 260 : 232;
-    data = new u8[length];
+    data = (u8*)PKXPool::allocate(length);
     std::fill_n(data, length, 0);
     
     std::copy(dt, dt + length, data);
@@ -80,7 +51,7 @@ PK6::PK6(u8* dt, bool ekx, bool party)
     }
 }
 
-std::shared_ptr<PKX> PK6::clone(void) { return std::make_shared<PK6>(data, false, length == 260); }
+std::shared_ptr<PKX> PK6::clone(void) { return PKXPool::make<PK6>(data, false, length == 260); }
 
 Generation PK6::generation(void) const { return Generation::SIX; }
 
@@ -385,10 +356,7 @@ u16 PK6::PSV(void) const { return ((PID() >> 16) ^ (PID() & 0xFFFF)) >> 4; }
 
 u8 PK6::level(void) const
 {
-    u8 i = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100);
-    return i;
+    return levelFromExp(experience(), expType());
 }
 
 void PK6::level(u8 v)
@@ -399,19 +367,9 @@ void PK6::level(u8 v)
 bool PK6::shiny(void) const { return TSV() == PSV(); }
 void PK6::shiny(bool v)
 {
-    if (v)
+    if (shiny() != v)
     {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
-    {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), v, generation()));
     }
 }
 
@@ -461,7 +419,15 @@ u16 PK6::stat(const u8 stat) const
 
 std::shared_ptr<PKX> PK6::next(void) const
 {
-    u8 dt[232];
+    std::shared_ptr<PK7> pk7 = PKXPool::make<PK7>();
+    convertTo(*pk7);
+    pk7->refreshChecksum();
+    return pk7;
+}
+
+void PK6::convertTo(PK7& pk7) const
+{
+    u8* dt = pk7.rawData();
     std::copy(data, data + 232, dt);
 
     // markvalue field moved, clear old gen 6 data
@@ -477,9 +443,7 @@ std::shared_ptr<PKX> PK6::next(void) const
     dt[0x72] &= 0xFC; // low 2 bits of super training
     dt[0xDE] = 0; // gen 4 encounter type
 
-    PK7 *pk7 = new PK7(dt);
-    
-    pk7->markValue(markValue());
+    pk7.markValue(markValue());
 
     switch (abilityNumber())
     {
@@ -489,138 +453,139 @@ std::shared_ptr<PKX> PK6::next(void) const
             u8 index = abilityNumber() >> 1;
             if (abilities(index) == ability())
             {
-                pk7->ability(abilities(index));
+                pk7.ability(abilities(index));
             }
     }
 
-    pk7->htMemory(4);
-    pk7->htTextVar(0);
-    pk7->htIntensity(1);
-    pk7->htFeeling(randomNumbers() % 10);
-    pk7->geoCountry(0, TitleLoader::save->country());
-    pk7->geoRegion(0, TitleLoader::save->subRegion());
-
-    pk7->currentHandler(1);
+    pk7.htMemory(4);
+    pk7.htTextVar(0);
+    pk7.htIntensity(1);
+    pk7.htFeeling(randomNumbers() % 10);
+    pk7.geoCountry(0, TitleLoader::save->country());
+    pk7.geoRegion(0, TitleLoader::save->subRegion());
 
-    pk7->refreshChecksum();
-    return std::shared_ptr<PKX>(pk7);
+    pk7.currentHandler(1);
 }
 
 std::shared_ptr<PKX> PK6::previous(void) const
 {
-    u8 dt[232] = {0};
-    PK5 *pk5 = new PK5(dt);
-
-    pk5->species(species());
-    pk5->TID(TID());
-    pk5->SID(SID());
-    pk5->experience(experience());
-    pk5->PID(PID());
-    pk5->ability(ability());
-
-    pk5->markValue(markValue());
-    pk5->language(language());
+    std::shared_ptr<PK5> pk5 = PKXPool::make<PK5>();
+    convertTo(*pk5);
+    pk5->refreshChecksum();
+    return pk5;
+}
+
+void PK6::convertTo(PK5& pk5) const
+{
+    std::fill_n(pk5.rawData(), pk5.getLength(), 0);
+
+    pk5.species(species());
+    pk5.TID(TID());
+    pk5.SID(SID());
+    pk5.experience(experience());
+    pk5.PID(PID());
+    pk5.ability(ability());
+
+    pk5.markValue(markValue());
+    pk5.language(language());
     
     for (int i = 0; i < 6; i++)
     {
         // EV Cap
-        pk5->ev(i, ev(i) > 252 ? 252 : ev(i));
-        pk5->iv(i, iv(i));
-        pk5->contest(i, contest(i));
+        pk5.ev(i, ev(i) > 252 ? 252 : ev(i));
+        pk5.iv(i, iv(i));
+        pk5.contest(i, contest(i));
     }
 
     for (int i = 0; i < 4; i++)
     {
-        pk5->move(i, move(i));
-        pk5->PPUp(i, PPUp(i));
-        pk5->PP(i, PP(i));
+        pk5.move(i, move(i));
+        pk5.PPUp(i, PPUp(i));
+        pk5.PP(i, PP(i));
     }
 
-    pk5->egg(egg());
-    pk5->nicknamed(nicknamed());
-
-    pk5->fatefulEncounter(fatefulEncounter());
-    pk5->gender(gender());
-    pk5->alternativeForm(alternativeForm());
-    pk5->nature(nature());
-
-    pk5->version(version());
-
-    pk5->nickname(nickname().substr(0, 11));
-    pk5->otName(otName().substr(0, 7));
-
-    pk5->metYear(metYear());
-    pk5->metMonth(metMonth());
-    pk5->metDay(metDay());
-    pk5->eggYear(eggYear());
-    pk5->eggMonth(eggMonth());
-    pk5->eggDay(eggDay());
-
-    pk5->metLocation(metLocation());
-    pk5->eggLocation(eggLocation());
-
-    pk5->pkrsStrain(pkrsStrain());
-    pk5->pkrsDays(pkrsDays());
-    pk5->ball(ball());
-
-    pk5->metLevel(metLevel());
-    pk5->otGender(otGender());
-    pk5->encounterType(encounterType());
-
-    pk5->ribbon(6, 4, ribbon(0, 1)); // Hoenn Champion
-    pk5->ribbon(0, 0, ribbon(0, 2)); // Sinnoh Champ
-    pk5->ribbon(7, 0, ribbon(0, 7)); // Effort Ribbon
-
-    pk5->ribbon(0, 7, ribbon(1, 0)); // Alert
-    pk5->ribbon(1, 0, ribbon(1, 1)); // Shock
-    pk5->ribbon(1, 1, ribbon(1, 2)); // Downcast
-    pk5->ribbon(1, 2, ribbon(1, 3)); // Careless
-    pk5->ribbon(1, 3, ribbon(1, 4)); // Relax
-    pk5->ribbon(1, 4, ribbon(1, 5)); // Snooze
-    pk5->ribbon(1, 5, ribbon(1, 6)); // Smile
-    pk5->ribbon(1, 6, ribbon(1, 7)); // Gorgeous
-
-    pk5->ribbon(1, 7, ribbon(2, 0)); // Royal
-    pk5->ribbon(2, 0, ribbon(2, 1)); // Gorgeous Royal
-    pk5->ribbon(6, 7, ribbon(2, 2)); // Artist
-    pk5->ribbon(2, 1, ribbon(2, 3)); // Footprint
-    pk5->ribbon(2, 2, ribbon(2, 4)); // Record
-    pk5->ribbon(2, 4, ribbon(2, 5)); // Legend
-    pk5->ribbon(7, 4, ribbon(2, 6)); // Country
-    pk5->ribbon(7, 5, ribbon(2, 7)); // National
-
-    pk5->ribbon(7, 6, ribbon(3, 0)); // Earth
-    pk5->ribbon(7, 7, ribbon(3, 1)); // World
-    pk5->ribbon(3, 2, ribbon(3, 2)); // Classic
-    pk5->ribbon(3, 3, ribbon(3, 3)); // Premier
-    pk5->ribbon(2, 3, ribbon(3, 4)); // Event
-    pk5->ribbon(2, 6, ribbon(3, 5)); // Birthday
-    pk5->ribbon(2, 7, ribbon(3, 6)); // Special
-    pk5->ribbon(3, 0, ribbon(3, 7)); // Souvenir
-
-    pk5->ribbon(3, 1, ribbon(4, 0)); // Wishing Ribbon
-    pk5->ribbon(7, 1, ribbon(4, 1)); // Battle Champion
-    pk5->ribbon(7, 2, ribbon(4, 2)); // Regional Champion
-    pk5->ribbon(7, 3, ribbon(4, 3)); // National Champion
-    pk5->ribbon(2, 5, ribbon(4, 4)); // World Champion
-
-    pk5->otFriendship(pk5->baseFriendship());
+    pk5.egg(egg());
+    pk5.nicknamed(nicknamed());
+
+    pk5.fatefulEncounter(fatefulEncounter());
+    pk5.gender(gender());
+    pk5.alternativeForm(alternativeForm());
+    pk5.nature(nature());
+
+    pk5.version(version());
+
+    pk5.nickname(nickname().substr(0, 11));
+    pk5.otName(otName().substr(0, 7));
+
+    pk5.metYear(metYear());
+    pk5.metMonth(metMonth());
+    pk5.metDay(metDay());
+    pk5.eggYear(eggYear());
+    pk5.eggMonth(eggMonth());
+    pk5.eggDay(eggDay());
+
+    pk5.metLocation(metLocation());
+    pk5.eggLocation(eggLocation());
+
+    pk5.pkrsStrain(pkrsStrain());
+    pk5.pkrsDays(pkrsDays());
+    pk5.ball(ball());
+
+    pk5.metLevel(metLevel());
+    pk5.otGender(otGender());
+    pk5.encounterType(encounterType());
+
+    pk5.ribbon(6, 4, ribbon(0, 1)); // Hoenn Champion
+    pk5.ribbon(0, 0, ribbon(0, 2)); // Sinnoh Champ
+    pk5.ribbon(7, 0, ribbon(0, 7)); // Effort Ribbon
+
+    pk5.ribbon(0, 7, ribbon(1, 0)); // Alert
+    pk5.ribbon(1, 0, ribbon(1, 1)); // Shock
+    pk5.ribbon(1, 1, ribbon(1, 2)); // Downcast
+    pk5.ribbon(1, 2, ribbon(1, 3)); // Careless
+    pk5.ribbon(1, 3, ribbon(1, 4)); // Relax
+    pk5.ribbon(1, 4, ribbon(1, 5)); // Snooze
+    pk5.ribbon(1, 5, ribbon(1, 6)); // Smile
+    pk5.ribbon(1, 6, ribbon(1, 7)); // Gorgeous
+
+    pk5.ribbon(1, 7, ribbon(2, 0)); // Royal
+    pk5.ribbon(2, 0, ribbon(2, 1)); // Gorgeous Royal
+    pk5.ribbon(6, 7, ribbon(2, 2)); // Artist
+    pk5.ribbon(2, 1, ribbon(2, 3)); // Footprint
+    pk5.ribbon(2, 2, ribbon(2, 4)); // Record
+    pk5.ribbon(2, 4, ribbon(2, 5)); // Legend
+    pk5.ribbon(7, 4, ribbon(2, 6)); // Country
+    pk5.ribbon(7, 5, ribbon(2, 7)); // National
+
+    pk5.ribbon(7, 6, ribbon(3, 0)); // Earth
+    pk5.ribbon(7, 7, ribbon(3, 1)); // World
+    pk5.ribbon(3, 2, ribbon(3, 2)); // Classic
+    pk5.ribbon(3, 3, ribbon(3, 3)); // Premier
+    pk5.ribbon(2, 3, ribbon(3, 4)); // Event
+    pk5.ribbon(2, 6, ribbon(3, 5)); // Birthday
+    pk5.ribbon(2, 7, ribbon(3, 6)); // Special
+    pk5.ribbon(3, 0, ribbon(3, 7)); // Souvenir
+
+    pk5.ribbon(3, 1, ribbon(4, 0)); // Wishing Ribbon
+    pk5.ribbon(7, 1, ribbon(4, 1)); // Battle Champion
+    pk5.ribbon(7, 2, ribbon(4, 2)); // Regional Champion
+    pk5.ribbon(7, 3, ribbon(4, 3)); // National Champion
+    pk5.ribbon(2, 5, ribbon(4, 4)); // World Champion
+
+    pk5.otFriendship(pk5.baseFriendship());
 
     // Check if shiny pid needs to be modified
     u16 val = TID() ^ SID() ^ (PID() >> 16) ^ (PID() & 0xFFFF);
     if (shiny() && (val > 7) && (val < 16))
-        pk5->PID(PID() ^ 0x80000000);
+        pk5.PID(PID() ^ 0x80000000);
 
     for (int i = 0; i < 4; i++)
     {
-        if (pk5->move(i) > TitleLoader::save->maxMove())
+        if (pk5.move(i) > TitleLoader::save->maxMove())
         {
-            pk5->move(i, 0);
+            pk5.move(i, 0);
         }
     }
-
-    pk5->refreshChecksum();
-    return std::shared_ptr<PKX>(pk5);
 }
 
 int PK6::partyCurrHP(void) const
@@ -30,47 +30,18 @@
 
 void PK7::shuffleArray(u8 sv)
 {
-    static const int blockLength = 56;
-    u8 index = sv * 4;
-    
-    u8 cdata[length];
-    std::copy(data, data + length, cdata);
-
-    for (u8 block = 0; block < 4; block++)
-    {
-        u8 ofs = blockPosition(index + block);
-        std::copy(
-            cdata + 8 + blockLength * ofs, 
-            cdata + 8 + blockLength * ofs + blockLength, 
-            data + 8 + blockLength * block
-        );
-    }
+    shuffleData(data, 56, sv);
 }
 
 void PK7::crypt(void)
 {
-    u32 seed = encryptionConstant();
-    for (int i = 0x08; i < 232; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
-    seed = encryptionConstant();
-    for (u32 i = 232; i < length; i += 2)
-    {
-        u16 temp = *(u16*)(data + i);
-        seed = seedStep(seed);
-        temp ^= (seed >> 16);
-        *(u16*)(data + i) = temp;
-    }
+    cryptData(data, length, encryptionConstant(), 232);
 }
 
 PK7::PK7(u8* dt, bool ekx, bool party)
 {
     length = party ? 260 : 232;
-    data = new u8[length];
+    data = (u8*)PKXPool::allocate(length);
     std::fill_n(data, length, 0);
     
     std::copy(dt, dt + length, data);
@@ -80,7 +51,7 @@ PK7::PK7(u8* dt, bool ekx, bool party)
     }
 }
 
-std::shared_ptr<PKX> PK7::clone(void) { return std::make_shared<PK7>(data, false, length == 260); }
+std::shared_ptr<PKX> PK7::clone(void) { return PKXPool::make<PK7>(data, false, length == 260); }
 
 Generation PK7::generation(void) const { return Generation::SEVEN; }
 
@@ -361,10 +332,7 @@ u16 PK7::PSV(void) const { return ((PID() >> 16) ^ (PID() & 0xFFFF)) >> 4; }
 
 u8 PK7::level(void) const
 {
-    u8 i = 1;
-    u8 xpType = expType();
-    while (experience() >= expTable(i, xpType) && ++i < 100);
-    return i;
+    return levelFromExp(experience(), expType());
 }
 
 void PK7::level(u8 v)
@@ -375,19 +343,9 @@ void PK7::level(u8 v)
 bool PK7::shiny(void) const { return TSV() == PSV(); }
 void PK7::shiny(bool v)
 {
-    if (v)
-    {
-        while (!shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
-    }
-    else
+    if (shiny() != v)
     {
-        while (shiny())
-        {
-            PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), PID(), generation()));
-        }
+        PID(PKX::getRandomPID(species(), gender(), version(), nature(), alternativeForm(), abilityNumber(), TID(), SID(), v, generation()));
     }
 }
 
@@ -437,15 +395,21 @@ u16 PK7::stat(const u8 stat) const
 
 std::shared_ptr<PKX> PK7::previous(void) const
 {
-    u8 dt[232];
+    std::shared_ptr<PK6> pk6 = PKXPool::make<PK6>();
+    convertTo(*pk6);
+    pk6->refreshChecksum();
+    return pk6;
+}
+
+void PK7::convertTo(PK6& pk6) const
+{
+    u8* dt = pk6.rawData();
     std::copy(data, data + 232, dt);
 
     // markvalue field moved, clear old gen 7 data
     *(u16*)(dt + 0x16) = 0;
 
-    PK6 *pk6 = new PK6(dt);
-    
-    pk6->markValue(markValue());
+    pk6.markValue(markValue());
 
     switch (abilityNumber())
     {
@@ -455,32 +419,29 @@ std::shared_ptr<PKX> PK7::previous(void) const
             u8 index = abilityNumber() >> 1;
             if (abilities(index) == ability())
             {
-                pk6->ability(pk6->abilities(index));
+                pk6.ability(pk6.abilities(index));
             }
     }
 
-    pk6->htMemory(4);
-    pk6->htTextVar(0);
-    pk6->htIntensity(1);
-    pk6->htFeeling(randomNumbers() % 10);
-    pk6->geoCountry(0, TitleLoader::save->country());
-    pk6->geoRegion(0, TitleLoader::save->subRegion());
+    pk6.htMemory(4);
+    pk6.htTextVar(0);
+    pk6.htIntensity(1);
+    pk6.htFeeling(randomNumbers() % 10);
+    pk6.geoCountry(0, TitleLoader::save->country());
+    pk6.geoRegion(0, TitleLoader::save->subRegion());
 
     for (int i = 0; i < 4; i++)
     {
-        if (pk6->move(i) > TitleLoader::save->maxMove())
+        if (pk6.move(i) > TitleLoader::save->maxMove())
         {
-            pk6->move(i, 0);
+            pk6.move(i, 0);
         }
-        if (pk6->relearnMove(i) > TitleLoader::save->maxMove())
+        if (pk6.relearnMove(i) > TitleLoader::save->maxMove())
         {
-            pk6->relearnMove(i, 0);
+            pk6.relearnMove(i, 0);
         }
     }
-    pk6->fixMoves();
-
-    pk6->refreshChecksum();
-    return std::shared_ptr<PKX>(pk6);
+    pk6.fixMoves();
 }
 
 int PK7::partyCurrHP(void) const
@@ -26,10 +26,14 @@
 
 #include "PKX.hpp"
 #include "PK6.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-u32 PKX::expTable(u8 row, u8 col) const
+namespace
 {
-    static constexpr u32 table[100][6] = {
+    // Experience needed for level row + 1, one column per growth rate
+    constexpr u32 expRows[100][6] = {
         {0, 0, 0, 0, 0, 0},
         {8, 15, 4, 9, 6, 10},
         {27, 52, 13, 57, 21, 33},
@@ -132,12 +136,50 @@ u32 PKX::expTable(u8 row, u8 col) const
         {1000000, 600000, 1640000, 1059860, 800000, 1250000}
     };
 
-    return table[row][col]; 
+    // The same table transposed so each growth rate is contiguous, padded to a power of
+    // two with unreachable values so level lookups can binary search without bounds checks
+    struct ExpByGrowth
+    {
+        u32 exp[6][128];
+    };
+
+    constexpr ExpByGrowth makeExpByGrowth()
+    {
+        ExpByGrowth table{};
+        for (int growth = 0; growth < 6; growth++)
+        {
+            for (int row = 0; row < 128; row++)
+            {
+                table.exp[growth][row] = row < 100 ? expRows[row][growth] : 0xFFFFFFFF;
+            }
+        }
+        return table;
+    }
+
+    constexpr ExpByGrowth expByGrowth = makeExpByGrowth();
+}
+
+u32 PKX::expTable(u8 row, u8 expType)
+{
+    return expRows[row][expType];
+}
+
+u8 PKX::levelFromExp(u32 exp, u8 expType)
+{
+    // Counts the rows at or below exp; row 0 is always counted, so the count is the level
+    const u32* table = expByGrowth.exp[expType];
+    u32 pos = 0;
+    for (u32 step = 64; step > 0; step >>= 1)
+    {
+        pos += table[pos + step - 1] <= exp ? step : 0;
+    }
+    return std::min(pos, (u32)100);
 }
 
-u8 PKX::blockPosition(u8 index) const
+namespace
 {
-    static constexpr u8 blocks[128] =
+    // Source block for each position of the 24 block orders
+    constexpr u8 blockOrders[128] =
     {
         0, 1, 2, 3,
         0, 1, 3, 2,
@@ -174,11 +216,14 @@ u8 PKX::blockPosition(u8 index) const
         1, 0, 2, 3,
         1, 0, 3, 2,
     };
+}
 
-    return blocks[index];
+u8 PKX::blockPosition(u8 index)
+{
+    return blockOrders[index];
 }
 
-u8 PKX::blockPositionInvert(u8 index) const
+u8 PKX::blockPositionInvert(u8 index)
 {
     static constexpr u8 blocks[32] =
     {
@@ -233,6 +278,134 @@ void PKX::encrypt(void)
     crypt();
 }
 
+namespace
+{
+    // Jump-ahead table for the crypt LCG: the k-th keystream word from a seed
+    // is the top half of lcgMult[k] * seed + lcgAdd[k], so words are independent
+    struct LCGJump
+    {
+        u32 mult[128];
+        u32 add[128];
+    };
+
+    constexpr LCGJump makeLCGJump()
+    {
+        LCGJump jump{};
+        u32 mult = 1, add = 0;
+        for (int i = 0; i < 128; i++)
+        {
+            mult *= 0x41C64E6D;
+            add = add * 0x41C64E6D + 0x6073;
+            jump.mult[i] = mult;
+            jump.add[i] = add;
+        }
+        return jump;
+    }
+
+    constexpr LCGJump lcgJump = makeLCGJump();
+
+#ifdef __SSE2__
+    // SSE2 has no 32-bit multiply-low, so build it from two widening multiplies
+    inline __m128i mullo32(__m128i a, __m128i b)
+    {
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+#endif
+
+    void xorKeystream(u8* dt, u32 words, u32 seed)
+    {
+        u32 i = 0;
+#ifdef __SSE2__
+        const __m128i vseed = _mm_set1_epi32(seed);
+        for (; i + 8 <= words; i += 8)
+        {
+            __m128i lo = _mm_add_epi32(mullo32(_mm_loadu_si128((const __m128i*)(lcgJump.mult + i)), vseed), _mm_loadu_si128((const __m128i*)(lcgJump.add + i)));
+            __m128i hi = _mm_add_epi32(mullo32(_mm_loadu_si128((const __m128i*)(lcgJump.mult + i + 4)), vseed), _mm_loadu_si128((const __m128i*)(lcgJump.add + i + 4)));
+            // the arithmetic shift keeps every lane in range, so the saturating pack is exact
+            __m128i key = _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+            __m128i* word = (__m128i*)(dt + i * 2);
+            _mm_storeu_si128(word, _mm_xor_si128(_mm_loadu_si128(word), key));
+        }
+#endif
+        for (; i < words; i++)
+        {
+            *(u16*)(dt + i * 2) ^= (lcgJump.mult[i] * seed + lcgJump.add[i]) >> 16;
+        }
+    }
+}
+
+void PKX::cryptData(u8* dt, u32 length, u32 seed, u32 partyStart)
+{
+    u32 end = std::min(length, partyStart);
+    xorKeystream(dt + 8, (end - 8) / 2, seed);
+    if (length > partyStart)
+    {
+        xorKeystream(dt + partyStart, (length - partyStart) / 2, *(u32*)dt);
+    }
+}
+
+namespace
+{
+    // Only the four data blocks are set aside, in a fixed buffer sized at compile time,
+    // and each one is written straight to its position in the order table
+    template <u32 blockLength>
+    void shuffleBlocks(u8* blocks, const u8* order)
+    {
+        u8 cdata[4 * blockLength];
+        std::copy(blocks, blocks + 4 * blockLength, cdata);
+        for (u8 block = 0; block < 4; block++)
+        {
+            std::copy(cdata + blockLength * order[block], cdata + blockLength * (order[block] + 1), blocks + blockLength * block);
+        }
+    }
+}
+
+void PKX::shuffleData(u8* dt, u32 blockLength, u8 sv)
+{
+    if (blockLength == 32)
+    {
+        shuffleBlocks<32>(dt + 8, blockOrders + sv * 4);
+    }
+    else
+    {
+        shuffleBlocks<56>(dt + 8, blockOrders + sv * 4);
+    }
+}
+
+void PKX::unshuffleData(u8* dt, u32 blockLength, u8 sv)
+{
+    shuffleData(dt, blockLength, blockPositionInvert(sv));
+}
+
+// Gen 4 and 5 use 32 byte blocks and seed the stored section with the checksum,
+// later generations use 56 byte blocks and the encryption constant
+void PKX::decrypt(u8* dt, u32 length, Generation gen)
+{
+    const bool ds = gen == Generation::FOUR || gen == Generation::FIVE;
+    u8 sv = (*(u32*)dt >> 13) & 31;
+    cryptData(dt, length, ds ? *(u16*)(dt + 6) : *(u32*)dt, ds ? 136 : 232);
+    shuffleData(dt, ds ? 32 : 56, sv);
+}
+
+void PKX::encrypt(u8* dt, u32 length, Generation gen)
+{
+    const bool ds = gen == Generation::FOUR || gen == Generation::FIVE;
+    const u32 storedLength = ds ? 136 : 232;
+    u8 sv = (*(u32*)dt >> 13) & 31;
+
+    u16 chk = 0;
+    for (u32 i = 8; i < storedLength; i += 2)
+    {
+        chk += *(u16*)(dt + i);
+    }
+    *(u16*)(dt + 6) = chk;
+
+    unshuffleData(dt, ds ? 32 : 56, sv);
+    cryptData(dt, length, ds ? chk : *(u32*)dt, storedLength);
+}
+
 bool PKX::gen7(void) const { return version() >= 30 && version() <= 33;}
 
 bool PKX::gen6(void) const { return version() >= 24 && version() <= 29; }
@@ -373,68 +546,179 @@ static inline u8 getUnownForm(u32 pid)
     return val % 28;
 }
 
-u32 PKX::getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u32 oldPid, Generation gen)
+namespace
 {
-    if (originGame >= 24) // Origin game over gen 5
+    // What getRandomPID asks of a PID, besides shininess
+    struct PIDRules
     {
-        return randomNumbers();
+        int nature;      // -1 when the origin game does not tie nature to the PID
+        int form;        // Unown form of a gen 3 origin, otherwise -1
+        u8 genderType;
+        u8 gender;       // 2 when any will do
+        u8 genderLow;    // low bytes from genderLow up to genderLow + genderCount give the gender
+        u16 genderCount;
+        int abilityBit;  // PID bit choosing the ability, -1 when free
+        u32 abilitySet;
+    };
+
+    PIDRules pidRules(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, Generation gen)
+    {
+        PIDRules rules;
+        switch (gen)
+        {
+            case Generation::FOUR:
+                rules.genderType = PersonalDPPtHGSS::gender(species);
+                break;
+            case Generation::FIVE:
+                rules.genderType = PersonalBWB2W2::gender(species);
+                break;
+            case Generation::SIX:
+                rules.genderType = PersonalXYORAS::gender(species);
+                break;
+            case Generation::SEVEN:
+            default:
+                rules.genderType = PersonalSMUSUM::gender(species);
+                break;
+        }
+
+        bool g3unown = originGame <= 5 && species == 201;
+        rules.nature = originGame <= 15 ? nature : -1;
+        rules.form = g3unown ? form : -1;
+        rules.abilityBit = !g3unown && (abilityNum == 1 || abilityNum == 2) ? (gen == Generation::FIVE ? 16 : 0) : -1;
+        rules.abilitySet = abilityNum == 2;
+
+        const u8 gt = rules.genderType;
+        rules.gender = gt == 255 || gt == 254 || gt == 0 || gender > 1 ? 2 : gender;
+        if (rules.gender == 2)
+        {
+            rules.genderLow = 0;
+            rules.genderCount = 256;
+        }
+        else if (rules.gender == 1)
+        {
+            rules.genderLow = 0;
+            rules.genderCount = gt;
+        }
+        else
+        {
+            rules.genderLow = gt;
+            rules.genderCount = 256 - gt;
+        }
+        return rules;
     }
 
-    u8 (*genderTypeFinder)(u16 species);
-    switch (gen)
+    bool pidMatches(u32 pid, const PIDRules& rules)
     {
-        case Generation::FOUR:
-            genderTypeFinder = PersonalDPPtHGSS::gender;
-            break;
-        case Generation::FIVE:
-            genderTypeFinder = PersonalBWB2W2::gender;
-            break;
-        case Generation::SIX:
-            genderTypeFinder = PersonalXYORAS::gender;
-            break;
-        case Generation::SEVEN:
-        default:
-            genderTypeFinder = PersonalSMUSUM::gender;
-            break;
+        return (rules.nature < 0 || pid % 25 == (u32)rules.nature) &&
+               (rules.form < 0 || getUnownForm(pid) == rules.form) &&
+               (rules.abilityBit < 0 || ((pid >> rules.abilityBit) & 1) == rules.abilitySet) &&
+               (rules.gender == 2 || genderFromRatio(pid, rules.genderType) == rules.gender);
     }
 
-    u8 genderType = genderTypeFinder(species);
-    bool g3unown = originGame <= 5 && species == 201;
-    while (true)
+    // A low half with the gender and, outside gen 5, the ability bit
+    u16 lowPID(const PIDRules& rules)
     {
-        u32 possiblePID = randomNumbers();
-        if (originGame <= 15 && possiblePID % 25 != nature)
+        u16 low = (randomNumbers() & 0xFF00) | (rules.genderLow + randomNumbers() % rules.genderCount);
+        if (rules.abilityBit == 0 && (low & 1) != rules.abilitySet)
         {
-            continue;
+            // Step back into the gender's bytes two at a time, which keeps the bit
+            int byte = (low & 0xFF) ^ 1;
+            if (byte < rules.genderLow)
+            {
+                byte += 2;
+            }
+            else if (byte >= rules.genderLow + rules.genderCount)
+            {
+                byte -= 2;
+            }
+            low = (low & 0xFF00) | (byte & 0xFF);
         }
+        return low;
+    }
 
-        if (g3unown)
+    // A high half that gives the nature together with low, and the gen 5 ability bit
+    u16 highPID(const PIDRules& rules, u16 low)
+    {
+        u32 high = randomNumbers() & 0xFFFF;
+        if (rules.nature >= 0)
         {
-            if (getUnownForm(possiblePID) != form)
-            {
-                continue;
-            }
+            // PID % 25 is (11 * high + low) % 25, and 16 undoes the 11
+            u32 base = (rules.nature + 25 - low % 25) * 16 % 25;
+            high = base + 25 * (randomNumbers() % ((0xFFFF - base) / 25 + 1));
         }
-        else if (abilityNum != 4)
+        if (rules.abilityBit == 16 && (high & 1) != rules.abilitySet)
         {
-            if (abilityNum == 1 && (possiblePID & (1 << (gen == Generation::FIVE ? 16 : 0))))
+            if (rules.nature < 0)
             {
-                continue;
+                high ^= 1;
             }
-            else if (abilityNum == 2 && !(possiblePID & (1 << (gen == Generation::FIVE ? 16 : 0))))
+            else
             {
-                continue;
+                // The next high half with the same nature has the other parity
+                high = high + 25 <= 0xFFFF ? high + 25 : high - 25;
             }
         }
+        return high;
+    }
 
-        if (genderType == 255 || genderType == 254 || genderType == 0 || gender == 2)
+    // Only a gen 3 Unown's form is left to chance, so this rarely goes round more than once
+    u32 randomPID(const PIDRules& rules)
+    {
+        while (true)
         {
-            return possiblePID;
+            u16 low = lowPID(rules);
+            u32 pid = (u32)highPID(rules, low) << 16 | low;
+            if (pidMatches(pid, rules))
+            {
+                return pid;
+            }
         }
+    }
+}
 
-        if (gender == genderFromRatio(possiblePID, genderType))
+u32 PKX::getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u32 oldPid, Generation gen)
+{
+    if (originGame >= 24) // Origin game over gen 5
+    {
+        return randomNumbers();
+    }
+    return randomPID(pidRules(species, gender, originGame, nature, form, abilityNum, gen));
+}
+
+u32 PKX::getRandomPID(u16 species, u8 gender, u8 originGame, u8 nature, u8 form, u8 abilityNum, u16 tid, u16 sid, bool shiny, Generation gen)
+{
+    const u32 shinyRange = gen == Generation::FOUR || gen == Generation::FIVE ? 8 : 16;
+    const u16 tsv = tid ^ sid;
+    if (!shiny)
+    {
+        // All but one PID in thousands will do
+        u32 pid;
+        do
+        {
+            pid = getRandomPID(species, gender, originGame, nature, form, abilityNum, 0, gen);
+        }
+        while (((pid >> 16) ^ (pid & 0xFFFF) ^ tsv) < shinyRange);
+        return pid;
+    }
+
+    // A shiny high half is low ^ tsv with some of its bits below shinyRange flipped
+    if (originGame >= 24)
+    {
+        u16 low = randomNumbers();
+        return (u32)(low ^ tsv ^ (randomNumbers() % shinyRange)) << 16 | low;
+    }
+    PIDRules rules = pidRules(species, gender, originGame, nature, form, abilityNum, gen);
+    while (true)
+    {
+        u16 low = lowPID(rules);
+        u32 start = randomNumbers() % shinyRange;
+        for (u32 i = 0; i < shinyRange; i++)
         {
-            return possiblePID;
+            u32 pid = (u32)(low ^ tsv ^ ((start + i) % shinyRange)) << 16 | low;
+            if (pidMatches(pid, rules))
+            {
+                return pid;
+            }
         }
     }
 }
@@ -0,0 +1,182 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+#include "PKXConverter.hpp"
+#include "PB7.hpp"
+#include "PK4.hpp"
+#include "PK5.hpp"
+#include "PK6.hpp"
+#include "PK7.hpp"
+
+bool PKXConverter::supported(Generation from, Generation to)
+{
+    if ((u32)from > (u32)Generation::LGPE || (u32)to > (u32)Generation::LGPE)
+    {
+        return false;
+    }
+    return from == to || (from != Generation::LGPE && to != Generation::LGPE);
+}
+
+u32 PKXConverter::boxLength(Generation gen)
+{
+    switch (gen)
+    {
+        case Generation::FOUR:
+        case Generation::FIVE:
+            return 136;
+        case Generation::SIX:
+        case Generation::SEVEN:
+            return 232;
+        case Generation::LGPE:
+            return 260;
+        case Generation::UNUSED:
+        default:
+            return 0;
+    }
+}
+
+std::shared_ptr<PKX> PKXConverter::make(Generation gen)
+{
+    switch (gen)
+    {
+        case Generation::FOUR:
+            return PKXPool::make<PK4>();
+        case Generation::FIVE:
+            return PKXPool::make<PK5>();
+        case Generation::SIX:
+            return PKXPool::make<PK6>();
+        case Generation::SEVEN:
+            return PKXPool::make<PK7>();
+        case Generation::LGPE:
+        default:
+            return PKXPool::make<PB7>();
+    }
+}
+
+PKX& PKXConverter::stage(Generation gen)
+{
+    std::shared_ptr<PKX>& pk = stages[(u32)gen];
+    if (!pk)
+    {
+        pk = make(gen);
+    }
+    return *pk;
+}
+
+void PKXConverter::run(const PKX& pk, Generation target, PKX& out)
+{
+    const PKX* from = &pk;
+    while (from->generation() != target)
+    {
+        const Generation gen = from->generation();
+        const Generation next = (Generation)(gen < target ? (u32)gen + 1 : (u32)gen - 1);
+        PKX& to = next == target ? out : stage(next);
+        switch (gen)
+        {
+            case Generation::FOUR:
+                ((const PK4*)from)->convertTo((PK5&)to);
+                break;
+            case Generation::FIVE:
+                if (next == Generation::SIX)
+                {
+                    ((const PK5*)from)->convertTo((PK6&)to);
+                }
+                else
+                {
+                    ((const PK5*)from)->convertTo((PK4&)to);
+                }
+                break;
+            case Generation::SIX:
+                if (next == Generation::SEVEN)
+                {
+                    ((const PK6*)from)->convertTo((PK7&)to);
+                }
+                else
+                {
+                    ((const PK6*)from)->convertTo((PK5&)to);
+                }
+                break;
+            case Generation::SEVEN:
+                ((const PK7*)from)->convertTo((PK6&)to);
+                break;
+            default:
+                return;
+        }
+        from = &to;
+    }
+    out.refreshChecksum();
+}
+
+bool PKXConverter::convert(const PKX& pk, Generation target, u8* out)
+{
+    if (!supported(pk.generation(), target))
+    {
+        return false;
+    }
+    if (pk.generation() == target)
+    {
+        std::copy(pk.rawData(), pk.rawData() + boxLength(target), out);
+        return true;
+    }
+
+    PKX& result = stage(target);
+    run(pk, target, result);
+    std::copy(result.rawData(), result.rawData() + boxLength(target), out);
+    return true;
+}
+
+bool PKXConverter::convert(Generation from, const u8* src, Generation target, u8* out)
+{
+    if (!supported(from, target))
+    {
+        return false;
+    }
+    if (from == target)
+    {
+        std::copy(src, src + boxLength(target), out);
+        return true;
+    }
+
+    PKX& pk = stage(from);
+    std::copy(src, src + boxLength(from), pk.rawData());
+    return convert(pk, target, out);
+}
+
+std::shared_ptr<PKX> PKXConverter::convert(const PKX& pk, Generation target)
+{
+    if (!supported(pk.generation(), target))
+    {
+        return nullptr;
+    }
+    if (pk.generation() == target)
+    {
+        return const_cast<PKX&>(pk).clone();
+    }
+
+    std::shared_ptr<PKX> result = make(target);
+    PKXConverter converter;
+    converter.run(pk, target, *result);
+    return result;
+}
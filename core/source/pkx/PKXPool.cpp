@@ -0,0 +1,182 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include "PKXPool.hpp"
+#include "platform.h"
+#ifndef _3DS
+ #include <mutex>
+#endif
+
+namespace
+{
+    // Blocks are rounded up to this, which also keeps them aligned for any PKX member
+    constexpr size_t ALIGN = 8;
+    constexpr size_t SLAB_BYTES = 4096;
+    constexpr size_t MAX_POOLS = 16;
+
+    struct Pool
+    {
+        PKXPool::Stats stats;
+        void* free;
+    };
+
+    Pool pools[MAX_POOLS];
+    size_t poolCount = 0;
+#ifdef _3DS
+    // Set up by a static initialiser, so before main and before any thread can allocate
+    struct Mutex
+    {
+        Mutex() { LightLock_Init(&lock); }
+        LightLock lock;
+    } mutex;
+
+    void lock(void)
+    {
+        LightLock_Lock(&mutex.lock);
+    }
+
+    void unlock(void)
+    {
+        LightLock_Unlock(&mutex.lock);
+    }
+#else
+    std::mutex mutex;
+
+    void lock(void)
+    {
+        mutex.lock();
+    }
+
+    void unlock(void)
+    {
+        mutex.unlock();
+    }
+#endif
+
+    // Called with the lock held. nullptr once every pool is taken
+    Pool* pool(size_t size)
+    {
+        for (size_t i = 0; i < poolCount; i++)
+        {
+            if (pools[i].stats.size == size)
+            {
+                return &pools[i];
+            }
+        }
+        if (poolCount == MAX_POOLS)
+        {
+            return nullptr;
+        }
+        pools[poolCount] = {{(u32)size, 0, 0, 0, 0}, nullptr};
+        return &pools[poolCount++];
+    }
+
+    void refill(Pool& pool)
+    {
+        size_t size = pool.stats.size;
+        size_t count = std::max((size_t)1, SLAB_BYTES / size);
+        u8* slab = (u8*)::operator new(count * size);
+        for (size_t i = 0; i < count; i++)
+        {
+            *(void**)(slab + i * size) = pool.free;
+            pool.free = slab + i * size;
+        }
+        pool.stats.slabs++;
+    }
+}
+
+void* PKXPool::allocate(size_t size)
+{
+    size = (size + ALIGN - 1) / ALIGN * ALIGN;
+    if (size > MAX_BLOCK)
+    {
+        return ::operator new(size);
+    }
+    lock();
+    Pool* p = pool(size);
+    if (!p)
+    {
+        unlock();
+        return ::operator new(size);
+    }
+    if (!p->free)
+    {
+        refill(*p);
+    }
+    void* block = p->free;
+    p->free = *(void**)block;
+    p->stats.allocations++;
+    p->stats.peak = std::max(p->stats.peak, ++p->stats.live);
+    unlock();
+    return block;
+}
+
+void PKXPool::release(void* block, size_t size)
+{
+    if (!block)
+    {
+        return;
+    }
+    size = (size + ALIGN - 1) / ALIGN * ALIGN;
+    if (size > MAX_BLOCK)
+    {
+        ::operator delete(block);
+        return;
+    }
+    lock();
+    Pool* p = nullptr;
+    for (size_t i = 0; i < poolCount; i++)
+    {
+        if (pools[i].stats.size == size)
+        {
+            p = &pools[i];
+        }
+    }
+    if (!p)
+    {
+        // Allocated on the heap when every pool was taken
+        unlock();
+        ::operator delete(block);
+        return;
+    }
+    *(void**)block = p->free;
+    p->free = block;
+    p->stats.live--;
+    unlock();
+}
+
+std::vector<PKXPool::Stats> PKXPool::stats(void)
+{
+    lock();
+    std::vector<Stats> ret;
+    for (size_t i = 0; i < poolCount; i++)
+    {
+        ret.push_back(pools[i].stats);
+    }
+    unlock();
+    return ret;
+}
@@ -25,6 +25,8 @@
 */
 
 #include "Sav.hpp"
+#include "crc.hpp"
+#include "PKXConverter.hpp"
 #include "SavB2W2.hpp"
 #include "SavBW.hpp"
 #include "SavDP.hpp"
@@ -38,21 +40,49 @@
 
 Sav::~Sav() { delete[] data; }
 
-u16 Sav::ccitt16(const u8* buf, u32 len)
+TransferError Sav::transferError(const PKX& pk) const
 {
-    u16 crc = 0xFFFF;
-    for (u32 i = 0; i < len; i++)
+    for (int i = 0; i < 4; i++)
     {
-        crc ^= (u16)(buf[i] << 8);
-        for (u32 j = 0; j < 0x8; j++)
+        if (pk.move(i) > maxMove())
+        {
+            return TransferError::MOVE;
+        }
+        if (pk.generation() == Generation::SIX && ((const PK6&)pk).relearnMove(i) > maxMove())
         {
-            if ((crc & 0x8000) > 0)
-                crc = (u16)((crc << 1) ^ 0x1021);
-            else
-                crc <<= 1;
+            return TransferError::MOVE;
         }
+        else if (pk.generation() == Generation::SEVEN && ((const PK7&)pk).relearnMove(i) > maxMove())
+        {
+            return TransferError::MOVE;
+        }
+    }
+    if (pk.species() > maxSpecies())
+    {
+        return TransferError::SPECIES;
+    }
+    else if (pk.alternativeForm() > formCount(pk.species()) && !((pk.species() == 664 || pk.species() == 665) && pk.alternativeForm() <= formCount(666)))
+    {
+        return TransferError::FORM;
+    }
+    else if (pk.ability() > maxAbility())
+    {
+        return TransferError::ABILITY;
     }
-    return crc;
+    else if (pk.heldItem() > maxItem())
+    {
+        return TransferError::ITEM;
+    }
+    else if (pk.ball() > maxBall())
+    {
+        return TransferError::BALL;
+    }
+    return TransferError::NONE;
+}
+
+u16 Sav::ccitt16(const u8* buf, u32 len)
+{
+    return CRC::ccitt16(buf, len);
 }
 
 std::unique_ptr<Sav> Sav::getSave(u8* dt, size_t length)
@@ -160,17 +190,38 @@ bool Sav::validSequence(u8* dt, u8* pattern, int shift)
 
 void Sav::transfer(std::shared_ptr<PKX> &pk)
 {
-    while (pk->generation() != generation())
+    if (pk->generation() != generation())
+    {
+        std::shared_ptr<PKX> converted = PKXConverter::convert(*pk, generation());
+        if (converted)
+        {
+            pk = converted;
+        }
+    }
+}
+
+void Sav::cryptBoxData(bool crypted)
+{
+    const Generation gen = generation();
+    const u32 length = gen == Generation::LGPE ? 260 : (gen == Generation::FOUR || gen == Generation::FIVE ? 136 : 232);
+    for (int i = 0; i < maxSlot(); i++)
     {
-        if (pk->generation() > generation())
+        u8* pk = data + boxOffset(i / 30, i % 30);
+        if (crypted)
         {
-            pk = pk->previous();
+            PKX::decrypt(pk, length, gen);
         }
         else
         {
-            pk = pk->next();
+            PKX::encrypt(pk, length, gen);
         }
     }
+    // Decrypted boxes are always encrypted again before a resign, so only that marks them
+    if (!crypted)
+    {
+        u32 start = boxOffset(0, 0);
+        markDirty(start, boxOffset((maxSlot() - 1) / 30, (maxSlot() - 1) % 30) + length - start);
+    }
 }
 
 void Sav::fixParty()
@@ -197,6 +248,36 @@ void Sav::fixParty()
     partyCount(numPkm);
 }
 
+void Sav::trackBlocks(const u32* ofs, const u32* len, size_t count)
+{
+    trackedBlockOfs = ofs;
+    trackedBlockLen = len;
+    trackedBlockCount = count;
+    dirtyBlocks.assign(count, false);
+}
+
+void Sav::markDirty(u32 offset, u32 len)
+{
+    for (size_t i = 0; i < trackedBlockCount; i++)
+    {
+        if (offset < trackedBlockOfs[i] + trackedBlockLen[i] && trackedBlockOfs[i] < offset + len)
+        {
+            dirtyBlocks[i] = true;
+        }
+    }
+}
+
+bool Sav::dirty() const
+{
+    return rawWrites || std::find(dirtyBlocks.begin(), dirtyBlocks.end(), true) != dirtyBlocks.end();
+}
+
+void Sav::markClean()
+{
+    std::fill(dirtyBlocks.begin(), dirtyBlocks.end(), false);
+    rawWrites = false;
+}
+
 u32 Sav::displayTID() const
 {
     switch (generation())
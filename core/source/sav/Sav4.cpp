@@ -73,36 +73,42 @@ void Sav4::SBO(void)
     sbo = (c1 >= c2) ? 0 : 0x40000;
 }
 
+void Sav4::initBlocks(void)
+{
+    chkofs[0] = gbo;
+    chklen[0] = game == Game::DP ? 0xC0EC : game == Game::Pt ? 0xCF18 : 0xF618;
+    chkofs[1] = sbo + (game == Game::DP ? 0xC100 : game == Game::Pt ? 0xCF2C : 0xF700);
+    chklen[1] = sbo + (game == Game::DP ? 0x1E2CC : game == Game::Pt ? 0x1F0FC : 0x21A00) - chkofs[1];
+    trackBlocks(chkofs, chklen, 2);
+}
+
 void Sav4::resign(void)
 {
-    u8* tmp = new u8[0x12300];
-    u16 cs;
-    // start, end, chkoffset
-    int general[3] = {0x0, game == Game::DP ? 0xC0EC : game == Game::Pt ? 0xCF18 : 0xF618, game == Game::DP ? 0xC0FE : game == Game::Pt ? 0xCF2A : 0xF626};
-    int storage[3] = {game == Game::DP ? 0xC100 : game == Game::Pt ? 0xCF2C : 0xF700, game == Game::DP ? 0x1E2CC : game == Game::Pt ? 0x1F0FC : 0x21A00, game == Game::DP ? 0x1E2DE : game == Game::Pt ? 0x1F10E : 0x21A0E};
-    
-    std::copy(data + gbo + general[0], data + gbo + general[1], tmp);
-    cs = ccitt16(tmp, general[1] - general[0]);
-    *(u16*)(data + gbo + general[2]) = cs;
+    // the checksum follows the block footer
+    const u32 chkoffset = game == Game::HGSS ? 0xE : 0x12;
 
-    std::copy(data + sbo + storage[0], data + sbo + storage[1], tmp);
-    cs = ccitt16(tmp, storage[1] - storage[0]);
-    *(u16*)(data + sbo + storage[2]) = cs;
+    for (u8 i = 0; i < 2; i++)
+    {
+        if (dirty(i))
+        {
+            *(u16*)(data + chkofs[i] + chklen[i] + chkoffset) = ccitt16(data + chkofs[i], chklen[i]);
+        }
+    }
 
-    delete[] tmp;
+    markClean();
 }
 
 u16 Sav4::TID(void) const { return *(u16*)(data + Trainer1 + 0x10); }
-void Sav4::TID(u16 v) { *(u16*)(data + Trainer1 + 0x10) = v; }
+void Sav4::TID(u16 v) { *(u16*)(data + Trainer1 + 0x10) = v; markDirty(Trainer1 + 0x10, 2); }
 
 u16 Sav4::SID(void) const { return *(u16*)(data + Trainer1 + 0x12); }
-void Sav4::SID(u16 v) { *(u16*)(data + Trainer1 + 0x12) = v; }
+void Sav4::SID(u16 v) { *(u16*)(data + Trainer1 + 0x12) = v; markDirty(Trainer1 + 0x12, 2); }
 
 u8 Sav4::version(void) const { return game == DP ? 10 : game == Pt ? 12 : 7; }
 void Sav4::version(u8 v) { (void)v; }
 
 u8 Sav4::gender(void) const { return data[Trainer1 + 0x18]; }
-void Sav4::gender(u8 v) { data[Trainer1 + 0x18] = v; }
+void Sav4::gender(u8 v) { data[Trainer1 + 0x18] = v; markDirty(Trainer1 + 0x18, 1); }
 
 u8 Sav4::subRegion(void) const { return 0; } // Unused
 void Sav4::subRegion(u8 v) { (void)v; }
@@ -114,16 +120,16 @@ u8 Sav4::consoleRegion(void) const { return 0; } // Unused
 void Sav4::consoleRegion(u8 v) { (void)v; }
 
 u8 Sav4::language(void) const { return data[Trainer1 + 0x19]; }
-void Sav4::language(u8 v) { data[Trainer1 + 0x19] = v; }
+void Sav4::language(u8 v) { data[Trainer1 + 0x19] = v; markDirty(Trainer1 + 0x19, 1); }
 
 std::string Sav4::otName(void) const { return StringUtils::getString4(data, Trainer1, 8); }
-void Sav4::otName(const std::string& v) { StringUtils::setString4(data, v, Trainer1, 8); }
+void Sav4::otName(const std::string& v) { StringUtils::setString4(data, v, Trainer1, 8); markDirty(Trainer1, 16); }
 
 u32 Sav4::money(void) const { return *(u32*)(data + Trainer1 + 0x14); }
-void Sav4::money(u32 v) { *(u32*)(data + Trainer1 + 0x14) = v; }
+void Sav4::money(u32 v) { *(u32*)(data + Trainer1 + 0x14) = v; markDirty(Trainer1 + 0x14, 4); }
 
 u32 Sav4::BP(void) const { return *(u16*)(data + Trainer1 + 0x20); } // Returns Coins @ Game Corner
-void Sav4::BP(u32 v) { *(u16*)(data + Trainer1 + 0x20) = v; }
+void Sav4::BP(u32 v) { *(u16*)(data + Trainer1 + 0x20) = v; markDirty(Trainer1 + 0x20, 2); }
 
 u8 Sav4::badges(void) const
 {
@@ -145,13 +151,13 @@ u8 Sav4::badges(void) const
 }
 
 u16 Sav4::playedHours(void) const { return *(u16*)(data + Trainer1 + 0x22); }
-void Sav4::playedHours(u16 v) { *(u16*)(data + Trainer1 + 0x22) = v; }
+void Sav4::playedHours(u16 v) { *(u16*)(data + Trainer1 + 0x22) = v; markDirty(Trainer1 + 0x22, 2); }
 
 u8 Sav4::playedMinutes(void) const { return data[Trainer1 + 0x24]; }
-void Sav4::playedMinutes(u8 v) { data[Trainer1 + 0x24] = v; }
+void Sav4::playedMinutes(u8 v) { data[Trainer1 + 0x24] = v; markDirty(Trainer1 + 0x24, 1); }
 
 u8 Sav4::playedSeconds(void) const { return data[Trainer1 + 0x25]; }
-void Sav4::playedSeconds(u8 v) { data[Trainer1 + 0x25] = v; }
+void Sav4::playedSeconds(u8 v) { data[Trainer1 + 0x25] = v; markDirty(Trainer1 + 0x25, 1); }
 
 u8 Sav4::currentBox(void) const
 {
@@ -163,6 +169,7 @@ void Sav4::currentBox(u8 v)
 {
     int ofs = game == Game::HGSS ? boxOffset(maxBoxes(), 0) : Box - 4;
     data[ofs] = v;
+    markDirty(ofs, 1);
 }
 
 u32 Sav4::boxOffset(u8 box, u8 slot) const { return Box + 136*box*30 + (game == Game::HGSS ? box*0x10 : 0) + slot*136; }
@@ -173,7 +180,7 @@ std::shared_ptr<PKX> Sav4::pkm(u8 slot) const
     u8 buf[236];
     u32 ofs = partyOffset(slot);
     std::copy(data + ofs, data + ofs + 236, buf);
-    return std::make_shared<PK4>(buf, true, true);
+    return PKXPool::make<PK4>(buf, true, true);
 }
 
 void Sav4::pkm(std::shared_ptr<PKX> pk, u8 slot)
@@ -195,6 +202,7 @@ void Sav4::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk4->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk4->rawData(), pk4->rawData() + pk4->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 236);
 }
 
 std::shared_ptr<PKX> Sav4::pkm(u8 box, u8 slot, bool ekx) const
@@ -202,7 +210,7 @@ std::shared_ptr<PKX> Sav4::pkm(u8 box, u8 slot, bool ekx) const
     u8 buf[136];
     u32 ofs = boxOffset(box, slot);
     std::copy(data + ofs, data + ofs + 136, buf);
-    return std::make_shared<PK4>(buf, ekx);
+    return PKXPool::make<PK4>(buf, ekx);
 }
 
 void Sav4::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
@@ -214,6 +222,7 @@ void Sav4::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
     }
 
     std::copy(pk->rawData(), pk->rawData() + 136, data + boxOffset(box, slot));
+    markDirty(boxOffset(box, slot), 136);
 }
 
 void Sav4::trade(std::shared_ptr<PKX> pk)
@@ -227,27 +236,13 @@ void Sav4::trade(std::shared_ptr<PKX> pk)
     }
 }
 
-void Sav4::cryptBoxData(bool crypted)
-{
-    for (u8 box = 0; box < boxes; box++)
-    {
-        for (u8 slot = 0; slot < 30; slot++)
-        {
-            std::shared_ptr<PKX> pk4 = pkm(box, slot, crypted);
-            if (!crypted)
-            {
-                pk4->encrypt();
-            }
-            pkm(pk4, box, slot, false);
-        }
-    }
-}
-
 void Sav4::mysteryGift(WCX& wc, int& pos)
 {
     PGT* pgt = (PGT*)&wc;
     *(data + WondercardFlags + (2047 >> 3)) = 0x80;
     std::copy(pgt->rawData(), pgt->rawData() + PGT::length, data + WondercardData + pos * PGT::length);
+    markDirty(WondercardFlags + (2047 >> 3), 1);
+    markDirty(WondercardData + pos * PGT::length, PGT::length);
     pos++;
 }
 
@@ -256,10 +251,11 @@ std::string Sav4::boxName(u8 box) const { return StringUtils::getString4(data, b
 void Sav4::boxName(u8 box, const std::string& name)
 {
     StringUtils::setString4(data, name, boxOffset(18, 0) + box*0x28 + (game == Game::HGSS ? 0x8 : 0), 9);
+    markDirty(boxOffset(18, 0) + box*0x28 + (game == Game::HGSS ? 0x8 : 0), 18);
 }
 
 u8 Sav4::partyCount(void) const { return data[Party - 4]; }
-void Sav4::partyCount(u8 v) { data[Party - 4] = v; }
+void Sav4::partyCount(u8 v) { data[Party - 4] = v; markDirty(Party - 4, 1); }
 
 void Sav4::dex(std::shared_ptr<PKX> pk)
 {
@@ -272,6 +268,8 @@ void Sav4::dex(std::shared_ptr<PKX> pk)
     int bit = pk->species() - 1;
     u8 mask = (u8)(1 << (bit & 7));
     int ofs = PokeDex + (bit >> 3) + 0x4;
+    // flags, forms and languages, up to the last form byte written by setForms
+    markDirty(PokeDex, 4 + brSize * 4 + 4 + (game == Game::HGSS ? 0x3C : 0x20) + 0x1F4 + 7);
 
     /* 4 BitRegions with 0x40*8 bits
     * Region 0: Caught (Captured/Owned) flags
@@ -666,35 +664,38 @@ void Sav4::item(Item& item, Pouch pouch, u16 slot)
 {
     Item4 inject = (Item4) item;
     auto write = inject.bytes();
+    u32 ofs;
     switch (pouch)
     {
         case NormalItem:
-            std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            ofs = PouchHeldItem + slot * 4;
             break;
         case KeyItem:
-            std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            ofs = PouchKeyItem + slot * 4;
             break;
         case TM:
-            std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            ofs = PouchTMHM + slot * 4;
             break;
         case Mail:
-            std::copy(write.first, write.first + write.second, data + MailItems + slot * 4);
+            ofs = MailItems + slot * 4;
             break;
         case Medicine:
-            std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            ofs = PouchMedicine + slot * 4;
             break;
         case Berry:
-            std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            ofs = PouchBerry + slot * 4;
             break;
         case Ball:
-            std::copy(write.first, write.first + write.second, data + PouchBalls + slot * 4);
+            ofs = PouchBalls + slot * 4;
             break;
         case Battle:
-            std::copy(write.first, write.first + write.second, data + BattleItems + slot * 4);
+            ofs = BattleItems + slot * 4;
             break;
         default:
             return;
     }
+    std::copy(write.first, write.first + write.second, data + ofs);
+    markDirty(ofs, write.second);
 }
 
 std::unique_ptr<Item> Sav4::item(Pouch pouch, u16 slot) const
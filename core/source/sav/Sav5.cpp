@@ -27,16 +27,16 @@
 #include "Sav5.hpp"
 
 u16 Sav5::TID(void) const { return *(u16*)(data + Trainer1 + 0x14); }
-void Sav5::TID(u16 v) { *(u16*)(data + Trainer1 + 0x14) = v; }
+void Sav5::TID(u16 v) { *(u16*)(data + Trainer1 + 0x14) = v; markDirty(Trainer1 + 0x14, 2); }
 
 u16 Sav5::SID(void) const { return *(u16*)(data + Trainer1 + 0x16); }
-void Sav5::SID(u16 v) { *(u16*)(data + Trainer1 + 0x16) = v; }
+void Sav5::SID(u16 v) { *(u16*)(data + Trainer1 + 0x16) = v; markDirty(Trainer1 + 0x16, 2); }
 
 u8 Sav5::version(void) const { return data[Trainer1 + 0x1F]; }
-void Sav5::version(u8 v) { data[Trainer1 + 0x1F] = v; }
+void Sav5::version(u8 v) { data[Trainer1 + 0x1F] = v; markDirty(Trainer1 + 0x1F, 1); }
 
 u8 Sav5::gender(void) const { return data[Trainer1 + 0x21]; }
-void Sav5::gender(u8 v) { data[Trainer1 + 0x21] = v; }
+void Sav5::gender(u8 v) { data[Trainer1 + 0x21] = v; markDirty(Trainer1 + 0x21, 1); }
 
 u8 Sav5::subRegion(void) const { return 0; } // Unused
 void Sav5::subRegion(u8 v) { (void)v; }
@@ -48,16 +48,16 @@ u8 Sav5::consoleRegion(void) const { return 0; } // Unused
 void Sav5::consoleRegion(u8 v) { (void)v; }
 
 u8 Sav5::language(void) const { return data[Trainer1 + 0x1E]; }
-void Sav5::language(u8 v) { data[Trainer1 + 0x1E] = v; }
+void Sav5::language(u8 v) { data[Trainer1 + 0x1E] = v; markDirty(Trainer1 + 0x1E, 1); }
 
 std::string Sav5::otName(void) const { return StringUtils::getTrimmedString(data, Trainer1 + 0x4, 8, (char*)"\uFFFF"); }
-void Sav5::otName(const std::string& v) { StringUtils::setStringWithBytes(data, v, Trainer1 + 0x4, 8, (char*)"\uFFFF"); }
+void Sav5::otName(const std::string& v) { StringUtils::setStringWithBytes(data, v, Trainer1 + 0x4, 8, (char*)"\uFFFF"); markDirty(Trainer1 + 0x4, 16); }
 
 u32 Sav5::money(void) const { return *(u32*)(data + Trainer2); }
-void Sav5::money(u32 v) { *(u32*)(data + Trainer2) = v; }
+void Sav5::money(u32 v) { *(u32*)(data + Trainer2) = v; markDirty(Trainer2, 4); }
 
 u32 Sav5::BP(void) const { return *(u32*)(data + BattleSubway); }
-void Sav5::BP(u32 v) { *(u32*)(data + BattleSubway) = v; }
+void Sav5::BP(u32 v) { *(u32*)(data + BattleSubway) = v; markDirty(BattleSubway, 4); }
 
 u8 Sav5::badges(void) const
 {
@@ -71,16 +71,16 @@ u8 Sav5::badges(void) const
 }
 
 u16 Sav5::playedHours(void) const { return *(u16*)(data + Trainer1 + 0x24); }
-void Sav5::playedHours(u16 v) { *(u16*)(data + Trainer1 + 0x24) = v; }
+void Sav5::playedHours(u16 v) { *(u16*)(data + Trainer1 + 0x24) = v; markDirty(Trainer1 + 0x24, 2); }
 
 u8 Sav5::playedMinutes(void) const { return data[Trainer1 + 0x26]; }
-void Sav5::playedMinutes(u8 v) { data[Trainer1 + 0x26] = v; }
+void Sav5::playedMinutes(u8 v) { data[Trainer1 + 0x26] = v; markDirty(Trainer1 + 0x26, 1); }
 
 u8 Sav5::playedSeconds(void) const { return data[Trainer1 + 0x27]; }
-void Sav5::playedSeconds(u8 v) { data[Trainer1 + 0x27] = v; }
+void Sav5::playedSeconds(u8 v) { data[Trainer1 + 0x27] = v; markDirty(Trainer1 + 0x27, 1); }
 
 u8 Sav5::currentBox(void) const { return data[PCLayout]; }
-void Sav5::currentBox(u8 v) { data[PCLayout] = v; }
+void Sav5::currentBox(u8 v) { data[PCLayout] = v; markDirty(PCLayout, 1); }
 
 u32 Sav5::boxOffset(u8 box, u8 slot) const { return Box + 136*box*30 + 0x10*box + 136*slot ; }
 u32 Sav5::partyOffset(u8 slot) const { return Party + 8 + 220*slot; }
@@ -89,7 +89,7 @@ std::shared_ptr<PKX> Sav5::pkm(u8 slot) const
 {
     u8 buf[220];
     std::copy(data + partyOffset(slot), data + partyOffset(slot) + 220, buf);
-    return std::make_shared<PK5>(buf, true, true);
+    return PKXPool::make<PK5>(buf, true, true);
 }
 
 void Sav5::pkm(std::shared_ptr<PKX> pk, u8 slot)
@@ -110,14 +110,15 @@ void Sav5::pkm(std::shared_ptr<PKX> pk, u8 slot)
 
     pk5->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
-    std::copy(pk5->rawData(), pk5->rawData() + pk5->getLength(), data + partyOffset(slot));    
+    std::copy(pk5->rawData(), pk5->rawData() + pk5->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 220);
 }
 
 std::shared_ptr<PKX> Sav5::pkm(u8 box, u8 slot, bool ekx) const
 {
     u8 buf[136];
     std::copy(data + boxOffset(box, slot), data + boxOffset(box, slot) + 136, buf);
-    return std::make_shared<PK5>(buf, ekx);
+    return PKXPool::make<PK5>(buf, ekx);
 }
 
 void Sav5::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
@@ -129,6 +130,7 @@ void Sav5::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
     }
 
     std::copy(pk->rawData(), pk->rawData() + 136, data + boxOffset(box, slot));
+    markDirty(boxOffset(box, slot), 136);
 }
 
 void Sav5::trade(std::shared_ptr<PKX> pk)
@@ -142,22 +144,6 @@ void Sav5::trade(std::shared_ptr<PKX> pk)
     }
 }
 
-void Sav5::cryptBoxData(bool crypted)
-{
-    for (u8 box = 0; box < boxes; box++)
-    {
-        for (u8 slot = 0; slot < 30; slot++)
-        {
-            std::shared_ptr<PKX> pk5 = pkm(box, slot, crypted);
-            if (!crypted)
-            {
-                pk5->encrypt();
-            }
-            pkm(pk5, box, slot, false);
-        }
-    }
-}
-
 int Sav5::dexFormIndex(int species, int formct) const
 {
     if (formct < 1 || species < 0)
@@ -211,6 +197,8 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
     int shift = shiny*2 + gender + 1;
     int shiftoff = shiny * brSize * 2 + gender * brSize + brSize;
     int ofs = PokeDex + 0x8 + (bit >> 3);
+    // flag regions followed by the form regions
+    markDirty(PokeDex, 0x8 + brSize*9 + (game == Game::BW ? 0x9 : 0xB)*4);
 
     // Set the Species Owned Flag
     data[ofs + brSize*0] |= (u8)(1 << (bit % 8));
@@ -233,6 +221,7 @@ void Sav5::dex(std::shared_ptr<PKX> pk)
         int lang = pk->language() - 1; if (lang > 5) lang--; // 0-6 language vals
         if (lang < 0) lang = 1;
         data[PokeDexLanguageFlags + ((bit*7 + lang)>>3)] |= (u8)(1 << ((bit*7 + lang) & 7));
+        markDirty(PokeDexLanguageFlags + ((bit*7 + lang)>>3), 1);
     }
 
     // Formes
@@ -297,6 +286,8 @@ void Sav5::mysteryGift(WCX& wc, int& pos)
 
     *(data + WondercardFlags + pgf->ID()) |= 0x1 << (pgf->ID() & 7);
     std::copy(pgf->rawData(), pgf->rawData() + PGF::length, data + WondercardData + pos * PGF::length);
+    markDirty(WondercardFlags + pgf->ID(), 1);
+    markDirty(WondercardData + pos * PGF::length, PGF::length);
     pos = (pos + 1) % 12;
 }
 
@@ -305,10 +296,11 @@ std::string Sav5::boxName(u8 box) const { return StringUtils::getTrimmedString(d
 void Sav5::boxName(u8 box, const std::string& name)
 {
     StringUtils::setStringWithBytes(data, name, PCLayout + 0x28 * box + 4, 9, (char*)"\uFFFF");
+    markDirty(PCLayout + 0x28 * box + 4, 18);
 }
 
 u8 Sav5::partyCount(void) const { return data[Party + 4]; }
-void Sav5::partyCount(u8 v) { data[Party + 4] = v; }
+void Sav5::partyCount(u8 v) { data[Party + 4] = v; markDirty(Party + 4, 1); }
 
 std::shared_ptr<PKX> Sav5::emptyPkm() const
 {
@@ -368,6 +360,7 @@ void Sav5::cryptMysteryGiftData()
         seed = seed * 0x41C64E6D + 0x6073; // Replace with seedStep?
         *(u16*)(data + WondercardFlags + i) ^= (seed >> 16);
     }
+    markDirty(WondercardFlags, 0xA90);
 }
 
 std::unique_ptr<WCX> Sav5::mysteryGift(int pos) const
@@ -379,26 +372,29 @@ void Sav5::item(Item& item, Pouch pouch, u16 slot)
 {
     Item5 inject = (Item5) item;
     auto write = inject.bytes();
+    u32 ofs;
     switch (pouch)
     {
         case NormalItem:
-            std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            ofs = PouchHeldItem + slot * 4;
             break;
         case KeyItem:
-            std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            ofs = PouchKeyItem + slot * 4;
             break;
         case TM:
-            std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            ofs = PouchTMHM + slot * 4;
             break;
         case Medicine:
-            std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            ofs = PouchMedicine + slot * 4;
             break;
         case Berry:
-            std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            ofs = PouchBerry + slot * 4;
             break;
         default:
             return;
     }
+    std::copy(write.first, write.first + write.second, data + ofs);
+    markDirty(ofs, write.second);
 }
 
 std::unique_ptr<Item> Sav5::item(Pouch pouch, u16 slot) const
@@ -27,37 +27,37 @@
 #include "Sav6.hpp"
 
 u16 Sav6::TID(void) const { return *(u16*)(data + TrainerCard); }
-void Sav6::TID(u16 v) { *(u16*)(data + TrainerCard) = v; }
+void Sav6::TID(u16 v) { *(u16*)(data + TrainerCard) = v; markDirty(TrainerCard, 2); }
 
 u16 Sav6::SID(void) const { return *(u16*)(data + TrainerCard + 2); }
-void Sav6::SID(u16 v) { *(u16*)(data + TrainerCard + 2) = v; }
+void Sav6::SID(u16 v) { *(u16*)(data + TrainerCard + 2) = v; markDirty(TrainerCard + 2, 2); }
 
 u8 Sav6::version(void) const { return data[TrainerCard + 4]; }
-void Sav6::version(u8 v) { data[TrainerCard + 4] = v; }
+void Sav6::version(u8 v) { data[TrainerCard + 4] = v; markDirty(TrainerCard + 4, 1); }
 
 u8 Sav6::gender(void) const { return data[TrainerCard + 5]; }
-void Sav6::gender(u8 v) { data[TrainerCard + 5] = v; }
+void Sav6::gender(u8 v) { data[TrainerCard + 5] = v; markDirty(TrainerCard + 5, 1); }
 
 u8 Sav6::subRegion(void) const { return data[TrainerCard + 0x26]; }
-void Sav6::subRegion(u8 v) { data[TrainerCard + 0x26] = v; }
+void Sav6::subRegion(u8 v) { data[TrainerCard + 0x26] = v; markDirty(TrainerCard + 0x26, 1); }
 
 u8 Sav6::country(void) const { return data[TrainerCard + 0x27]; }
-void Sav6::country(u8 v) { data[TrainerCard + 0x27] = v; }
+void Sav6::country(u8 v) { data[TrainerCard + 0x27] = v; markDirty(TrainerCard + 0x27, 1); }
 
 u8 Sav6::consoleRegion(void) const { return data[TrainerCard + 0x2C]; }
-void Sav6::consoleRegion(u8 v) { data[TrainerCard + 0x2C] = v; }
+void Sav6::consoleRegion(u8 v) { data[TrainerCard + 0x2C] = v; markDirty(TrainerCard + 0x2C, 1); }
 
 u8 Sav6::language(void) const { return data[TrainerCard + 0x2D]; }
-void Sav6::language(u8 v) { data[TrainerCard + 0x2D] = v; }
+void Sav6::language(u8 v) { data[TrainerCard + 0x2D] = v; markDirty(TrainerCard + 0x2D, 1); }
 
 std::string Sav6::otName(void) const { return StringUtils::getString(data, TrainerCard + 0x48, 13); }
-void Sav6::otName(const std::string& v) { StringUtils::setString(data, v, TrainerCard + 0x48, 13); }
+void Sav6::otName(const std::string& v) { StringUtils::setString(data, v, TrainerCard + 0x48, 13); markDirty(TrainerCard + 0x48, 26); }
 
 u32 Sav6::money(void) const { return *(u32*)(data + Trainer2 + 0x8); }
-void Sav6::money(u32 v) { *(u32*)(data + Trainer2 + 0x8) = v; }
+void Sav6::money(u32 v) { *(u32*)(data + Trainer2 + 0x8) = v; markDirty(Trainer2 + 0x8, 4); }
 
 u32 Sav6::BP(void) const { return *(u32*)(data + Trainer2 + (game == Game::XY ? 0x3C : 0x30)); }
-void Sav6::BP(u32 v) { *(u32*)(data + Trainer2 + (game == Game::XY ? 0x3C : 0x30)) = v; }
+void Sav6::BP(u32 v) { *(u32*)(data + Trainer2 + (game == Game::XY ? 0x3C : 0x30)) = v; markDirty(Trainer2 + (game == Game::XY ? 0x3C : 0x30), 4); }
 
 u8 Sav6::badges(void) const
 {
@@ -71,16 +71,16 @@ u8 Sav6::badges(void) const
 }
 
 u16 Sav6::playedHours(void) const { return *(u16*)(data + PlayTime); }
-void Sav6::playedHours(u16 v) { *(u16*)(data + PlayTime) = v; }
+void Sav6::playedHours(u16 v) { *(u16*)(data + PlayTime) = v; markDirty(PlayTime, 2); }
 
 u8 Sav6::playedMinutes(void) const { return *(u8*)(data + PlayTime + 2); }
-void Sav6::playedMinutes(u8 v) { *(u8*)(data + PlayTime + 2) = v; }
+void Sav6::playedMinutes(u8 v) { *(u8*)(data + PlayTime + 2) = v; markDirty(PlayTime + 2, 1); }
 
 u8 Sav6::playedSeconds(void) const { return *(u8*)(data + PlayTime + 3); }
-void Sav6::playedSeconds(u8 v) { *(u8*)(data + PlayTime + 3) = v; }
+void Sav6::playedSeconds(u8 v) { *(u8*)(data + PlayTime + 3) = v; markDirty(PlayTime + 3, 1); }
 
 u8 Sav6::currentBox(void) const { return data[LastViewedBox]; }
-void Sav6::currentBox(u8 v) { data[LastViewedBox] = v; }
+void Sav6::currentBox(u8 v) { data[LastViewedBox] = v; markDirty(LastViewedBox, 1); }
 
 u32 Sav6::boxOffset(u8 box, u8 slot) const { return Box + 232*30*box + 232*slot; }
 
@@ -90,7 +90,7 @@ std::shared_ptr<PKX> Sav6::pkm(u8 slot) const
 {
     u8 tmp[260];
     std::copy(data + partyOffset(slot), data + partyOffset(slot) + 260, tmp);
-    return std::make_shared<PK6>(tmp, true, true);
+    return PKXPool::make<PK6>(tmp, true, true);
 }
 
 void Sav6::pkm(std::shared_ptr<PKX> pk, u8 slot)
@@ -112,13 +112,14 @@ void Sav6::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk6->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk6->rawData(), pk6->rawData() + pk6->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 260);
 }
 
 std::shared_ptr<PKX> Sav6::pkm(u8 box, u8 slot, bool ekx) const
 {
     u8 tmp[232];
     std::copy(data + boxOffset(box, slot), data + boxOffset(box, slot) + 232, tmp);
-    return std::make_shared<PK6>(tmp, ekx);
+    return PKXPool::make<PK6>(tmp, ekx);
 }
 
 void Sav6::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
@@ -130,6 +131,7 @@ void Sav6::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
     }
 
     std::copy(pk->rawData(), pk->rawData() + 232, data + boxOffset(box, slot));
+    markDirty(boxOffset(box, slot), 232);
 }
 
 void Sav6::trade(std::shared_ptr<PKX> pk)
@@ -213,22 +215,6 @@ void Sav6::trade(std::shared_ptr<PKX> pk)
     }
 }
 
-void Sav6::cryptBoxData(bool crypted)
-{
-    for (u8 box = 0; box < boxes; box++)
-    {
-        for (u8 slot = 0; slot < 30; slot++)
-        {
-            std::shared_ptr<PKX> pk6 = pkm(box, slot, crypted);
-            if (!crypted)
-            {
-                pk6->encrypt();
-            }
-            pkm(pk6, box, slot, false);
-        }
-    }
-}
-
 int Sav6::dexFormIndex(int species, int formct) const
 {
     if (formct < 1 || species < 0)
@@ -347,6 +333,8 @@ void Sav6::dex(std::shared_ptr<PKX> pk)
     int bm = bit & 7; // mod8
     u8 mask = (u8)(1 << bm);
     int ofs = PokeDex + 0x8 + bd;
+    // flag and form regions, up to the end of the foreign owned region
+    markDirty(PokeDex, 0x8 + 0x644 + brSize);
 
     // Owned quality flag
     if (origin < 0x18 && bit < 649 && game != Game::ORAS) // Species: 1-649 for X/Y, and not for ORAS; Set the Foreign Owned Flag
@@ -369,10 +357,14 @@ void Sav6::dex(std::shared_ptr<PKX> pk)
     // Set the Language
     if (lang < 0) lang = 1;
     data[PokeDexLanguageFlags + (bit * 7 + lang) / 8] |= (u8)(1 << ((bit * 7 + lang) % 8));
+    markDirty(PokeDexLanguageFlags + (bit * 7 + lang) / 8, 1);
 
     // Set DexNav count (only if not encountered previously)
     if (game == Game::ORAS && *(u16*)(data + EncounterCount + (pk->species() - 1) * 2) == 0)
+    {
         *(u16*)(data + EncounterCount + (pk->species() - 1) * 2) = 1;
+        markDirty(EncounterCount + (pk->species() - 1) * 2, 2);
+    }
 
     // Set Form flags
     int fc = PersonalXYORAS::formCount(pk->species());
@@ -436,6 +428,8 @@ void Sav6::mysteryGift(WCX& wc, int& pos)
     WC6* wc6 = (WC6*)&wc;
     *(u8*)(data + WondercardFlags + wc6->ID()/8) |= 0x1 << (wc6->ID() % 8);
     std::copy(wc6->rawData(), wc6->rawData() + 264, data + WondercardData + 264*pos);
+    markDirty(WondercardFlags + wc6->ID()/8, 1);
+    markDirty(WondercardData + 264*pos, 264);
     pos = (pos + 1) % 24;
 }
 
@@ -444,10 +438,11 @@ std::string Sav6::boxName(u8 box) const { return StringUtils::getString(data, PC
 void Sav6::boxName(u8 box, const std::string& name)
 {
     StringUtils::setString(data, name, PCLayout + 0x22*box, 17);
+    markDirty(PCLayout + 0x22*box, 34);
 }
 
 u8 Sav6::partyCount(void) const { return data[Party + 6*260]; }
-void Sav6::partyCount(u8 v) { data[Party + 6*260] = v; }
+void Sav6::partyCount(u8 v) { data[Party + 6*260] = v; markDirty(Party + 6*260, 1); }
 
 std::shared_ptr<PKX> Sav6::emptyPkm() const
 {
@@ -508,26 +503,29 @@ void Sav6::item(Item& item, Pouch pouch, u16 slot)
 {
     Item6 inject = (Item6) item;
     auto write = inject.bytes();
+    u32 ofs;
     switch (pouch)
     {
         case NormalItem:
-            std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            ofs = PouchHeldItem + slot * 4;
             break;
         case KeyItem:
-            std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            ofs = PouchKeyItem + slot * 4;
             break;
         case TM:
-            std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            ofs = PouchTMHM + slot * 4;
             break;
         case Medicine:
-            std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            ofs = PouchMedicine + slot * 4;
             break;
         case Berry:
-            std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            ofs = PouchBerry + slot * 4;
             break;
         default:
             return;
     }
+    std::copy(write.first, write.first + write.second, data + ofs);
+    markDirty(ofs, write.second);
 }
 
 std::unique_ptr<Item> Sav6::item(Pouch pouch, u16 slot) const
@@ -25,55 +25,51 @@
 */
 
 #include "Sav7.hpp"
+#include "crc.hpp"
 
-u16 Sav7::check16(u8* buf, u32 blockID, u32 len) const
+u16 Sav7::check16(const u8* buf, u32 blockID, u32 len) const
 {
+    // block 36 holds the memecrypto signature, which is checksummed as zeroes
     if (blockID == 36)
     {
-        u8 tmp[0x80] = {0};
-        std::copy(tmp, tmp + 0x80, buf + 0x100);
+        return ~CRC::crc16(buf, len, 0xFFFF, 0x100, 0x80);
     }
 
-    u16 chk = ~0;
-    for (u32 i = 0; i < len; i++)
-    {
-        chk = (crc16[(buf[i] ^ chk) & 0xFF] ^ chk >> 8);
-    }
-    return ~chk;
+    return ~CRC::crc16(buf, len, 0xFFFF);
 }
 
 u16 Sav7::TID(void) const { return *(u16*)(data + TrainerCard); }
-void Sav7::TID(u16 v) { *(u16*)(data + TrainerCard) = v; }
+void Sav7::TID(u16 v) { *(u16*)(data + TrainerCard) = v; markDirty(TrainerCard, 2); }
 
 u16 Sav7::SID(void) const { return *(u16*)(data + TrainerCard + 2); }
-void Sav7::SID(u16 v) { *(u16*)(data + TrainerCard + 2) = v; }
+void Sav7::SID(u16 v) { *(u16*)(data + TrainerCard + 2) = v; markDirty(TrainerCard + 2, 2); }
 
 u8 Sav7::version(void) const { return data[TrainerCard + 4]; }
-void Sav7::version(u8 v) { data[TrainerCard + 4] = v; }
+void Sav7::version(u8 v) { data[TrainerCard + 4] = v; markDirty(TrainerCard + 4, 1); }
 
 u8 Sav7::gender(void) const { return data[TrainerCard + 5]; }
-void Sav7::gender(u8 v) { data[TrainerCard + 5] = v; }
+void Sav7::gender(u8 v) { data[TrainerCard + 5] = v; markDirty(TrainerCard + 5, 1); }
 
 u8 Sav7::subRegion(void) const { return data[TrainerCard + 0x2E]; }
-void Sav7::subRegion(u8 v) { data[TrainerCard + 0x2E] = v; }
+void Sav7::subRegion(u8 v) { data[TrainerCard + 0x2E] = v; markDirty(TrainerCard + 0x2E, 1); }
 
 u8 Sav7::country(void) const { return data[TrainerCard + 0x2F]; }
-void Sav7::country(u8 v) { data[TrainerCard + 0x2F] = v; }
+void Sav7::country(u8 v) { data[TrainerCard + 0x2F] = v; markDirty(TrainerCard + 0x2F, 1); }
 
 u8 Sav7::consoleRegion(void) const { return data[TrainerCard + 0x34]; }
-void Sav7::consoleRegion(u8 v) { data[TrainerCard + 0x34] = v; }
+void Sav7::consoleRegion(u8 v) { data[TrainerCard + 0x34] = v; markDirty(TrainerCard + 0x34, 1); }
 
 u8 Sav7::language(void) const { return data[TrainerCard + 0x35]; }
-void Sav7::language(u8 v) { data[TrainerCard + 0x35] = v; }
+void Sav7::language(u8 v) { data[TrainerCard + 0x35] = v; markDirty(TrainerCard + 0x35, 1); }
 
 std::string Sav7::otName(void) const { return StringUtils::getString(data, TrainerCard + 0x38, 13); }
-void Sav7::otName(const std::string& v) { return StringUtils::setString(data, v, TrainerCard + 0x38, 13); }
+void Sav7::otName(const std::string& v) { StringUtils::setString(data, v, TrainerCard + 0x38, 13); markDirty(TrainerCard + 0x38, 26); }
 
 u32 Sav7::money(void) const { return *(u32*)(data + Misc + 0x4); }
-void Sav7::money(u32 v) { *(u32*)(data + Misc + 0x4) = v > 9999999 ? 9999999 : v; }
+void Sav7::money(u32 v) { *(u32*)(data + Misc + 0x4) = v > 9999999 ? 9999999 : v; markDirty(Misc + 0x4, 4); }
 
 u32 Sav7::BP(void) const { return *(u32*)(data + Misc + 0x11C); }
-void Sav7::BP(u32 v) { *(u32*)(data + Misc + 0x11C) = v > 9999 ? 9999 : v; }
+void Sav7::BP(u32 v) { *(u32*)(data + Misc + 0x11C) = v > 9999 ? 9999 : v; markDirty(Misc + 0x11C, 4); }
 
 u8 Sav7::badges(void) const
 {
@@ -87,16 +83,16 @@ u8 Sav7::badges(void) const
 }
 
 u16 Sav7::playedHours(void) const { return *(u16*)(data + PlayTime); }
-void Sav7::playedHours(u16 v) { *(u16*)(data + PlayTime) = v; }
+void Sav7::playedHours(u16 v) { *(u16*)(data + PlayTime) = v; markDirty(PlayTime, 2); }
 
 u8 Sav7::playedMinutes(void) const { return data[PlayTime + 2]; }
-void Sav7::playedMinutes(u8 v) { data[PlayTime + 2] = v; }
+void Sav7::playedMinutes(u8 v) { data[PlayTime + 2] = v; markDirty(PlayTime + 2, 1); }
 
 u8 Sav7::playedSeconds(void) const { return data[PlayTime + 3]; }
-void Sav7::playedSeconds(u8 v) { data[PlayTime + 3] = v; }
+void Sav7::playedSeconds(u8 v) { data[PlayTime + 3] = v; markDirty(PlayTime + 3, 1); }
 
 u8 Sav7::currentBox(void) const { return data[LastViewedBox]; }
-void Sav7::currentBox(u8 v) { data[LastViewedBox] = v; }
+void Sav7::currentBox(u8 v) { data[LastViewedBox] = v; markDirty(LastViewedBox, 1); }
 
 u32 Sav7::boxOffset(u8 box, u8 slot) const { return Box + 232*30*box + 232*slot; }
 
@@ -106,7 +102,7 @@ std::shared_ptr<PKX> Sav7::pkm(u8 slot) const
 {
     u8 buf[260];
     std::copy(data + partyOffset(slot), data + partyOffset(slot) + 260, buf);
-    return std::make_unique<PK7>(buf, true, true);
+    return PKXPool::make<PK7>(buf, true, true);
 }
 
 void Sav7::pkm(std::shared_ptr<PKX> pk, u8 slot)
@@ -128,13 +124,14 @@ void Sav7::pkm(std::shared_ptr<PKX> pk, u8 slot)
     pk7->encrypt();
     std::fill(data + partyOffset(slot), data + partyOffset(slot + 1), (u8)0);
     std::copy(pk7->rawData(), pk7->rawData() + pk7->getLength(), data + partyOffset(slot));
+    markDirty(partyOffset(slot), 260);
 }
 
 std::shared_ptr<PKX> Sav7::pkm(u8 box, u8 slot, bool ekx) const
 {
     u8 buf[232];
     std::copy(data + boxOffset(box, slot), data + boxOffset(box, slot) + 232, buf);
-    return std::make_unique<PK7>(buf, ekx);
+    return PKXPool::make<PK7>(buf, ekx);
 }
 
 void Sav7::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
@@ -146,6 +143,7 @@ void Sav7::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
     }
     
     std::copy(pk->rawData(), pk->rawData() + 232, data + boxOffset(box, slot));
+    markDirty(boxOffset(box, slot), 232);
 }
 
 void Sav7::trade(std::shared_ptr<PKX> pk)
@@ -179,22 +177,6 @@ void Sav7::trade(std::shared_ptr<PKX> pk)
     }
 }
 
-void Sav7::cryptBoxData(bool crypted)
-{
-    for (u8 box = 0; box < boxes; box++)
-    {
-        for (u8 slot = 0; slot < 30; slot++)
-        {
-            std::shared_ptr<PKX> pk7 = pkm(box, slot, crypted);
-            if (!crypted)
-            {
-                pk7->encrypt();
-            }
-            pkm(pk7, box, slot, false);
-        }
-    }
-}
-
 void Sav7::setDexFlags(int index, int gender, int shiny, int baseSpecies)
 {
     const int brSize = 0x8C;
@@ -302,6 +284,8 @@ void Sav7::dex(std::shared_ptr<PKX> pk)
     if (pk->species() == 351)
         shiny = 0;
     int shift = gender | (shiny << 1);
+    // owned, seen and displayed flags, up to the Spinda spot data
+    markDirty(PokeDex, 0x8E8 + 4*4);
     
     if (pk->species() == 327) // Spinda
     {
@@ -354,7 +338,10 @@ void Sav7::dex(std::shared_ptr<PKX> pk)
         if (lang < 0) lang = 1;
         int lbit = bit * langCount + lang;
         if (lbit >> 3 < 920)
+        {
             data[PokeDexLanguageFlags + (lbit >> 3)] |= (u8)(1 << (lbit & 7));
+            markDirty(PokeDexLanguageFlags + (lbit >> 3), 1);
+        }
     }
 }
 
@@ -394,6 +381,8 @@ void Sav7::mysteryGift(WCX& wc, int& pos)
     WC7* wc7 = (WC7*)&wc;
     *(u8*)(data + WondercardFlags + wc7->ID()/8) |= 0x1 << (wc7->ID() % 8);
     std::copy(wc7->rawData(), wc7->rawData() + 264, data + WondercardData + 264*pos);
+    markDirty(WondercardFlags + wc7->ID()/8, 1);
+    markDirty(WondercardData + 264*pos, 264);
     pos = (pos + 1) % 48;
 }
 
@@ -405,10 +394,11 @@ std::string Sav7::boxName(u8 box) const
 void Sav7::boxName(u8 box, const std::string& name)
 {
     StringUtils::setString(data, name, PCLayout + 0x22*box, 17);
+    markDirty(PCLayout + 0x22*box, 34);
 }
 
 u8 Sav7::partyCount(void) const { return data[Party + 6*260]; }
-void Sav7::partyCount(u8 v) { data[Party + 6*260] = v; }
+void Sav7::partyCount(u8 v) { data[Party + 6*260] = v; markDirty(Party + 6*260, 1); }
 
 std::shared_ptr<PKX> Sav7::emptyPkm() const
 {
@@ -469,32 +459,35 @@ void Sav7::item(Item& item, Pouch pouch, u16 slot)
 {
     Item7 inject = (Item7) item;
     auto write = inject.bytes();
+    u32 ofs;
     switch (pouch)
     {
         case NormalItem:
-            std::copy(write.first, write.first + write.second, data + PouchHeldItem + slot * 4);
+            ofs = PouchHeldItem + slot * 4;
             break;
         case KeyItem:
-            std::copy(write.first, write.first + write.second, data + PouchKeyItem + slot * 4);
+            ofs = PouchKeyItem + slot * 4;
             break;
         case TM:
-            std::copy(write.first, write.first + write.second, data + PouchTMHM + slot * 4);
+            ofs = PouchTMHM + slot * 4;
             break;
         case Medicine:
-            std::copy(write.first, write.first + write.second, data + PouchMedicine + slot * 4);
+            ofs = PouchMedicine + slot * 4;
             break;
         case Berry:
-            std::copy(write.first, write.first + write.second, data + PouchBerry + slot * 4);
+            ofs = PouchBerry + slot * 4;
             break;
         case ZCrystals:
-            std::copy(write.first, write.first + write.second, data + PouchZCrystals + slot * 4);
+            ofs = PouchZCrystals + slot * 4;
             break;
         case Battle:
-            std::copy(write.first, write.first + write.second, data + BattleItems + slot * 4);
+            ofs = BattleItems + slot * 4;
             break;
         default:
             return;
     }
+    std::copy(write.first, write.first + write.second, data + ofs);
+    markDirty(ofs, write.second);
 }
 
 std::unique_ptr<Item> Sav7::item(Pouch pouch, u16 slot) const
@@ -50,6 +50,8 @@ SavB2W2::SavB2W2(u8* dt)
     PouchMedicine = 0x18BD8;
     PouchBerry = 0x18C98;
     Box = 0x400;
+
+    trackBlocks(blockOfs, lengths, 74);
 }
 
 SavB2W2::~SavB2W2() { }
@@ -57,18 +59,22 @@ SavB2W2::~SavB2W2() { }
 void SavB2W2::resign(void)
 {
     const u8 blockCount = 74;
-    u8* tmp = new u8[*std::max_element(lengths, lengths + blockCount)];
     u16 cs;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + blockOfs[i], data + blockOfs[i] + lengths[i], tmp);
-        cs = ccitt16(tmp, lengths[i]);
+        // the last block holds the checksum mirror, so it is marked by the writes below
+        if (!dirty(i))
+        {
+            continue;
+        }
+        cs = ccitt16(data + blockOfs[i], lengths[i]);
         *(u16*)(data + chkMirror[i]) = cs;
         *(u16*)(data + chkofs[i]) = cs;
+        markDirty(chkMirror[i], 2);
     }
 
-    delete[] tmp;
+    markClean();
 }
 
 std::map<Pouch, std::vector<int>> SavB2W2::validItems() const
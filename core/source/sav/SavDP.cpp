@@ -40,6 +40,7 @@ SavDP::SavDP(u8* dt)
     SBOOffset = 0x1E2D0;
     GBO();
     SBO();
+    initBlocks();
 
     Trainer1 = 0x64 + gbo;
     Party = 0x98 + gbo;
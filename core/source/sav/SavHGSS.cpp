@@ -40,6 +40,7 @@ SavHGSS::SavHGSS(u8* dt)
     SBOOffset = 0x21A00;
     GBO();
     SBO();
+    initBlocks();
 
     Trainer1 = 0x64 + gbo;
     Party = 0x98 + gbo;
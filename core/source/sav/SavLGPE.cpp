@@ -26,8 +26,8 @@
 
 #include "SavLGPE.hpp"
 #include "PB7.hpp"
-#include "gui.hpp"
 #include "WB7.hpp"
+#include "crc.hpp"
 #include "random.hpp"
 
 SavLGPE::SavLGPE(u8* dt)
@@ -38,6 +38,8 @@ SavLGPE::SavLGPE(u8* dt)
 
     data = new u8[length]{0};
     std::copy(dt, dt + 0xB8800, data);
+
+    trackBlocks(chkofs, chklen, 21);
 }
 
 SavLGPE::~SavLGPE() {}
@@ -55,6 +57,7 @@ u16 SavLGPE::partyBoxSlot(u8 slot) const
 void SavLGPE::partyBoxSlot(u8 slot, u16 v)
 {
     *(u16*)(data + 0x5A00 + slot * 2) = v;
+    markDirty(0x5A00 + slot * 2, 2);
 }
 
 u32 SavLGPE::partyOffset(u8 slot) const
@@ -75,6 +78,7 @@ u16 SavLGPE::boxedPkm() const
 void SavLGPE::boxedPkm(u16 v)
 {
     *(u16*)(data + 0x5A00 + 14) = v;
+    markDirty(0x5A00 + 14, 2);
 }
 
 u16 SavLGPE::followPkm() const
@@ -85,6 +89,7 @@ u16 SavLGPE::followPkm() const
 void SavLGPE::followPkm(u16 v)
 {
     *(u16*)(data + 0x5A00 + 12) = v;
+    markDirty(0x5A00 + 12, 2);
 }
 
 u8 SavLGPE::partyCount() const
@@ -144,6 +149,8 @@ void SavLGPE::compressBox()
                 std::copy(data + emptyOffset, data + emptyOffset + 260, emptyData);
                 std::copy(data + offset, data + offset + 260, data + emptyOffset);
                 std::copy(emptyData, emptyData + 260, data + offset);
+                markDirty(emptyOffset, 260);
+                markDirty(offset, 260);
                 for (int j = 0; j < partyCount(); j++)
                 {
                     if (partyBoxSlot(j) == i)
@@ -161,29 +168,26 @@ void SavLGPE::compressBox()
     }
 }
 
-u16 SavLGPE::check16(u8* buf, u32 blockID, u32 len) const
+u16 SavLGPE::check16(const u8* buf, u32 blockID, u32 len) const
 {
-    u16 chk = 0;
-    for (u32 i = 0; i < len; i++)
-    {
-        chk = (crc16[(buf[i] ^ chk) & 0xFF] ^ chk >> 8);
-    }
-    return chk;
+    return CRC::crc16(buf, len);
 }
 
 void SavLGPE::resign()
 {
     const u8 blockCount = 21;
-    u8* tmp = new u8[*std::max_element(chklen, chklen + blockCount)];
     const u32 csoff = 0xB861A;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i*8) = check16(tmp, *(u16*)(data + csoff + i*8 - 2), chklen[i]);
+        if (!dirty(i))
+        {
+            continue;
+        }
+        *(u16*)(data + csoff + i*8) = check16(data + chkofs[i], *(u16*)(data + csoff + i*8 - 2), chklen[i]);
     }
 
-    delete[] tmp;
+    markClean();
 }
 
 u16 SavLGPE::TID() const
@@ -194,6 +198,7 @@ u16 SavLGPE::TID() const
 void SavLGPE::TID(u16 v)
 {
     *(u16*)(data + 0x1000) = v;
+    markDirty(0x1000, 2);
 }
 
 u16 SavLGPE::SID() const
@@ -204,6 +209,7 @@ u16 SavLGPE::SID() const
 void SavLGPE::SID(u16 v)
 {
     *(u16*)(data + 0x1002) = v;
+    markDirty(0x1002, 2);
 }
 
 u8 SavLGPE::version() const
@@ -214,6 +220,7 @@ u8 SavLGPE::version() const
 void SavLGPE::version(u8 v)
 {
     *(data + 0x1004) = v;
+    markDirty(0x1004, 1);
 }
 
 u8 SavLGPE::gender() const
@@ -224,6 +231,7 @@ u8 SavLGPE::gender() const
 void SavLGPE::gender(u8 v)
 {
     *(data + 0x1005) = v;
+    markDirty(0x1005, 1);
 }
 
 u8 SavLGPE::language() const
@@ -234,6 +242,7 @@ u8 SavLGPE::language() const
 void SavLGPE::language(u8 v)
 {
     *(data + 0x1035) = v;
+    markDirty(0x1035, 1);
 }
 
 std::string SavLGPE::otName() const
@@ -255,6 +264,7 @@ u32 SavLGPE::money() const
 void SavLGPE::money(u32 v)
 {
     *(u32*)(data + 0x4C04) = v;
+    markDirty(0x4C04, 4);
 }
 
 u8 SavLGPE::badges() const
@@ -283,6 +293,7 @@ u16 SavLGPE::playedHours(void) const
 void SavLGPE::playedHours(u16 v)
 {
     *(u16*)(data + 0x45400) = v;
+    markDirty(0x45400, 2);
 }
 
 u8 SavLGPE::playedMinutes(void) const
@@ -293,6 +304,7 @@ u8 SavLGPE::playedMinutes(void) const
 void SavLGPE::playedMinutes(u8 v)
 {
     *(data + 0x45402) = v;
+    markDirty(0x45402, 1);
 }
 
 u8 SavLGPE::playedSeconds(void) const
@@ -303,6 +315,7 @@ u8 SavLGPE::playedSeconds(void) const
 void SavLGPE::playedSeconds(u8 v)
 {
     *(data + 0x45403) = v;
+    markDirty(0x45403, 1);
 }
     
 std::shared_ptr<PKX> SavLGPE::pkm(u8 slot) const
@@ -310,7 +323,7 @@ std::shared_ptr<PKX> SavLGPE::pkm(u8 slot) const
     u32 off = partyOffset(slot);
     if (off != 0)
     {
-        return std::make_shared<PB7>(data + off);
+        return PKXPool::make<PB7>(data + off);
     }
     else
     {
@@ -320,7 +333,7 @@ std::shared_ptr<PKX> SavLGPE::pkm(u8 slot) const
 
 std::shared_ptr<PKX> SavLGPE::pkm(u8 box, u8 slot, bool ekx) const
 {
-    return std::make_shared<PB7>(data + boxOffset(box, slot), ekx);
+    return PKXPool::make<PB7>(data + boxOffset(box, slot), ekx);
 }
 
 void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
@@ -330,6 +343,7 @@ void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 box, u8 slot, bool applyTrade)
         trade(pk);
     }
     std::copy(pk->rawData(), pk->rawData() + pk->getLength(), data + boxOffset(box, slot));
+    markDirty(boxOffset(box, slot), pk->getLength());
 }
 
 void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 slot)
@@ -341,6 +355,7 @@ void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 slot)
         if (off != 0)
         {
             std::fill_n(data + off, 260, 0);
+            markDirty(off, 260);
         }
         partyBoxSlot(slot, 1001);
         return;
@@ -364,6 +379,7 @@ void SavLGPE::pkm(std::shared_ptr<PKX> pk, u8 slot)
     }
 
     std::copy(pk->rawData(), pk->rawData() + pk->getLength(), data + off);
+    markDirty(off, pk->getLength());
     partyBoxSlot(slot, newSlot);
 }
 
@@ -510,6 +526,8 @@ void SavLGPE::dex(std::shared_ptr<PKX> pk)
     if (n == 351)
         shiny = 0;
     int shift = gender | (shiny << 1);
+    // owned, seen and displayed flags, up to the Spinda spot data
+    markDirty(PokeDex, 0x8E8 + 4*4);
     
     if (n == 327) // Spinda
     {
@@ -562,7 +580,10 @@ void SavLGPE::dex(std::shared_ptr<PKX> pk)
         if (lang < 0) lang = 1;
         int lbit = bit * langCount + lang;
         if (lbit >> 3 < 920)
+        {
             data[PokeDexLanguageFlags + (lbit >> 3)] |= (u8)(1 << (lbit & 7));
+            markDirty(PokeDexLanguageFlags + (lbit >> 3), 1);
+        }
     }
 }
 
@@ -597,26 +618,6 @@ int SavLGPE::dexCaught(void) const
     return ret;
 }
 
-void SavLGPE::cryptBoxData(bool crypted)
-{
-    for (u8 box = 0; box < maxBoxes(); box++)
-    {
-        for (u8 slot = 0; slot < 30; slot++)
-        {
-            if (box * 30 + slot > 1000)
-            {
-                return;
-            }
-            auto pb7 = pkm(box, slot, crypted);
-            if (!crypted)
-            {
-                pb7->encrypt();
-            }
-            pkm(pb7, box, slot, false);
-        }
-    }
-}
-
 void SavLGPE::mysteryGift(WCX& wc, int& pos)
 {
     WB7* wb7 = (WB7*)&wc;
@@ -627,7 +628,7 @@ void SavLGPE::mysteryGift(WCX& wc, int& pos)
             // Gui::warn(i18n::localize("LGPE_TOO_MANY_PKM"), i18n::localize("BAD_INJECT"));
             return;
         }
-        std::shared_ptr<PB7> pkm = std::make_shared<PB7>();
+        std::shared_ptr<PB7> pkm = PKXPool::make<PB7>();
         pkm->species(wb7->species());
         pkm->alternativeForm(wb7->alternativeForm());
         if (wb7->level() > 0)
@@ -990,6 +991,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 60)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + slot * 4);
+                markDirty(slot * 4, writeData.second);
             }
             else
             {
@@ -1000,6 +1002,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 108)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0xF0 + slot * 4);
+                markDirty(0xF0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1010,6 +1013,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 200)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x2A0 + slot * 4);
+                markDirty(0x2A0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1020,6 +1024,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 150)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x5C0 + slot * 4);
+                markDirty(0x5C0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1030,6 +1035,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 50)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x818 + slot * 4);
+                markDirty(0x818 + slot * 4, writeData.second);
             }
             else
             {
@@ -1040,6 +1046,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 150)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0x8E0 + slot * 4);
+                markDirty(0x8E0 + slot * 4, writeData.second);
             }
             else
             {
@@ -1051,6 +1058,7 @@ void SavLGPE::item(Item& item, Pouch pouch, u16 slot)
             if (slot < 150)
             {
                 std::copy(writeData.first, writeData.first + writeData.second, data + 0xB38 + slot * 4);
+                markDirty(0xB38 + slot * 4, writeData.second);
             }
             else
             {
@@ -52,21 +52,25 @@ SavORAS::SavORAS(u8* dt)
     PouchTMHM = 0xBC0;
     PouchMedicine = 0xD70;
     PouchBerry = 0xE70;
+
+    trackBlocks(chkofs, chklen, 58);
 }
 
 void SavORAS::resign(void)
 {
     const u8 blockCount = 58;
-    u8* tmp = new u8[*std::max_element(chklen, chklen + blockCount)];
     const u32 csoff = 0x75E1A;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i*8) =  ccitt16(tmp, chklen[i]);
+        if (!dirty(i))
+        {
+            continue;
+        }
+        *(u16*)(data + csoff + i*8) =  ccitt16(data + chkofs[i], chklen[i]);
     }
 
-    delete[] tmp;
+    markClean();
 }
 
 std::map<Pouch, std::vector<int>> SavORAS::validItems() const
@@ -40,6 +40,7 @@ SavPT::SavPT(u8* dt)
     SBOOffset = 0x1F100;
     GBO();
     SBO();
+    initBlocks();
 
     Trainer1 = 0x68 + gbo;
     Party = 0xA0 + gbo;
@@ -52,41 +52,43 @@ SavSUMO::SavSUMO(u8* dt)
     PouchMedicine = 0xB48;
     PouchBerry = 0xC48;
     PouchZCrystals = 0xD68;
+
+    trackBlocks(chkofs, chklen, 37);
 }
 
 void SavSUMO::resign(void)
 {
+    if (!dirty())
+    {
+        return;
+    }
+
     const u8 blockCount = 37;
-    u8* tmp = new u8[*std::max_element(chklen, chklen + blockCount)];
     const u32 csoff = 0x6BC1A;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i*8) = check16(tmp, *(u16*)(data + csoff + i*8 - 2), chklen[i]);
+        if (!dirty(i))
+        {
+            continue;
+        }
+        *(u16*)(data + csoff + i*8) = check16(data + chkofs[i], *(u16*)(data + csoff + i*8 - 2), chklen[i]);
     }
 
-    delete[] tmp;
-
     const u32 checksumTableOffset = 0x6BC00;
     const u32 checksumTableLength = 0x140;
     const u32 memecryptoOffset = 0x6BB00;
 
-    u8 currentSignature[0x80];
-    std::copy(data + memecryptoOffset, data + memecryptoOffset + 0x80, currentSignature);
-
-    u8 checksumTable[checksumTableLength];
-    std::copy(data + checksumTableOffset, data + checksumTableOffset + checksumTableLength, checksumTable);
-
     u8 hash[SHA256_BLOCK_SIZE];
-    sha256(hash, checksumTable, checksumTableLength);
+    sha256(hash, data + checksumTableOffset, checksumTableLength);
 
     u8 decryptedSignature[0x80];
-    reverseCrypt(currentSignature, decryptedSignature);
+    reverseCrypt(data + memecryptoOffset, decryptedSignature);
     std::copy(hash, hash + SHA256_BLOCK_SIZE, decryptedSignature);
 
-    memecrypto_sign(decryptedSignature, currentSignature, 0x80);
-    std::copy(currentSignature, currentSignature + 0x80, data + memecryptoOffset);
+    memecrypto_sign(decryptedSignature, data + memecryptoOffset, 0x80);
+
+    markClean();
 }
 
 int SavSUMO::dexFormIndex(int species, int formct, int start) const
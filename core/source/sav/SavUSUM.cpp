@@ -53,41 +53,43 @@ SavUSUM::SavUSUM(u8* dt)
     PouchBerry = 0xC64;
     PouchZCrystals = 0xD70;
     BattleItems = 0xDFC;
+
+    trackBlocks(chkofs, chklen, 39);
 }
 
 void SavUSUM::resign(void)
 {
+    if (!dirty())
+    {
+        return;
+    }
+
     const u8 blockCount = 39;
-    u8* tmp = new u8[*std::max_element(chklen, chklen + blockCount)];
     const u32 csoff = 0x6CA1A;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i*8) = check16(tmp, *(u16*)(data + csoff + i*8 - 2), chklen[i]);
+        if (!dirty(i))
+        {
+            continue;
+        }
+        *(u16*)(data + csoff + i*8) = check16(data + chkofs[i], *(u16*)(data + csoff + i*8 - 2), chklen[i]);
     }
 
-    delete[] tmp;
-
     const u32 checksumTableOffset = 0x6CA00;
     const u32 checksumTableLength = 0x150;
     const u32 memecryptoOffset = 0x6C100;
 
-    u8 currentSignature[0x80];
-    std::copy(data + memecryptoOffset, data + memecryptoOffset + 0x80, currentSignature);
-
-    u8 checksumTable[checksumTableLength];
-    std::copy(data + checksumTableOffset, data + checksumTableOffset + checksumTableLength, checksumTable);
-
     u8 hash[SHA256_BLOCK_SIZE];
-    sha256(hash, checksumTable, checksumTableLength);
+    sha256(hash, data + checksumTableOffset, checksumTableLength);
 
     u8 decryptedSignature[0x80];
-    reverseCrypt(currentSignature, decryptedSignature);
+    reverseCrypt(data + memecryptoOffset, decryptedSignature);
     std::copy(hash, hash + SHA256_BLOCK_SIZE, decryptedSignature);
 
-    memecrypto_sign(decryptedSignature, currentSignature, 0x80);
-    std::copy(currentSignature, currentSignature + 0x80, data + memecryptoOffset);
+    memecrypto_sign(decryptedSignature, data + memecryptoOffset, 0x80);
+
+    markClean();
 }
 
 int SavUSUM::dexFormIndex(int species, int formct, int start) const
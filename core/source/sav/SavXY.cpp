@@ -52,21 +52,25 @@ SavXY::SavXY(u8* dt)
     PouchTMHM = 0xBC0;
     PouchMedicine = 0xD68;
     PouchBerry = 0xE68;
+
+    trackBlocks(chkofs, chklen, 55);
 }
 
 void SavXY::resign(void)
 {
     static constexpr u8 blockCount = 55;
-    u8* tmp = new u8[*std::max_element(chklen, chklen + blockCount)];
     static constexpr u32 csoff = 0x6541A;
 
     for (u8 i = 0; i < blockCount; i++)
     {
-        std::copy(data + chkofs[i], data + chkofs[i] + chklen[i], tmp);
-        *(u16*)(data + csoff + i*8) = ccitt16(tmp, chklen[i]);
+        if (!dirty(i))
+        {
+            continue;
+        }
+        *(u16*)(data + csoff + i*8) = ccitt16(data + chkofs[i], chklen[i]);
     }
 
-    delete[] tmp;
+    markClean();
 }
 
 std::map<Pouch, std::vector<int>> SavXY::validItems() const
@@ -0,0 +1,150 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+
+#include "crc.hpp"
+#include <algorithm>
+
+namespace
+{
+    using Table = std::array<std::array<u16, 256>, CRC_SLICES>;
+
+    // tables[k][b] is the CRC contribution of byte b followed by k zero bytes
+    constexpr Table ccittTables()
+    {
+        Table ret{};
+        for (int i = 0; i < 256; i++)
+        {
+            u16 crc = i << 8;
+            for (int j = 0; j < 8; j++)
+            {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+            }
+            ret[0][i] = crc;
+        }
+        for (int k = 1; k < CRC_SLICES; k++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                ret[k][i] = (ret[k - 1][i] << 8) ^ ret[0][ret[k - 1][i] >> 8];
+            }
+        }
+        return ret;
+    }
+
+    constexpr Table arcTables()
+    {
+        Table ret{};
+        for (int i = 0; i < 256; i++)
+        {
+            u16 crc = i;
+            for (int j = 0; j < 8; j++)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+            }
+            ret[0][i] = crc;
+        }
+        for (int k = 1; k < CRC_SLICES; k++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                ret[k][i] = (ret[k - 1][i] >> 8) ^ ret[0][ret[k - 1][i] & 0xFF];
+            }
+        }
+        return ret;
+    }
+
+    constexpr Table ccitt = ccittTables();
+    constexpr Table arc = arcTables();
+}
+
+u16 CRC::ccitt16(const u8* buf, size_t len, u16 crc)
+{
+    for (; len >= CRC_SLICES; len -= CRC_SLICES, buf += CRC_SLICES)
+    {
+        u16 next = ccitt[CRC_SLICES - 1][buf[0] ^ (crc >> 8)];
+        if constexpr (CRC_SLICES > 1)
+        {
+            next ^= ccitt[CRC_SLICES - 2][buf[1] ^ (crc & 0xFF)];
+        }
+        else
+        {
+            next ^= crc << 8;
+        }
+        for (int i = 2; i < CRC_SLICES; i++)
+        {
+            next ^= ccitt[CRC_SLICES - 1 - i][buf[i]];
+        }
+        crc = next;
+    }
+    for (; len > 0; len--, buf++)
+    {
+        crc = (crc << 8) ^ ccitt[0][(crc >> 8) ^ *buf];
+    }
+    return crc;
+}
+
+u16 CRC::crc16(const u8* buf, size_t len, u16 crc)
+{
+    for (; len >= CRC_SLICES; len -= CRC_SLICES, buf += CRC_SLICES)
+    {
+        u16 next = arc[CRC_SLICES - 1][buf[0] ^ (crc & 0xFF)];
+        if constexpr (CRC_SLICES > 1)
+        {
+            next ^= arc[CRC_SLICES - 2][buf[1] ^ (crc >> 8)];
+        }
+        else
+        {
+            next ^= crc >> 8;
+        }
+        for (int i = 2; i < CRC_SLICES; i++)
+        {
+            next ^= arc[CRC_SLICES - 1 - i][buf[i]];
+        }
+        crc = next;
+    }
+    for (; len > 0; len--, buf++)
+    {
+        crc = (crc >> 8) ^ arc[0][(crc ^ *buf) & 0xFF];
+    }
+    return crc;
+}
+
+u16 CRC::crc16(const u8* buf, size_t len, u16 crc, size_t maskOfs, size_t maskLen)
+{
+    if (maskOfs >= len)
+    {
+        return crc16(buf, len, crc);
+    }
+    maskLen = std::min(maskLen, len - maskOfs);
+
+    crc = crc16(buf, maskOfs, crc);
+    for (size_t i = 0; i < maskLen; i++)
+    {
+        crc = (crc >> 8) ^ arc[0][crc & 0xFF];
+    }
+    return crc16(buf + maskOfs + maskLen, len - maskOfs - maskLen, crc);
+}
@@ -0,0 +1,183 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.hpp"
+#include "BackupStore.hpp"
+#include "STDirectory.hpp"
+#include "random.hpp"
+
+namespace
+{
+    size_t chunkCount(const std::string& root)
+    {
+        size_t count = 0;
+        STDirectory shards(root + "/chunks");
+        for (size_t i = 0; i < shards.count(); i++)
+        {
+            if (shards.folder(i) && shards.item(i)[0] != '.')
+            {
+                STDirectory chunks(root + "/chunks/" + shards.item(i));
+                for (size_t j = 0; j < chunks.count(); j++)
+                {
+                    count += !chunks.folder(j);
+                }
+            }
+        }
+        return count;
+    }
+
+    // Small edits scattered the way a session of box changes scatters them
+    void edit(std::vector<u8>& data)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            data[randomNumbers() % data.size()] ^= 0x5A;
+        }
+    }
+}
+
+void Bench::backup(void)
+{
+    char dir[] = "/tmp/pksmbench.XXXXXX";
+    if (!mkdtemp(dir))
+    {
+        fail("backup: could not create a scratch directory\n");
+        return;
+    }
+    std::string root = std::string(dir) + "/store";
+    BackupStore store(root);
+
+    // Noise the size of a Gen 7 save, so no two chunks match and the last one is short
+    std::vector<u8> first(0x6CC00);
+    for (auto& v : first)
+    {
+        v = randomNumbers();
+    }
+    std::vector<u8> second = first;
+    second[0x1234] ^= 1;
+    second[0x50000] ^= 1;
+    if (!store.backup("sm", "1", first.data(), first.size()) || !store.backup("sm", "2", second.data(), second.size()))
+    {
+        fail("backup: could not store snapshots\n");
+    }
+    size_t firstChunks = (first.size() + BackupStore::CHUNK_SIZE - 1) / BackupStore::CHUNK_SIZE;
+    if (chunkCount(root) != firstChunks + 2)
+    {
+        fail("backup: second snapshot stored unchanged chunks again\n");
+    }
+    std::vector<u8> restored;
+    if (!store.restore("sm", "1", restored) || restored != first || !store.restore("sm", "2", restored) || restored != second)
+    {
+        fail("backup: snapshot does not restore what was backed up\n");
+    }
+    if (store.snapshots("sm") != std::vector<std::string>{ "1", "2" })
+    {
+        fail("backup: snapshots are not listed in order\n");
+    }
+
+    // Dropping a snapshot frees only the chunks nothing else uses
+    size_t before = chunkCount(root);
+    store.remove("sm", "1");
+    if (store.collectGarbage() != 2 || chunkCount(root) != before - 2 || !store.restore("sm", "2", restored) || restored != second)
+    {
+        fail("backup: garbage collection removed the wrong chunks\n");
+    }
+
+    // Damage is caught rather than restored
+    std::string manifest = store.snapshotPath("sm", "2");
+    std::vector<u8> damaged = second;
+    damaged[0x2000] ^= 1;
+    store.backup("sm", "3", damaged.data(), damaged.size());
+    STDirectory shards(root + "/chunks");
+    for (size_t i = 0; i < shards.count(); i++)
+    {
+        if (shards.folder(i) && shards.item(i)[0] != '.')
+        {
+            STDirectory chunks(root + "/chunks/" + shards.item(i));
+            for (size_t j = 0; j < chunks.count(); j++)
+            {
+                if (!chunks.folder(j))
+                {
+                    FILE* chunk = fopen((root + "/chunks/" + shards.item(i) + "/" + chunks.item(j)).c_str(), "r+b");
+                    fputc(0, chunk);
+                    fclose(chunk);
+                }
+            }
+        }
+    }
+    if (store.restore("sm", "3", restored))
+    {
+        fail("backup: restored from damaged chunks\n");
+    }
+    store.remove("sm", "2");
+    store.remove("sm", "3");
+    store.collectGarbage();
+
+    // Ten sessions' worth of auto-backups of a real save, stored whole and as snapshots
+    std::vector<u8> session = saveImage(Game::SM);
+    size_t snapshotBytes = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        edit(session);
+        size_t chunksBefore = chunkCount(root);
+        store.backup("sm", std::to_string(i), session.data(), session.size());
+        snapshotBytes += (chunkCount(root) - chunksBefore) * BackupStore::CHUNK_SIZE;
+    }
+    report("backup/stored-kib/full-copies", 10 * session.size() / 1024.0, "KiB");
+    report("backup/stored-kib/snapshots", snapshotBytes / 1024.0, "KiB");
+
+    // Keeping only the newest few drops the others, and collecting then frees their chunks
+    size_t chunksBefore = chunkCount(root);
+    bool pruned = store.prune("sm", 3) == 7 && store.snapshots("sm") == std::vector<std::string>{ "7", "8", "9" };
+    pruned = pruned && store.collectGarbage() > 0 && chunkCount(root) < chunksBefore && store.restore("sm", "9", restored) && restored == session;
+    if (!pruned)
+    {
+        fail("backup: pruning kept the wrong snapshots\n");
+    }
+
+    std::string copyPath = std::string(dir) + "/copy.sav";
+    int snapshot = 10;
+    measure("backup/save/full-copy", 50, [&]() {
+        FILE* out = fopen(copyPath.c_str(), "wb");
+        fwrite(session.data(), 1, session.size(), out);
+        fclose(out);
+    }, [&]() { edit(session); });
+    measure("backup/save/snapshot", 50, [&]() { store.backup("sm", std::to_string(snapshot++), session.data(), session.size()); }, [&]() { edit(session); });
+
+    for (auto& name : store.snapshots("sm"))
+    {
+        store.remove("sm", name);
+    }
+    store.collectGarbage();
+    remove(copyPath.c_str());
+    std::string cleanup = "rm -r " + std::string(dir);
+    if (system(cleanup.c_str()) != 0)
+    {
+        fail("backup: could not remove %s\n", dir);
+    }
+}
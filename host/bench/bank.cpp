@@ -0,0 +1,739 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <stdlib.h>
+#include <tuple>
+#include <unistd.h>
+#include "bench.hpp"
+#include "json.hpp"
+#include "BankBoxStore.hpp"
+#include "BankChangeTracker.hpp"
+#include "BankIndex.hpp"
+#include "BankJournal.hpp"
+#include "BankPager.hpp"
+#include "GlobalBankIndex.hpp"
+#include "BlockCompression.hpp"
+#include "PB7.hpp"
+#include "PK4.hpp"
+#include "PK5.hpp"
+#include "PK6.hpp"
+#include "PK7.hpp"
+#include "StdioBankFile.hpp"
+#include "random.hpp"
+
+namespace
+{
+    constexpr int bankBoxes = 100;
+    constexpr size_t bankSlots = bankBoxes * 30;
+
+    // Forces the pager onto its read path, as on the console
+    class UnmappedBankFile : public StdioBankFile
+    {
+    public:
+        const u8* map(const std::string& path, u32 size) override { return nullptr; }
+    };
+
+    std::shared_ptr<PKX> emptyPkm(Generation gen)
+    {
+        switch (gen)
+        {
+            case Generation::FOUR:
+                return std::make_shared<PK4>();
+            case Generation::FIVE:
+                return std::make_shared<PK5>();
+            case Generation::SIX:
+                return std::make_shared<PK6>();
+            case Generation::LGPE:
+                return std::make_shared<PB7>();
+            default:
+                return std::make_shared<PK7>();
+        }
+    }
+
+    // Highest national dex number each format's personal table covers
+    u16 maxSpecies(Generation gen)
+    {
+        switch (gen)
+        {
+            case Generation::FOUR:
+                return 493;
+            case Generation::FIVE:
+                return 649;
+            default:
+                return 721;
+        }
+    }
+}
+
+std::vector<Bench::BankEntry> Bench::bankEntries(size_t slots)
+{
+    static constexpr Generation gens[] = { Generation::FOUR, Generation::FIVE, Generation::SIX, Generation::SEVEN, Generation::LGPE };
+    std::vector<BankEntry> entries(slots);
+    for (auto& entry : entries)
+    {
+        std::fill_n((u8*)&entry, sizeof(BankEntry), 0xFF);
+        // leave roughly a quarter of the slots empty, like a bank in use
+        if (randomNumbers() % 4 == 0)
+        {
+            continue;
+        }
+        Generation gen = gens[randomNumbers() % 5];
+        std::shared_ptr<PKX> pk = emptyPkm(gen);
+        pk->encryptionConstant(randomNumbers());
+        pk->PID(randomNumbers());
+        pk->species(randomNumbers() % maxSpecies(gen) + 1);
+        pk->TID(randomNumbers());
+        pk->SID(randomNumbers());
+        pk->experience(randomNumbers() % 1000000);
+        pk->nature(randomNumbers() % 25);
+        pk->ball(randomNumbers() % 26 + 1);
+        pk->heldItem(randomNumbers() % 2 ? 0 : randomNumbers() % 600);
+        for (int stat = 0; stat < 6; stat++)
+        {
+            pk->iv(stat, randomNumbers() % 32);
+        }
+        entry.gen = pk->generation();
+        std::copy(pk->rawData(), pk->rawData() + pk->getLength(), entry.data);
+    }
+    return entries;
+}
+
+// What Bank::pkm does for a slot, minus the party size detection
+std::shared_ptr<PKX> Bench::bankPkm(BankEntry& entry)
+{
+    switch (entry.gen)
+    {
+        case Generation::FOUR:
+            return std::make_shared<PK4>(entry.data);
+        case Generation::FIVE:
+            return std::make_shared<PK5>(entry.data);
+        case Generation::SIX:
+            return std::make_shared<PK6>(entry.data);
+        case Generation::SEVEN:
+            return std::make_shared<PK7>(entry.data);
+        case Generation::LGPE:
+            return std::make_shared<PB7>(entry.data);
+        default:
+            return std::make_shared<PK7>();
+    }
+}
+
+void Bench::bank(void)
+{
+    std::vector<BankEntry> entries = bankEntries(bankSlots);
+    BankIndex index;
+    auto buildIndex = [&]() {
+        index.resize(bankSlots);
+        for (size_t i = 0; i < bankSlots; i++)
+        {
+            index.set(i, *bankPkm(entries[i]));
+        }
+    };
+    buildIndex();
+
+    // A filter a user might run: high-IV, Gen 6+ Pokémon in a level band
+    const std::vector<BankIndex::Filter> filters = {
+        { BankIndex::Column::IV_TOTAL, 150, 186 },
+        { BankIndex::Column::GENERATION, (u32)Generation::SIX, (u32)Generation::LGPE },
+        { BankIndex::Column::LEVEL, 30, 80 }
+    };
+    auto linearSearch = [&]() {
+        std::vector<u32> ret;
+        for (size_t i = 0; i < bankSlots; i++)
+        {
+            std::shared_ptr<PKX> pk = bankPkm(entries[i]);
+            if (pk->species() == 0)
+            {
+                continue;
+            }
+            int ivTotal = 0;
+            for (int stat = 0; stat < 6; stat++)
+            {
+                ivTotal += pk->iv(stat);
+            }
+            if (ivTotal >= 150 && pk->generation() >= Generation::SIX && pk->level() >= 30 && pk->level() <= 80)
+            {
+                ret.push_back(i);
+            }
+        }
+        return ret;
+    };
+
+    std::vector<u32> expected = linearSearch();
+    if (index.query(filters) != expected)
+    {
+        fail("bank: index query differs from a scan over PKX objects\n");
+    }
+    std::vector<u32> bySpecies = index.query(filters, BankIndex::Column::SPECIES, true);
+    if (bySpecies.size() != expected.size() || !std::is_sorted(bySpecies.begin(), bySpecies.end(), [&](u32 a, u32 b) {
+            return index.value(BankIndex::Column::SPECIES, b) < index.value(BankIndex::Column::SPECIES, a);
+        }))
+    {
+        fail("bank: ordered index query is not ordered on its column\n");
+    }
+
+    // Writing a slot must be reflected in the next query
+    std::shared_ptr<PKX> edited = bankPkm(entries[expected.front()]);
+    edited->level(5);
+    edited->otName("Searcher");
+    std::copy(edited->rawData(), edited->rawData() + edited->getLength(), entries[expected.front()].data);
+    index.set(expected.front(), *edited);
+    if (index.query(filters) != linearSearch())
+    {
+        fail("bank: index query is stale after a slot update\n");
+    }
+    u32 searcher = index.otNameId("Searcher");
+    if (index.query({ { BankIndex::Column::OT_NAME, searcher, searcher } }) != std::vector<u32>{ expected.front() } ||
+        !index.query({ { BankIndex::Column::OT_NAME, index.otNameId("Nobody"), index.otNameId("Nobody") } }).empty())
+    {
+        fail("bank: OT name query does not find exactly the renamed slot\n");
+    }
+
+    // The same index built from the stored entries in place, one instantiation per generation
+    BankIndex viewIndex;
+    auto buildViewIndex = [&]() {
+        viewIndex.resize(bankSlots);
+        for (size_t i = 0; i < bankSlots; i++)
+        {
+            if (!visitPKX(entries[i].gen, entries[i].data, [&](const auto& pkm) { viewIndex.set(i, pkm); return true; }))
+            {
+                viewIndex.clear(i);
+            }
+        }
+    };
+    buildViewIndex();
+    for (size_t i = 0; i < bankSlots; i++)
+    {
+        for (u8 column = 0; column <= (u8)BankIndex::Column::OT_NAME; column++)
+        {
+            if (index.value((BankIndex::Column)column, i) != viewIndex.value((BankIndex::Column)column, i))
+            {
+                fail("bank: index built from views differs in column %d of slot %zu\n", column, i);
+                i = bankSlots;
+                break;
+            }
+        }
+    }
+
+    volatile size_t found;
+    measure("bank/index/build", 10, buildIndex);
+    measure("bank/index/build-view", 10, buildViewIndex);
+    measure("bank/search/pkx", 10, [&]() { found = linearSearch().size(); });
+    measure("bank/search/index", 200, [&]() { found = index.query(filters).size(); });
+    measure("bank/search/index-ordered", 200, [&]() { found = index.query(filters, BankIndex::Column::SPECIES).size(); });
+    (void)found;
+
+    // Box names as drawn every frame: a lookup in the JSON array against a held string
+    nlohmann::json jsonNames = nlohmann::json::array();
+    std::vector<std::string> names;
+    for (int box = 0; box < bankBoxes; box++)
+    {
+        jsonNames[box] = "Storage " + std::to_string(box + 1);
+        names.push_back(jsonNames[box].get<std::string>());
+    }
+    if (nlohmann::json(names).dump(2) != jsonNames.dump(2))
+    {
+        fail("bank: box names do not serialise as they did in JSON\n");
+    }
+    volatile size_t nameLength;
+    measure("bank/box-name/json-all", 2000, [&]() {
+        for (int box = 0; box < bankBoxes; box++)
+        {
+            nameLength = jsonNames[box].get<std::string>().size();
+        }
+    });
+    measure("bank/box-name/vector-all", 2000, [&]() {
+        for (int box = 0; box < bankBoxes; box++)
+        {
+            nameLength = names[box].size();
+        }
+    });
+    (void)nameLength;
+
+    // Change detection: a write is a change until it is reverted
+    u8* raw = (u8*)entries.data();
+    BankChangeTracker changes;
+    changes.reset(raw, sizeof(BankEntry) * 30, bankBoxes);
+    BankEntry original = entries[42 * 30 + 7];
+    entries[42 * 30 + 7].data[0x10] ^= 1;
+    changes.markDirty(42);
+    if (!changes.changed(raw))
+    {
+        fail("bank: change tracker missed a write\n");
+    }
+    entries[42 * 30 + 7] = original;
+    if (changes.changed(raw))
+    {
+        fail("bank: change tracker reports a reverted write\n");
+    }
+    // Growing the bank grows its data along with the tracker
+    std::vector<BankEntry> larger(entries);
+    larger.resize(entries.size() + 30);
+    changes.resize(bankBoxes + 1);
+    if (!changes.changed((u8*)larger.data()))
+    {
+        fail("bank: change tracker ignores boxes added by resizing\n");
+    }
+    // Hashing boxes only as they are first read gives the same answers
+    changes.reset(sizeof(BankEntry) * 30, bankBoxes);
+    changes.loaded(raw + 42 * 30 * sizeof(BankEntry), 42);
+    entries[42 * 30 + 7].data[0x10] ^= 1;
+    changes.loaded(raw + 42 * 30 * sizeof(BankEntry), 42);
+    changes.markDirty(42);
+    bool lazy = changes.changedBoxes(raw) == std::vector<int>{ 42 };
+    entries[42 * 30 + 7] = original;
+    changes.markDirty(42);
+    if (!lazy || changes.changed(raw))
+    {
+        fail("bank: change tracker hashing on load differs from hashing up front\n");
+    }
+    changes.reset(raw, sizeof(BankEntry) * 30, bankBoxes);
+
+    volatile bool changed;
+    measure("bank/hasChanged/full-hash", 20, [&]() {
+        u8 hash[SHA256_BLOCK_SIZE];
+        sha256(hash, raw, sizeof(BankEntry) * bankSlots);
+        changed = hash[0] == 0;
+    });
+    measure("bank/hasChanged/one-box", 2000, [&]() { changed = changes.changed(raw); }, [&]() { changes.markDirty(42); });
+    (void)changed;
+
+    // Persistence, against files in a scratch directory. The image is a 16 byte
+    // header followed by the boxes, as Bank lays it out
+    char dir[] = "/tmp/pksmbench.XXXXXX";
+    if (!mkdtemp(dir))
+    {
+        fail("bank: could not create a scratch directory\n");
+        return;
+    }
+    StdioBankFile file;
+    std::string bankPath = std::string(dir) + "/bench.bnk";
+    std::vector<u8> image(16 + sizeof(BankEntry) * bankSlots, 0);
+    std::copy(raw, raw + sizeof(BankEntry) * bankSlots, image.begin() + 16);
+    const u32 boxSize = sizeof(BankEntry) * 30;
+    auto boxRange = [&](int box) { return BankJournal::Range(16 + box * boxSize, boxSize); };
+    auto onDisk = [&]() {
+        std::vector<u8> ret;
+        file.read(bankPath, ret);
+        return ret;
+    };
+
+    if (!BankJournal(file, bankPath).commit(image.data(), image.size(), { { 0, image.size() } }) || onDisk() != image)
+    {
+        fail("bank: full commit did not write the image\n");
+    }
+    image[16 + 42 * boxSize + 20] ^= 1;
+    image[16 + 7 * boxSize + 300] ^= 1;
+    if (!BankJournal(file, bankPath).commit(image.data(), image.size(), { boxRange(7), boxRange(42) }) || onDisk() != image)
+    {
+        fail("bank: partial commit did not write the changed boxes\n");
+    }
+
+    // Interrupted after the record: the bank is untouched until recovery replays it
+    std::vector<u8> before = image;
+    image[16 + 3 * boxSize] ^= 1;
+    BankJournal(file, bankPath).prepare(image.data(), image.size(), { boxRange(3) });
+    if (onDisk() != before)
+    {
+        fail("bank: preparing a commit touched the bank\n");
+    }
+    if (!BankJournal(file, bankPath).recover() || onDisk() != image)
+    {
+        fail("bank: recovery did not replay a complete record\n");
+    }
+
+    // Interrupted while writing the record: recovery throws it away
+    before = image;
+    image[16 + 5 * boxSize] ^= 1;
+    BankJournal(file, bankPath).prepare(image.data(), image.size(), { boxRange(5) });
+    std::vector<u8> record;
+    file.read(bankPath + ".journal", record);
+    file.resize(bankPath + ".journal", record.size() - 10);
+    if (!BankJournal(file, bankPath).recover() || onDisk() != before || file.read(bankPath + ".journal", record))
+    {
+        fail("bank: recovery applied or kept a torn record\n");
+    }
+    image = before;
+
+    // A record larger than a batch spills into part files, which recovery replays and removes
+    image[16 + 3 * boxSize] ^= 1;
+    image.back() ^= 1;
+    BankJournal(file, bankPath).prepare(image.data(), image.size(), { { 0, image.size() } });
+    if (onDisk() != before || !file.read(bankPath + ".journal.1", record))
+    {
+        fail("bank: a large record was not split into parts\n");
+    }
+    if (!BankJournal(file, bankPath).recover() || onDisk() != image || file.read(bankPath + ".journal.0", record))
+    {
+        fail("bank: recovery did not replay and remove a record's parts\n");
+    }
+
+    // A part that does not match its record is never replayed
+    before = image;
+    image[16 + 3 * boxSize] ^= 1;
+    BankJournal(file, bankPath).prepare(image.data(), image.size(), { { 0, image.size() } });
+    u8 damaged;
+    file.read(bankPath + ".journal.0", 20, &damaged, 1);
+    damaged ^= 1;
+    file.write(bankPath + ".journal.0", 20, &damaged, 1);
+    if (BankJournal(file, bankPath).recover() || onDisk() != before)
+    {
+        fail("bank: recovery replayed a damaged part\n");
+    }
+    BankJournal(file, bankPath).begin();
+    image = before;
+
+    // Shrinking only needs the header, growing only the new boxes
+    u32 shrunk = 16 + (bankBoxes - 10) * boxSize;
+    if (!BankJournal(file, bankPath).commit(image.data(), shrunk, { { 0, 16 } }) || onDisk() != std::vector<u8>(image.begin(), image.begin() + shrunk))
+    {
+        fail("bank: commit did not shrink the bank\n");
+    }
+    std::vector<BankJournal::Range> grown = { { 0, 16 } };
+    for (int box = bankBoxes - 10; box < bankBoxes; box++)
+    {
+        grown.push_back(boxRange(box));
+    }
+    if (!BankJournal(file, bankPath).commit(image.data(), image.size(), grown) || onDisk() != image)
+    {
+        fail("bank: commit did not grow the bank\n");
+    }
+
+    measure("bank/save/full-rewrite", 20, [&]() {
+        file.remove(bankPath);
+        file.write(bankPath, 0, image.data(), image.size());
+    });
+    measure("bank/save/one-box", 200, [&]() { BankJournal(file, bankPath).commit(image.data(), image.size(), { boxRange(42) }); });
+
+    // Paging: boxes come from the file on demand, and edits stay resident until reopened
+    UnmappedBankFile unmapped;
+    auto matchesImage = [&](BankPager& pager) {
+        for (int box = 0; box < bankBoxes; box++)
+        {
+            if (!std::equal(image.begin() + 16 + box * boxSize, image.begin() + 16 + (box + 1) * boxSize, pager.box(box)))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    BankPager pager(boxSize, 8);
+    pager.open(unmapped, bankPath, 16, bankBoxes);
+    if (!matchesImage(pager) || pager.resident() > 8 || pager.stats().misses != bankBoxes)
+    {
+        fail("bank: pager does not page boxes in within its budget\n");
+    }
+    for (int box = 0; box < 20; box++)
+    {
+        pager.edit(box)[0] = 0x5A;
+    }
+    bool kept = matchesImage(pager) == false && pager.resident() >= 20;
+    for (int box = 0; box < 20; box++)
+    {
+        kept = kept && pager.box(box)[0] == 0x5A;
+    }
+    if (!kept)
+    {
+        fail("bank: pager evicted an edited box\n");
+    }
+    for (int box = 0; box < 20; box++)
+    {
+        pager.saved(box);
+    }
+    if (pager.resident() > 8)
+    {
+        fail("bank: pager kept saved boxes past its budget\n");
+    }
+    pager.resize(bankBoxes + 1);
+    if (std::any_of(pager.box(bankBoxes), pager.box(bankBoxes) + boxSize, [](u8 v) { return v != 0xFF; }))
+    {
+        fail("bank: pager did not add an empty box\n");
+    }
+    pager.open(unmapped, bankPath, 16, bankBoxes);
+    if (!matchesImage(pager))
+    {
+        fail("bank: reopening the pager kept discarded edits\n");
+    }
+    BankPager failing(boxSize, 8);
+    failing.open(
+        [](int box, u8* out) {
+            std::fill_n(out, boxSize, 0);
+            return box != 3;
+        },
+        8);
+    std::vector<int> observed;
+    failing.observe([&](int box, const u8*) { observed.push_back(box); });
+    failing.box(3);
+    failing.box(4);
+    failing.box(4);
+    if (failing.readable(3) || !failing.readable(4) || failing.stats().failures != 1 || observed != std::vector<int>{ 4 })
+    {
+        fail("bank: pager does not report a box it could not read\n");
+    }
+    BankPager mapped(boxSize, 8);
+    mapped.open(file, bankPath, 16, bankBoxes);
+    if (!matchesImage(mapped) || mapped.resident() != 0 || mapped.stats().mapped != bankBoxes)
+    {
+        fail("bank: mapped pager does not read through the mapping\n");
+    }
+
+    // Browsing: bursts of reads within a box, jumping between boxes
+    std::vector<int> visits(4096);
+    for (auto& box : visits)
+    {
+        box = randomNumbers() % 100 < 80 ? randomNumbers() % 8 : randomNumbers() % bankBoxes;
+    }
+    volatile u8 sink;
+    auto browse = [&](BankPager& pager) {
+        for (int box : visits)
+        {
+            for (int slot = 0; slot < 30; slot++)
+            {
+                sink = pager.box(box)[slot * sizeof(BankEntry) + 4];
+            }
+        }
+    };
+    pager.budget(bankBoxes);
+    browse(pager);
+    measure("bank/page/all-resident", 20, [&]() { browse(pager); });
+    pager.budget(8);
+    measure("bank/page/lru-8", 20, [&]() { browse(pager); });
+    measure("bank/page/mmap", 20, [&]() { browse(mapped); });
+    pager.close();
+    mapped.close();
+
+    // Compression: round trips of runs, noise and short inputs, and rejection of damage
+    std::vector<u8> noise(5000);
+    for (auto& v : noise)
+    {
+        v = randomNumbers();
+    }
+    std::vector<std::vector<u8>> samples = { {}, { 1, 2, 3 }, std::vector<u8>(5000, 0xFF), noise, std::vector<u8>(image.begin() + 16, image.begin() + 16 + 3 * boxSize) };
+    for (auto& sample : samples)
+    {
+        std::vector<u8> packed = BlockCompression::compress(sample.data(), sample.size());
+        std::vector<u8> unpacked(sample.size());
+        if (!BlockCompression::decompress(packed.data(), packed.size(), unpacked.data(), unpacked.size()) || unpacked != sample)
+        {
+            fail("bank: block compression does not round trip %zu bytes\n", sample.size());
+        }
+        if (packed.size() > 2 && BlockCompression::decompress(packed.data(), packed.size() - 2, unpacked.data(), unpacked.size()))
+        {
+            fail("bank: block compression accepts a truncated block\n");
+        }
+    }
+
+    // Version 3 boxes: trimmed and compressed entries decode to the fixed layout
+    std::vector<u8> decoded(boxSize);
+    for (int box = 0; box < bankBoxes; box++)
+    {
+        for (bool compress : { false, true })
+        {
+            bool compressed;
+            std::vector<u8> blob = BankBoxStore::encodeBox(image.data() + 16 + box * boxSize, compress, compressed);
+            if (!BankBoxStore::decodeBox(blob.data(), blob.size(), compressed, decoded.data()) ||
+                !std::equal(decoded.begin(), decoded.end(), image.begin() + 16 + box * boxSize))
+            {
+                fail("bank: box %d does not round trip through the version 3 layout\n", box);
+            }
+        }
+    }
+
+    // A large bank in both layouts
+    constexpr int largeBoxes = 500;
+    std::vector<BankEntry> largeEntries = bankEntries(largeBoxes * 30);
+    std::vector<u8> large(16 + sizeof(BankEntry) * largeEntries.size());
+    std::copy((u8*)largeEntries.data(), (u8*)(largeEntries.data() + largeEntries.size()), large.begin() + 16);
+    std::vector<u8> header(large.begin(), large.begin() + 16);
+    auto largeBox = [&](int box) { return (const u8*)large.data() + 16 + box * boxSize; };
+    std::string v2Path = std::string(dir) + "/large-v2.bnk";
+    std::string v3Path = std::string(dir) + "/large-v3.bnk";
+    std::string rawPath = std::string(dir) + "/large-v3-raw.bnk";
+    file.write(v2Path, 0, large.data(), large.size());
+    BankBoxStore store;
+    store.attach(unmapped, v3Path, 16);
+    store.save(header, largeBoxes, largeBox, {}, true, true);
+    BankBoxStore trimmed;
+    trimmed.compression(false);
+    trimmed.attach(unmapped, rawPath, 16);
+    trimmed.save(header, largeBoxes, largeBox, {}, true, true);
+
+    BankBoxStore reopened;
+    bool loaded = reopened.open(unmapped, v3Path, 16, largeBoxes);
+    for (int box = 0; loaded && box < largeBoxes; box++)
+    {
+        loaded = reopened.readBox(box, decoded.data()) && std::equal(decoded.begin(), decoded.end(), largeBox(box));
+    }
+    if (!loaded)
+    {
+        fail("bank: version 3 bank does not load back what was saved\n");
+    }
+
+    // Edited boxes are saved in place when they fit and moved to the end when they grow
+    std::fill_n(large.begin() + 16 + 10 * boxSize, boxSize, 0xFF);
+    std::copy(noise.begin(), noise.begin() + 200, large.begin() + 16 + 11 * boxSize + 4);
+    u32 before3 = store.fileSize();
+    bool saved = store.save(header, largeBoxes, largeBox, { 10, 11 }, false, true);
+    loaded = saved && reopened.open(unmapped, v3Path, 16, largeBoxes);
+    for (int box = 0; loaded && box < largeBoxes; box++)
+    {
+        loaded = reopened.readBox(box, decoded.data()) && std::equal(decoded.begin(), decoded.end(), largeBox(box));
+    }
+    if (!loaded || store.fileSize() <= before3)
+    {
+        fail("bank: partial version 3 save lost an edit\n");
+    }
+
+    // A box that could not be read is copied across a rewrite as stored, never replaced
+    auto unread = [&](int box) { return box == 12 ? nullptr : largeBox(box); };
+    std::vector<u8> stored(boxSize);
+    saved = reopened.readBox(12, stored.data()) && store.save(header, largeBoxes, unread, {}, true, true);
+    loaded = saved && reopened.open(unmapped, v3Path, 16, largeBoxes) && reopened.readBox(12, decoded.data()) && decoded == stored;
+    BankBoxStore empty;
+    empty.attach(unmapped, std::string(dir) + "/never-stored.bnk", 16);
+    if (!loaded || empty.save(header, largeBoxes, unread, {}, true, true))
+    {
+        fail("bank: rewrite replaced a box that could not be read\n");
+    }
+
+    report("bank/format/size-v2", large.size() / 1024.0, "KiB");
+    report("bank/format/size-v3-trimmed", trimmed.fileSize() / 1024.0, "KiB");
+    report("bank/format/size-v3-compressed", store.fileSize() / 1024.0, "KiB");
+    measure("bank/format/load-v2", 20, [&]() {
+        std::vector<u8> contents;
+        file.read(v2Path, contents);
+        sink = contents[16];
+    });
+    auto loadV3 = [&](const std::string& path) {
+        BankBoxStore loading;
+        loading.open(file, path, 16, largeBoxes);
+        for (int box = 0; box < largeBoxes; box++)
+        {
+            loading.readBox(box, decoded.data());
+        }
+        sink = decoded[0];
+    };
+    measure("bank/format/load-v3-trimmed", 20, [&]() { loadV3(rawPath); });
+    measure("bank/format/load-v3-compressed", 20, [&]() { loadV3(v3Path); });
+    (void)sink;
+    file.remove(v2Path);
+    file.remove(v3Path);
+    file.remove(rawPath);
+
+    // Cross-bank index: the slots spread over four banks, found again without their PKX
+    const std::string indexPath = std::string(dir) + "/banks.idx";
+    const std::vector<std::string> bankNames = { "a", "b", "c", "d" };
+    constexpr int banksBoxes = bankBoxes / 4;
+    auto bankOf = [&](size_t i) { return bankNames[i / (banksBoxes * 30)]; };
+    GlobalBankIndex global;
+    for (auto& name : bankNames)
+    {
+        global.resize(name, banksBoxes);
+    }
+    for (size_t i = 0; i < bankSlots; i++)
+    {
+        global.set(bankOf(i), i / 30 % banksBoxes, i % 30, *bankPkm(entries[i]));
+    }
+    auto scan = [&](const GlobalBankIndex::Query& query) {
+        std::vector<std::tuple<std::string, int, int>> ret;
+        for (size_t i = 0; i < bankSlots; i++)
+        {
+            std::shared_ptr<PKX> pk = bankPkm(entries[i]);
+            if (pk->species() != 0 && (!query.species || pk->species() == *query.species) && (!query.shiny || pk->shiny() == *query.shiny) &&
+                (!query.otName || pk->otName() == *query.otName) && (!query.PID || pk->PID() == *query.PID))
+            {
+                ret.emplace_back(bankOf(i), i / 30 % banksBoxes, i % 30);
+            }
+        }
+        return ret;
+    };
+    auto tuples = [](const std::vector<GlobalBankIndex::Location>& locations) {
+        std::vector<std::tuple<std::string, int, int>> ret;
+        for (auto& location : locations)
+        {
+            ret.emplace_back(location.bank, location.box, location.slot);
+        }
+        return ret;
+    };
+    std::shared_ptr<PKX> sought = bankPkm(entries[expected.back()]);
+    GlobalBankIndex::Query bySpeciesQuery;
+    bySpeciesQuery.species = sought->species();
+    GlobalBankIndex::Query byTrainer;
+    byTrainer.otName = sought->otName();
+    byTrainer.PID = sought->PID();
+    global.revision("a", 7);
+    GlobalBankIndex loadedIndex;
+    if (!global.save(file, indexPath) || !loadedIndex.load(file, indexPath) || loadedIndex.size() != global.size() ||
+        !loadedIndex.current("a", 7) || loadedIndex.current("a", 8) || loadedIndex.current("b", 0))
+    {
+        fail("bank: cross-bank index does not load back what was saved\n");
+    }
+    if (tuples(loadedIndex.find(bySpeciesQuery)) != scan(bySpeciesQuery) || tuples(loadedIndex.find(byTrainer)) != scan(byTrainer) ||
+        scan(byTrainer).empty())
+    {
+        fail("bank: cross-bank index finds different slots than a scan\n");
+    }
+
+    // Renaming, removing and emptying a slot
+    loadedIndex.rename("a", "e");
+    loadedIndex.remove("b");
+    loadedIndex.clear("c", 0, 0);
+    bool updated = !loadedIndex.contains("a") && loadedIndex.boxes("e") == banksBoxes && !loadedIndex.contains("b") &&
+                   loadedIndex.current("e", 7) && !loadedIndex.current("a", 7);
+    for (auto& location : loadedIndex.find({}))
+    {
+        updated = updated && location.bank != "a" && location.bank != "b" && !(location.bank == "c" && location.box == 0 && location.slot == 0);
+    }
+    if (!updated)
+    {
+        fail("bank: cross-bank index kept a renamed, removed or cleared entry\n");
+    }
+
+    // A damaged file is refused rather than half read
+    std::vector<u8> contents = global.serialize();
+    contents[contents.size() / 2] ^= 1;
+    if (!GlobalBankIndex::save(file, indexPath, contents) || loadedIndex.load(file, indexPath) || loadedIndex.size() != 0)
+    {
+        fail("bank: damaged cross-bank index was loaded\n");
+    }
+
+    global.save(file, indexPath);
+    std::vector<u8> indexFile;
+    file.read(indexPath, indexFile);
+    report("bank/global/file-size", indexFile.size() / 1024.0, "KiB");
+    measure("bank/global/find-scan", 10, [&]() { sink = scan(byTrainer).size(); });
+    measure("bank/global/find-index", 200, [&]() { sink = global.find(byTrainer).size(); });
+    measure("bank/global/load", 50, [&]() {
+        GlobalBankIndex loading;
+        loading.load(file, indexPath);
+    });
+    (void)sink;
+    file.remove(indexPath);
+
+    file.remove(bankPath);
+    rmdir(dir);
+}
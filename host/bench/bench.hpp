@@ -0,0 +1,123 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <memory>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "Sav.hpp"
+
+namespace Bench
+{
+    extern std::string filter;
+    extern int failures;
+
+    // Reports a failed check. Any failure makes pksmbench exit with an error
+    inline void fail(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+        failures++;
+    }
+
+    // Times `iterations` calls of func after a single warm-up call and prints the mean.
+    // setup runs before every call and is not timed. Benchmarks whose name does not
+    // contain the filter are skipped.
+    template <typename Func, typename Setup>
+    void measure(const std::string& name, size_t iterations, Func&& func, Setup&& setup)
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos)
+        {
+            return;
+        }
+
+        setup();
+        func();
+        std::chrono::steady_clock::duration total{0};
+        for (size_t i = 0; i < iterations; i++)
+        {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            func();
+            total += std::chrono::steady_clock::now() - start;
+        }
+        double ns = std::chrono::duration<double, std::nano>(total).count() / iterations;
+        printf("%-40s %8zu %14.1f ns/op\n", name.c_str(), iterations, ns);
+    }
+
+    template <typename Func>
+    void measure(const std::string& name, size_t iterations, Func&& func)
+    {
+        measure(name, iterations, func, [](){});
+    }
+
+    // Prints a quantity other than time, filtered the same way as measure
+    inline void report(const std::string& name, double value, const char* unit)
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos)
+        {
+            return;
+        }
+        printf("%-40s %8s %14.1f %s\n", name.c_str(), "", value, unit);
+    }
+
+    // Builds a file image for the given game, with every box slot filled
+    // with an encrypted random Pokémon and valid checksums
+    std::vector<u8> saveImage(Game game);
+    const char* gameName(Game game);
+    Generation gameGeneration(Game game);
+    extern const std::vector<Game> games;
+
+    // Raw slots laid out like Bank's entries, with a mix of generations
+    struct BankEntry
+    {
+        Generation gen;
+        u8 data[260];
+    };
+    std::vector<BankEntry> bankEntries(size_t slots);
+    std::shared_ptr<PKX> bankPkm(BankEntry& entry);
+
+    void saves(void);
+    void crc(void);
+    void pkx(void);
+    void bank(void);
+    void backup(void);
+    void writer(void);
+    void duplicates(void);
+    void transfer(void);
+    void convert(void);
+    void pid(void);
+}
+
+#endif
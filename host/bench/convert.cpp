@@ -0,0 +1,215 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+#include <string.h>
+#include "bench.hpp"
+#include "BankBoxStore.hpp"
+#include "PKXConverter.hpp"
+#include "loader.hpp"
+#include "random.hpp"
+
+namespace
+{
+    constexpr Generation gens[] = { Generation::FOUR, Generation::FIVE, Generation::SIX, Generation::SEVEN };
+
+    // Bank slots of one generation, half of them nicknamed. Their language is left unset, as
+    // species names cannot be loaded here
+    std::vector<std::shared_ptr<PKX>> sources(Generation gen, size_t count)
+    {
+        std::vector<std::shared_ptr<PKX>> ret;
+        while (ret.size() < count)
+        {
+            for (auto& entry : Bench::bankEntries(count))
+            {
+                if (entry.gen != gen || ret.size() == count)
+                {
+                    continue;
+                }
+                std::shared_ptr<PKX> pk = Bench::bankPkm(entry);
+                // Only species every generation here knows, as PKSM never moves others down
+                if (pk->species() > 493)
+                {
+                    continue;
+                }
+                pk->otName("Trainer");
+                if (randomNumbers() % 2)
+                {
+                    pk->nicknamed(true);
+                    pk->nickname("Nick" + std::to_string(ret.size() % 100));
+                }
+                for (int i = 0; i < 4; i++)
+                {
+                    pk->move(i, randomNumbers() % 600);
+                }
+                pk->refreshChecksum();
+                ret.emplace_back(pk);
+            }
+        }
+        return ret;
+    }
+
+    // What Sav::transfer did: a new Pokémon for every generation crossed
+    std::shared_ptr<PKX> chain(std::shared_ptr<PKX> pk, Generation target)
+    {
+        while (pk->generation() != target)
+        {
+            pk = pk->generation() > target ? pk->previous() : pk->next();
+        }
+        return pk;
+    }
+
+    // The fields every conversion carries over unchanged
+    bool sameCore(const PKX& a, const PKX& b)
+    {
+        if (a.species() != b.species() || a.TID() != b.TID() || a.SID() != b.SID() || a.experience() != b.experience() ||
+            a.ball() != b.ball() || a.otName() != b.otName() || a.nicknamed() != b.nicknamed() ||
+            (a.nicknamed() && a.nickname() != b.nickname()))
+        {
+            return false;
+        }
+        for (int i = 0; i < 6; i++)
+        {
+            if (a.iv(i) != b.iv(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void checkConversions(void)
+    {
+        for (Generation from : gens)
+        {
+            std::vector<std::shared_ptr<PKX>> pkms = sources(from, 60);
+            for (Generation to : gens)
+            {
+                if (from == to)
+                {
+                    continue;
+                }
+                std::string name = std::string(genToCstring(from)) + " to " + genToCstring(to);
+                int differ = 0, lost = 0;
+                for (size_t i = 0; i < pkms.size(); i++)
+                {
+                    // Handler memories draw a random feeling, so both ways start from the same seed
+                    randomNumbers.seed(i);
+                    std::shared_ptr<PKX> hops = chain(pkms[i], to);
+                    randomNumbers.seed(i);
+                    std::shared_ptr<PKX> direct = PKXConverter::convert(*pkms[i], to);
+                    if (!direct || direct->generation() != to || direct->getLength() != hops->getLength() ||
+                        memcmp(direct->rawData(), hops->rawData(), hops->getLength()) != 0)
+                    {
+                        differ++;
+                    }
+                    // Going up and back down again keeps what both formats hold
+                    if (from < to && direct && !sameCore(*pkms[i], *PKXConverter::convert(*direct, from)))
+                    {
+                        lost++;
+                    }
+                }
+                if (differ)
+                {
+                    Bench::fail("convert: %d of %zu Pokémon from %s differ from the generation by generation result\n", differ, pkms.size(), name.c_str());
+                }
+                if (lost)
+                {
+                    Bench::fail("convert: %d of %zu Pokémon from %s lose fields on the way back\n", lost, pkms.size(), name.c_str());
+                }
+            }
+        }
+
+        if (PKXConverter::convert(*sources(Generation::SEVEN, 1)[0], Generation::LGPE))
+        {
+            Bench::fail("convert: a gen 7 Pokémon converted to LGPE\n");
+        }
+    }
+
+    void checkBox(const std::vector<Bench::BankEntry>& entries, Generation target)
+    {
+        const u32 length = PKXConverter::boxLength(target);
+        std::vector<u8> batch(30 * length), single(30 * length, 0);
+        PKXConverter converter;
+        randomNumbers.seed(0);
+        int converted = BankBoxStore::convertBox((const u8*)entries.data(), target, batch.data());
+        randomNumbers.seed(0);
+        int expected = 0;
+        for (int slot = 0; slot < 30; slot++)
+        {
+            const Bench::BankEntry& entry = entries[slot];
+            if ((u32)entry.gen <= (u32)Generation::LGPE && converter.convert(entry.gen, entry.data, target, single.data() + slot * length))
+            {
+                expected++;
+            }
+        }
+        if (converted != expected || batch != single)
+        {
+            Bench::fail("convert: converting a bank box to %s differs from converting its slots one by one\n", genToCstring(target));
+        }
+    }
+}
+
+void Bench::convert(void)
+{
+    std::vector<u8> image = saveImage(Game::SM);
+    TitleLoader::save = Sav::getSave(image.data(), image.size());
+
+    checkConversions();
+    std::vector<BankEntry> entries = bankEntries(30);
+    for (Generation target : gens)
+    {
+        checkBox(entries, target);
+    }
+
+    // From gen 4 the time goes mostly on decoding its text; from gen 6 it goes on the conversion itself
+    std::vector<u8> out(30 * 232);
+    for (Generation from : { Generation::FOUR, Generation::SIX })
+    {
+        std::vector<std::shared_ptr<PKX>> box = sources(from, 30);
+        std::string name = std::string("convert/box/") + genToCstring(from) + "-to-7/";
+        measure(name + "hops", 100, [&]() {
+            for (auto& pk : box)
+            {
+                chain(pk, Generation::SEVEN);
+            }
+        });
+        measure(name + "direct", 100, [&]() {
+            for (auto& pk : box)
+            {
+                PKXConverter::convert(*pk, Generation::SEVEN);
+            }
+        });
+        measure(name + "converter", 100, [&]() {
+            PKXConverter converter;
+            for (size_t i = 0; i < box.size(); i++)
+            {
+                converter.convert(*box[i], Generation::SEVEN, out.data() + i * 232);
+            }
+        });
+    }
+    measure("convert/bank-box/mixed-to-7", 100, [&]() { BankBoxStore::convertBox((const u8*)entries.data(), Generation::SEVEN, out.data()); });
+
+    TitleLoader::save = nullptr;
+}
@@ -0,0 +1,115 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+
+#include <algorithm>
+#include "bench.hpp"
+#include "crc.hpp"
+#include "random.hpp"
+
+namespace
+{
+    // The implementations the CRC module replaced, kept as references
+    u16 ccittBitwise(const u8* buf, size_t len)
+    {
+        u16 crc = 0xFFFF;
+        for (size_t i = 0; i < len; i++)
+        {
+            crc ^= (u16)(buf[i] << 8);
+            for (size_t j = 0; j < 0x8; j++)
+            {
+                if ((crc & 0x8000) > 0)
+                    crc = (u16)((crc << 1) ^ 0x1021);
+                else
+                    crc <<= 1;
+            }
+        }
+        return crc;
+    }
+
+    u16 arcBytewise(const u8* buf, size_t len, u16 chk)
+    {
+        static u16 table[256];
+        if (table[1] == 0)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                u16 crc = i;
+                for (int j = 0; j < 8; j++)
+                {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+                }
+                table[i] = crc;
+            }
+        }
+        for (size_t i = 0; i < len; i++)
+        {
+            chk = (table[(buf[i] ^ chk) & 0xFF] ^ chk >> 8);
+        }
+        return chk;
+    }
+}
+
+void Bench::crc(void)
+{
+    // Largest checksummed block among the supported games (ORAS box data)
+    constexpr size_t blockSize = 0x34AD0;
+    std::vector<u8> block(blockSize);
+    for (auto& b : block)
+    {
+        b = randomNumbers();
+    }
+
+    for (size_t len : {size_t(0), size_t(1), size_t(7), size_t(0x8C), size_t(0x94), size_t(0x1C61), blockSize})
+    {
+        for (size_t offset = 0; offset < 8; offset++)
+        {
+            size_t size = std::min(len, blockSize - offset);
+            if (CRC::ccitt16(block.data() + offset, size) != ccittBitwise(block.data() + offset, size))
+            {
+                fail("crc: ccitt16 mismatch at length 0x%zX, offset %zu\n", size, offset);
+            }
+            if (CRC::crc16(block.data() + offset, size, 0xFFFF) != arcBytewise(block.data() + offset, size, 0xFFFF))
+            {
+                fail("crc: crc16 mismatch at length 0x%zX, offset %zu\n", size, offset);
+            }
+
+            std::vector<u8> masked(block.begin() + offset, block.begin() + offset + size);
+            std::fill(masked.begin() + std::min(size, size_t(0x100)), masked.begin() + std::min(size, size_t(0x180)), 0);
+            if (CRC::crc16(block.data() + offset, size, 0xFFFF, 0x100, 0x80) != arcBytewise(masked.data(), size, 0xFFFF))
+            {
+                fail("crc: masked crc16 mismatch at length 0x%zX, offset %zu\n", size, offset);
+            }
+        }
+    }
+
+    volatile u16 sink;
+    measure("crc/ccitt16/bitwise", 50, [&]() { sink = ccittBitwise(block.data(), blockSize); });
+    measure("crc/ccitt16/table", 500, [&]() { sink = CRC::ccitt16(block.data(), blockSize); });
+    measure("crc/crc16/bytewise", 500, [&]() { sink = arcBytewise(block.data(), blockSize, 0xFFFF); });
+    measure("crc/crc16/table", 500, [&]() { sink = CRC::crc16(block.data(), blockSize, 0xFFFF); });
+    (void)sink;
+}
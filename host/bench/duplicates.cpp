@@ -0,0 +1,150 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include "bench.hpp"
+#include "DuplicateFinder.hpp"
+
+void Bench::duplicates(void)
+{
+    // An SM save and a bank, with copies planted within and between them
+    std::vector<u8> image = saveImage(Game::SM);
+    std::shared_ptr<Sav> save = Sav::getSave(image.data(), image.size());
+    std::vector<BankEntry> entries = bankEntries(3000);
+    std::vector<std::shared_ptr<PKX>> bank(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        bank[i] = bankPkm(entries[i]);
+    }
+    size_t original = 0;
+    while (bank[original]->species() == 0)
+    {
+        original++;
+    }
+    // An exact copy elsewhere in the bank, one traded on and levelled, and one in the save
+    bank[2999] = bank[original]->clone();
+    bank[2998] = bank[original]->clone();
+    bank[2998]->otFriendship(bank[original]->otFriendship() ^ 0x40);
+    bank[2998]->refreshChecksum();
+    auto fromSave = save->pkm(3, 7);
+    bank[2997] = fromSave->clone();
+
+    auto find = [&](DuplicateFinder::Match match) {
+        DuplicateFinder finder(match);
+        for (int i = 0; i < save->maxSlot(); i++)
+        {
+            finder.add(0, i / 30, i % 30, *save->pkm(i / 30, i % 30));
+        }
+        for (size_t i = 0; i < bank.size(); i++)
+        {
+            finder.add(1, i / 30, i % 30, *bank[i]);
+        }
+        return finder.groups();
+    };
+    auto describe = [](const std::vector<std::vector<DuplicateFinder::Location>>& groups) {
+        std::vector<std::vector<int>> ret;
+        for (auto& group : groups)
+        {
+            ret.emplace_back();
+            for (auto& location : group)
+            {
+                ret.back().push_back(location.source * 100000 + location.box * 30 + location.slot);
+            }
+        }
+        return ret;
+    };
+    int originalId = 100000 + original;
+    std::vector<std::vector<int>> identity = { { 3 * 30 + 7, 102997 }, { originalId, 102998, 102999 } };
+    std::vector<std::vector<int>> exact = { { 3 * 30 + 7, 102997 }, { originalId, 102999 } };
+    if (describe(find(DuplicateFinder::Match::IDENTITY)) != identity)
+    {
+        fail("duplicates: identity groups are not the planted copies\n");
+    }
+    if (describe(find(DuplicateFinder::Match::EXACT)) != exact)
+    {
+        fail("duplicates: exact groups are not the planted copies\n");
+    }
+
+    // Fingerprints read in place must match the PKX ones, so both kinds of source can be mixed
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        auto pkm = bankPkm(entries[i]);
+        bool same = visitPKX(entries[i].gen, entries[i].data, [&pkm](const auto& view) {
+            return DuplicateFinder::fingerprint(view, DuplicateFinder::Match::IDENTITY) == DuplicateFinder::fingerprint(*pkm, DuplicateFinder::Match::IDENTITY) &&
+                   DuplicateFinder::fingerprint(view, DuplicateFinder::Match::EXACT) == DuplicateFinder::fingerprint(*pkm, DuplicateFinder::Match::EXACT);
+        });
+        if (!same && (u32)entries[i].gen <= (u32)Generation::LGPE)
+        {
+            fail("duplicates: fingerprint of a view differs from its PKX in slot %zu\n", i);
+            break;
+        }
+    }
+
+    // A whole bank, building a PKX per slot as Banks::duplicates did, and reading in place
+    volatile size_t sink;
+    measure("duplicates/bank/pkx", 20, [&]() {
+        DuplicateFinder finder;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            finder.add(1, i / 30, i % 30, *bankPkm(entries[i]));
+        }
+        sink = finder.groups().size();
+    });
+    measure("duplicates/bank/view", 20, [&]() {
+        DuplicateFinder finder;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            visitPKX(entries[i].gen, entries[i].data, [&finder, i](const auto& pkm) { finder.add(1, i / 30, i % 30, pkm); });
+        }
+        sink = finder.groups().size();
+    });
+
+    // Cost per slot at two sizes; hashing keeps it flat
+    std::vector<std::shared_ptr<PKX>> many;
+    for (int copy = 0; copy < 10; copy++)
+    {
+        for (auto& pkm : bank)
+        {
+            many.push_back(pkm->clone());
+            many.back()->PID(many.back()->PID() + copy);
+        }
+    }
+    auto scan = [&](size_t slots, DuplicateFinder::Match match) {
+        DuplicateFinder finder(match);
+        finder.reserve(slots);
+        for (size_t i = 0; i < slots; i++)
+        {
+            finder.add(1, i / 30, i % 30, *many[i]);
+        }
+        return finder.groups().size();
+    };
+    for (size_t slots : { many.size() / 10, many.size() })
+    {
+        std::string size = std::to_string(slots);
+        measure("duplicates/identity/" + size, 20, [&]() { sink = scan(slots, DuplicateFinder::Match::IDENTITY); });
+        measure("duplicates/exact/" + size, 20, [&]() { sink = scan(slots, DuplicateFinder::Match::EXACT); });
+    }
+    (void)sink;
+}
@@ -0,0 +1,232 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+#include "bench.hpp"
+#include "PK4.hpp"
+#include "PK7.hpp"
+#include "personal.hpp"
+#include "random.hpp"
+
+namespace
+{
+    struct PIDCase
+    {
+        u16 species;
+        u8 gender;
+        u8 originGame;
+        u8 nature;
+        u8 form;
+        u8 abilityNum;
+        u16 tid;
+        u16 sid;
+        Generation gen;
+    };
+
+    u8 genderType(u16 species, Generation gen)
+    {
+        switch (gen)
+        {
+            case Generation::FOUR:
+                return PersonalDPPtHGSS::gender(species);
+            case Generation::FIVE:
+                return PersonalBWB2W2::gender(species);
+            case Generation::SIX:
+                return PersonalXYORAS::gender(species);
+            default:
+                return PersonalSMUSUM::gender(species);
+        }
+    }
+
+    bool isShiny(u32 pid, const PIDCase& c)
+    {
+        const u32 range = c.gen == Generation::FOUR || c.gen == Generation::FIVE ? 8 : 16;
+        return ((pid >> 16) ^ (pid & 0xFFFF) ^ c.tid ^ c.sid) < range;
+    }
+
+    // getRandomPID as it was, drawing until every constraint happens to hold
+    u32 rejectionPID(const PIDCase& c)
+    {
+        if (c.originGame >= 24)
+        {
+            return randomNumbers();
+        }
+        u8 gt = genderType(c.species, c.gen);
+        bool g3unown = c.originGame <= 5 && c.species == 201;
+        while (true)
+        {
+            u32 pid = randomNumbers();
+            if (c.originGame <= 15 && pid % 25 != c.nature)
+            {
+                continue;
+            }
+            if (g3unown)
+            {
+                u32 val = (pid & 0x3000000) >> 18 | (pid & 0x30000) >> 12 | (pid & 0x300) >> 6 | (pid & 0x3);
+                if (val % 28 != c.form)
+                {
+                    continue;
+                }
+            }
+            else if (c.abilityNum == 1 || c.abilityNum == 2)
+            {
+                if (((pid >> (c.gen == Generation::FIVE ? 16 : 0)) & 1) != (c.abilityNum == 2 ? 1u : 0u))
+                {
+                    continue;
+                }
+            }
+            if (gt == 255 || gt == 254 || gt == 0 || c.gender == 2 || c.gender == ((pid & 0xFF) < gt ? 1 : 0))
+            {
+                return pid;
+            }
+        }
+    }
+
+    // What shiny(true) did with it
+    u32 rejectionShinyPID(const PIDCase& c)
+    {
+        u32 pid;
+        do
+        {
+            pid = rejectionPID(c);
+        }
+        while (!isShiny(pid, c));
+        return pid;
+    }
+
+    u32 solvedPID(const PIDCase& c, bool shiny)
+    {
+        return PKX::getRandomPID(c.species, c.gender, c.originGame, c.nature, c.form, c.abilityNum, c.tid, c.sid, shiny, c.gen);
+    }
+
+    // Checked from scratch rather than with the solver's own rules
+    bool satisfies(u32 pid, const PIDCase& c)
+    {
+        if (c.originGame >= 24)
+        {
+            return true;
+        }
+        u8 gt = genderType(c.species, c.gen);
+        if (c.originGame <= 15 && pid % 25 != c.nature)
+        {
+            return false;
+        }
+        if (c.originGame <= 5 && c.species == 201)
+        {
+            u32 val = (pid & 0x3000000) >> 18 | (pid & 0x30000) >> 12 | (pid & 0x300) >> 6 | (pid & 0x3);
+            if (val % 28 != c.form)
+            {
+                return false;
+            }
+        }
+        else if ((c.abilityNum == 1 || c.abilityNum == 2) && ((pid >> (c.gen == Generation::FIVE ? 16 : 0)) & 1) != (c.abilityNum == 2 ? 1u : 0u))
+        {
+            return false;
+        }
+        return gt == 255 || gt == 254 || gt == 0 || c.gender == ((pid & 0xFF) < gt ? 1 : 0);
+    }
+
+    void checkSolver(void)
+    {
+        static constexpr u8 origins[] = { 1, 2, 3, 4, 5, 7, 8, 10, 11, 12, 15, 20, 21, 22, 23, 24, 26, 30, 32 };
+        static constexpr Generation gens[] = { Generation::FOUR, Generation::FIVE, Generation::SIX, Generation::SEVEN };
+        int wrong = 0;
+        for (int i = 0; i < 20000; i++)
+        {
+            PIDCase c;
+            c.species = i % 5 == 0 ? 201 : randomNumbers() % 493 + 1;
+            c.gender = randomNumbers() % 2;
+            c.originGame = origins[randomNumbers() % (sizeof(origins) / sizeof(origins[0]))];
+            c.nature = randomNumbers() % 25;
+            c.form = randomNumbers() % 28;
+            c.abilityNum = 1 << (randomNumbers() % 3);
+            c.tid = randomNumbers();
+            c.sid = randomNumbers();
+            c.gen = gens[randomNumbers() % 4];
+            bool shiny = i % 2;
+            u32 pid = solvedPID(c, shiny);
+            if (!satisfies(pid, c) || isShiny(pid, c) != shiny)
+            {
+                wrong++;
+            }
+            if (!satisfies(PKX::getRandomPID(c.species, c.gender, c.originGame, c.nature, c.form, c.abilityNum, 0, c.gen), c))
+            {
+                wrong++;
+            }
+        }
+        if (wrong)
+        {
+            Bench::fail("pid: %d solved PIDs break their constraints\n", wrong);
+        }
+
+        // Through the setters: shininess comes and goes without touching the rest
+        PK4 pk4;
+        pk4.species(1);
+        pk4.version(3);
+        pk4.TID(12345);
+        pk4.SID(54321);
+        pk4.gender(1);
+        pk4.nature(7);
+        pk4.shiny(true);
+        bool kept = pk4.shiny() && pk4.nature() == 7;
+        pk4.shiny(false);
+        kept = kept && !pk4.shiny() && pk4.nature() == 7;
+        PK7 pk7;
+        pk7.species(25);
+        pk7.version(30);
+        pk7.TID(1);
+        pk7.SID(2);
+        pk7.shiny(true);
+        kept = kept && pk7.shiny();
+        if (!kept)
+        {
+            Bench::fail("pid: shiny() setters lose shininess or nature\n");
+        }
+    }
+}
+
+void Bench::pid(void)
+{
+    checkSolver();
+
+    // Gen 3 origin: fixed nature, a one in eight gender and the ability bit
+    const PIDCase bulbasaur = { 1, 1, 3, 7, 0, 2, 12345, 54321, Generation::FOUR };
+    // Gen 3 Unown: fixed nature and form
+    const PIDCase unown = { 201, 2, 3, 13, 26, 1, 12345, 54321, Generation::FOUR };
+    // Gen 4 origin in a gen 5 file: nature, gender and the high ability bit
+    const PIDCase vulpix = { 37, 0, 10, 20, 0, 2, 40000, 123, Generation::FIVE };
+    // Gen 6 origin: only shininess to meet
+    const PIDCase pikachu = { 25, 0, 30, 0, 0, 1, 1, 2, Generation::SEVEN };
+
+    volatile u32 sink = 0;
+    for (auto& [name, c] : { std::make_pair("gen3-gender-ability", bulbasaur), std::make_pair("gen3-unown", unown),
+                             std::make_pair("gen4-in-gen5", vulpix), std::make_pair("gen6", pikachu) })
+    {
+        measure(std::string("pid/shiny/") + name + "/rejection", 3, [&]() { sink = rejectionShinyPID(c); });
+        measure(std::string("pid/shiny/") + name + "/solver", 1000, [&]() { sink = solvedPID(c, true); });
+        measure(std::string("pid/random/") + name + "/rejection", 1000, [&]() { sink = rejectionPID(c); });
+        measure(std::string("pid/random/") + name + "/solver", 1000, [&]() { sink = PKX::getRandomPID(c.species, c.gender, c.originGame, c.nature, c.form, c.abilityNum, 0, c.gen); });
+    }
+    (void)sink;
+}
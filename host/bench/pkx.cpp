@@ -0,0 +1,325 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <algorithm>
+#include <array>
+#include <set>
+#include <utility>
+#include "bench.hpp"
+#include "PK5.hpp"
+#include "PK7.hpp"
+#include "PKX.hpp"
+#include "random.hpp"
+
+namespace
+{
+    // The word-at-a-time keystream every PKX class used before the jump-ahead kernel
+    void cryptSequential(u8* dt, u32 length, u32 seed, u32 partyStart)
+    {
+        const u32 partySeed = *(u32*)dt;
+        for (u32 i = 8; i < partyStart && i < length; i += 2)
+        {
+            seed = seed * 0x41C64E6D + 0x6073;
+            *(u16*)(dt + i) ^= (seed >> 16);
+        }
+        seed = partySeed;
+        for (u32 i = partyStart; i < length; i += 2)
+        {
+            seed = seed * 0x41C64E6D + 0x6073;
+            *(u16*)(dt + i) ^= (seed >> 16);
+        }
+    }
+
+    // The copy-the-whole-entry shuffle the PKX classes used before, driven by an order table
+    void shuffleCopy(u8* dt, u32 length, u32 blockLength, const u8* order)
+    {
+        u8 cdata[length];
+        std::copy(dt, dt + length, cdata);
+        for (u8 block = 0; block < 4; block++)
+        {
+            std::copy(cdata + 8 + blockLength * order[block], cdata + 8 + blockLength * (order[block] + 1), dt + 8 + blockLength * block);
+        }
+    }
+
+    // The linear scan each PKX class ran in level()
+    u8 levelLinear(u32 exp, u8 expType)
+    {
+        u8 i = 1;
+        while (exp >= PKX::expTable(i, expType) && ++i < 100);
+        return i;
+    }
+}
+
+void Bench::pkx(void)
+{
+    // A full default-sized bank: 50 boxes of 30 entries, stored at party size
+    constexpr size_t entries = 50 * 30;
+    constexpr u32 entryLength = 260;
+    std::vector<u8> bank(entries * entryLength);
+    for (auto& b : bank)
+    {
+        b = randomNumbers();
+    }
+
+    // Stored and party sizes of every generation, with their keystream restart points
+    static constexpr std::pair<u32, u32> layouts[] = { {136, 136}, {220, 136}, {236, 136}, {232, 232}, {260, 232} };
+    for (auto [length, partyStart] : layouts)
+    {
+        for (size_t i = 0; i < 64; i++)
+        {
+            u8* entry = bank.data() + i * entryLength;
+            u32 seed = randomNumbers();
+            std::vector<u8> expected(entry, entry + length);
+            cryptSequential(expected.data(), length, seed, partyStart);
+            std::vector<u8> actual(entry, entry + length);
+            PKX::cryptData(actual.data(), length, seed, partyStart);
+            if (expected != actual)
+            {
+                fail("pkx: keystream mismatch for length %u, seed 0x%08X\n", length, seed);
+                break;
+            }
+        }
+    }
+
+    // Every shuffle value must give a valid block order, the 24 distinct orders must all
+    // appear, and unshuffling must restore the entry
+    u8 orders[32][4];
+    for (u32 blockLength : {32u, 56u})
+    {
+        std::set<std::array<u8, 4>> seen;
+        for (u8 sv = 0; sv < 32; sv++)
+        {
+            u8 entry[232];
+            for (u32 i = 0; i < sizeof(entry); i++)
+            {
+                entry[i] = i < 8 ? i : (i - 8) / blockLength;
+            }
+            PKX::shuffleData(entry, blockLength, sv);
+            std::array<u8, 4> order = { entry[8], entry[8 + blockLength], entry[8 + blockLength * 2], entry[8 + blockLength * 3] };
+            std::copy(order.begin(), order.end(), orders[sv]);
+            seen.insert(order);
+            std::sort(order.begin(), order.end());
+            if (order != std::array<u8, 4>{ 0, 1, 2, 3 })
+            {
+                fail("pkx: shuffle value %u with %u byte blocks loses a block\n", sv, blockLength);
+            }
+
+            const std::vector<u8> original(bank.begin(), bank.begin() + 232);
+            std::vector<u8> shuffled = original;
+            std::vector<u8> copied = original;
+            PKX::shuffleData(shuffled.data(), blockLength, sv);
+            shuffleCopy(copied.data(), 232, blockLength, orders[sv]);
+            if (shuffled != copied)
+            {
+                fail("pkx: shuffle value %u with %u byte blocks differs from the copying shuffle\n", sv, blockLength);
+            }
+            PKX::unshuffleData(shuffled.data(), blockLength, sv);
+            if (shuffled != original)
+            {
+                fail("pkx: shuffle value %u with %u byte blocks does not round trip\n", sv, blockLength);
+            }
+        }
+        if (seen.size() != 24)
+        {
+            fail("pkx: %zu distinct block orders with %u byte blocks\n", seen.size(), blockLength);
+        }
+    }
+
+    // Shuffle cost is independent of the keystream, so time it over many box-sized entries
+    constexpr size_t shuffleEntries = 100000;
+    std::vector<u8> boxes(shuffleEntries * 232);
+    for (auto& b : boxes)
+    {
+        b = randomNumbers();
+    }
+    measure("pkx/shuffle/copy", 10, [&]() {
+        for (size_t i = 0; i < shuffleEntries; i++)
+        {
+            u8* entry = boxes.data() + i * 232;
+            shuffleCopy(entry, 232, 56, orders[(*(u32*)entry >> 13) & 31]);
+        }
+    });
+    measure("pkx/shuffle/shared-buffer", 10, [&]() {
+        for (size_t i = 0; i < shuffleEntries; i++)
+        {
+            u8* entry = boxes.data() + i * 232;
+            PKX::shuffleData(entry, 56, (*(u32*)entry >> 13) & 31);
+        }
+    });
+
+    // Check the level search at, just below and just above every threshold
+    for (u8 expType = 0; expType < 6; expType++)
+    {
+        std::vector<u32> amounts = { 0, 0xFFFFFFFF };
+        for (u8 row = 0; row < 100; row++)
+        {
+            u32 threshold = PKX::expTable(row, expType);
+            amounts.insert(amounts.end(), { threshold - 1, threshold, threshold + 1 });
+        }
+        for (u32 exp : amounts)
+        {
+            if (PKX::levelFromExp(exp, expType) != levelLinear(exp, expType))
+            {
+                fail("pkx: level mismatch for %u experience with growth rate %u\n", exp, expType);
+                break;
+            }
+        }
+    }
+
+    std::vector<std::pair<u32, u8>> experience(100000);
+    for (auto& [exp, expType] : experience)
+    {
+        expType = randomNumbers() % 6;
+        exp = randomNumbers() % (PKX::expTable(99, expType) + 1);
+    }
+    volatile u32 levels;
+    measure("pkx/level/linear", 50, [&]() {
+        u32 sum = 0;
+        for (auto [exp, expType] : experience)
+        {
+            sum += levelLinear(exp, expType);
+        }
+        levels = sum;
+    });
+    measure("pkx/level/search", 50, [&]() {
+        u32 sum = 0;
+        for (auto [exp, expType] : experience)
+        {
+            sum += PKX::levelFromExp(exp, expType);
+        }
+        levels = sum;
+    });
+    (void)levels;
+
+    measure("pkx/crypt/sequential", 50, [&]() {
+        for (size_t i = 0; i < entries; i++)
+        {
+            u8* entry = bank.data() + i * entryLength;
+            cryptSequential(entry, entryLength, *(u32*)entry, 232);
+        }
+    });
+    measure("pkx/crypt/jump", 50, [&]() {
+        for (size_t i = 0; i < entries; i++)
+        {
+            u8* entry = bank.data() + i * entryLength;
+            PKX::cryptData(entry, entryLength, *(u32*)entry, 232);
+        }
+    });
+    measure("pkx/decrypt/bank", 50, [&]() {
+        for (size_t i = 0; i < entries; i++)
+        {
+            PKX::decrypt(bank.data() + i * entryLength, entryLength, Generation::SEVEN);
+        }
+    }, [&]() {
+        for (size_t i = 0; i < entries; i++)
+        {
+            PKX::encrypt(bank.data() + i * entryLength, entryLength, Generation::SEVEN);
+        }
+    });
+
+    // Pool accounting: live counts follow the objects, and freed blocks are reused first
+    auto liveOf = [](u32 size) {
+        for (auto& stats : PKXPool::stats())
+        {
+            if (stats.size == size)
+            {
+                return stats.live;
+            }
+        }
+        return 0u;
+    };
+    u8 box[232] = {0};
+    std::vector<std::shared_ptr<PKX>> pkms;
+    u32 before = liveOf(232);
+    for (int i = 0; i < 3000; i++)
+    {
+        pkms.push_back(PKXPool::make<PK7>(box));
+    }
+    if (liveOf(232) != before + 3000)
+    {
+        fail("pkx: pool counts %u live payloads for 3000 Pokémon\n", liveOf(232) - before);
+    }
+    pkms.clear();
+    if (liveOf(232) != before)
+    {
+        fail("pkx: pool still counts %u payloads after they were freed\n", liveOf(232) - before);
+    }
+    void* block = PKXPool::allocate(232);
+    PKXPool::release(block, 232);
+    if (PKXPool::allocate(232) != block)
+    {
+        fail("pkx: pool did not reuse a freed block\n");
+    }
+    PKXPool::release(block, 232);
+
+    // A clone keeps a party Pokémon's party data
+    u8 party[220] = {0};
+    if (PK5(party, false, true).clone()->getLength() != 220)
+    {
+        fail("pkx: cloning a gen 5 party Pokémon dropped its party data\n");
+    }
+
+    // All live at once, as a box of Pokémon would be, so the heap cannot elide or recycle trivially
+    std::vector<u8*> payloads(3000);
+    measure("pkx/alloc/payload-heap", 50, [&]() {
+        for (auto& payload : payloads)
+        {
+            payload = new u8[232];
+        }
+        for (auto payload : payloads)
+        {
+            delete[] payload;
+        }
+    });
+    measure("pkx/alloc/payload-pool", 50, [&]() {
+        for (auto& payload : payloads)
+        {
+            payload = (u8*)PKXPool::allocate(232);
+        }
+        for (auto payload : payloads)
+        {
+            PKXPool::release(payload, 232);
+        }
+    });
+    measure("pkx/alloc/make_shared", 50, [&]() {
+        for (int i = 0; i < 3000; i++)
+        {
+            pkms.push_back(std::make_shared<PK7>(box));
+        }
+        pkms.clear();
+    });
+    measure("pkx/alloc/pool-make", 50, [&]() {
+        for (int i = 0; i < 3000; i++)
+        {
+            pkms.push_back(PKXPool::make<PK7>(box));
+        }
+        pkms.clear();
+    });
+    for (auto& stats : PKXPool::stats())
+    {
+        report("pkx/pool/" + std::to_string(stats.size) + "/peak", stats.peak, "blocks");
+    }
+}
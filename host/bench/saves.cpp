@@ -0,0 +1,330 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+
+#include <algorithm>
+#include <utility>
+#include "bench.hpp"
+#include "loader.hpp"
+#include "random.hpp"
+#include "SavB2W2.hpp"
+#include "SavBW.hpp"
+#include "SavDP.hpp"
+#include "SavHGSS.hpp"
+#include "SavLGPE.hpp"
+#include "SavORAS.hpp"
+#include "SavPT.hpp"
+#include "SavSUMO.hpp"
+#include "SavUSUM.hpp"
+#include "SavXY.hpp"
+
+const std::vector<Game> Bench::games = { DP, Pt, HGSS, BW, B2W2, XY, ORAS, SM, USUM, LGPE };
+
+const char* Bench::gameName(Game game)
+{
+    switch (game)
+    {
+        case Game::DP:
+            return "DP";
+        case Game::Pt:
+            return "Pt";
+        case Game::HGSS:
+            return "HGSS";
+        case Game::BW:
+            return "BW";
+        case Game::B2W2:
+            return "B2W2";
+        case Game::XY:
+            return "XY";
+        case Game::ORAS:
+            return "ORAS";
+        case Game::SM:
+            return "SM";
+        case Game::USUM:
+            return "USUM";
+        case Game::LGPE:
+            return "LGPE";
+    }
+    return "";
+}
+
+Generation Bench::gameGeneration(Game game)
+{
+    switch (game)
+    {
+        case Game::DP:
+        case Game::Pt:
+        case Game::HGSS:
+            return Generation::FOUR;
+        case Game::BW:
+        case Game::B2W2:
+            return Generation::FIVE;
+        case Game::XY:
+        case Game::ORAS:
+            return Generation::SIX;
+        case Game::SM:
+        case Game::USUM:
+            return Generation::SEVEN;
+        case Game::LGPE:
+            return Generation::LGPE;
+    }
+    return Generation::UNUSED;
+}
+
+// Block identifiers Sav::checkDSType looks for in Gen 4 saves
+static void writeDSPattern(u8* dt, const std::vector<u8>& pattern)
+{
+    std::copy(pattern.begin(), pattern.end(), dt + *(u16*)pattern.data() - 0xC);
+}
+
+// Gen 7 checksums are seeded with the block identifiers stored in the checksum table
+static void writeBlockIDs(u8* dt, u32 csoff, u16 count)
+{
+    for (u16 i = 0; i < count; i++)
+    {
+        *(u16*)(dt + csoff + i*8 - 2) = i;
+    }
+}
+
+static std::unique_ptr<Sav> blankSave(Game game, size_t& fileSize)
+{
+    std::vector<u8> blank(0x100000, 0);
+    switch (game)
+    {
+        case Game::DP:
+            fileSize = 0x80000;
+            writeDSPattern(blank.data(), { 0x00, 0xC1, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00 });
+            return std::make_unique<SavDP>(blank.data());
+        case Game::Pt:
+            fileSize = 0x80000;
+            writeDSPattern(blank.data(), { 0x2C, 0xCF, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00 });
+            return std::make_unique<SavPT>(blank.data());
+        case Game::HGSS:
+            fileSize = 0x80000;
+            writeDSPattern(blank.data(), { 0x28, 0xF6, 0x00, 0x00, 0x23, 0x06, 0x06, 0x20, 0x00, 0x00 });
+            return std::make_unique<SavHGSS>(blank.data());
+        case Game::BW:
+            fileSize = 0x80000;
+            return std::make_unique<SavBW>(blank.data());
+        case Game::B2W2:
+            fileSize = 0x80000;
+            return std::make_unique<SavB2W2>(blank.data());
+        case Game::XY:
+            fileSize = 0x65600;
+            return std::make_unique<SavXY>(blank.data());
+        case Game::ORAS:
+            fileSize = 0x76000;
+            return std::make_unique<SavORAS>(blank.data());
+        case Game::SM:
+            fileSize = 0x6BE00;
+            writeBlockIDs(blank.data(), 0x6BC1A, 37);
+            return std::make_unique<SavSUMO>(blank.data());
+        case Game::USUM:
+            fileSize = 0x6CC00;
+            writeBlockIDs(blank.data(), 0x6CA1A, 39);
+            return std::make_unique<SavUSUM>(blank.data());
+        case Game::LGPE:
+            fileSize = 0xB8800;
+            writeBlockIDs(blank.data(), 0xB861A, 21);
+            return std::make_unique<SavLGPE>(blank.data());
+    }
+    return nullptr;
+}
+
+std::vector<u8> Bench::saveImage(Game game)
+{
+    size_t fileSize = 0;
+    std::unique_ptr<Sav> save = blankSave(game, fileSize);
+
+    for (int i = 0; i < save->maxSlot(); i++)
+    {
+        std::shared_ptr<PKX> pk = save->emptyPkm()->clone();
+        pk->encryptionConstant(randomNumbers());
+        pk->PID(randomNumbers());
+        pk->species(randomNumbers() % save->maxSpecies() + 1);
+        pk->TID(randomNumbers());
+        pk->SID(randomNumbers());
+        pk->experience(randomNumbers() % 1000000);
+        pk->nature(randomNumbers() % 25);
+        for (int stat = 0; stat < 6; stat++)
+        {
+            pk->iv(stat, randomNumbers() % 32);
+            pk->ev(stat, randomNumbers() % 253);
+        }
+        save->pkm(pk, i / 30, i % 30, false);
+    }
+    save->cryptBoxData(false);
+    // a blank save has no valid checksums yet, so have resign cover every block
+    save->rawData();
+    save->resign();
+
+    std::vector<u8> image(fileSize, 0);
+    std::copy(save->rawData(), save->rawData() + std::min((size_t)save->getLength(), fileSize), image.begin());
+    return image;
+}
+
+// Crypting the boxes in place must match decrypting every slot through its PKX class
+static void checkBoxCrypt(Sav& save, const std::string& name)
+{
+    std::vector<u8> encrypted(std::as_const(save).rawData(), std::as_const(save).rawData() + save.getLength());
+    std::vector<std::shared_ptr<PKX>> expected;
+    for (int i = 0; i < save.maxSlot(); i++)
+    {
+        expected.push_back(save.pkm(i / 30, i % 30, true));
+    }
+
+    save.cryptBoxData(true);
+    for (int i = 0; i < save.maxSlot(); i++)
+    {
+        const u8* pk = std::as_const(save).rawData() + save.boxOffset(i / 30, i % 30);
+        if (!std::equal(pk, pk + expected[i]->getLength(), expected[i]->rawData()))
+        {
+            Bench::fail("%s: in-place decryption of slot %d differs from PKX::decrypt\n", name.c_str(), i);
+            break;
+        }
+    }
+
+    save.cryptBoxData(false);
+    if (!std::equal(encrypted.begin(), encrypted.end(), std::as_const(save).rawData()))
+    {
+        Bench::fail("%s: in-place box encryption does not round trip\n", name.c_str());
+    }
+}
+
+// Every PKXView field must read what the PKX class does for the same slot. Expects decrypted boxes
+static void checkViews(Sav& save, const std::string& name)
+{
+    for (int i = 0; i < save.maxSlot(); i++)
+    {
+        auto pk = save.pkm(i / 30, i % 30);
+        bool same = save.view(i / 30, i % 30, [&pk](const auto& view) {
+            bool ret = view.generation() == pk->generation() && view.encryptionConstant() == pk->encryptionConstant() &&
+                       view.checksum() == pk->checksum() && view.species() == pk->species() && view.heldItem() == pk->heldItem() &&
+                       view.TID() == pk->TID() && view.SID() == pk->SID() && view.experience() == pk->experience() &&
+                       view.ability() == pk->ability() && view.PID() == pk->PID() && view.nature() == pk->nature() &&
+                       view.fatefulEncounter() == pk->fatefulEncounter() && view.gender() == pk->gender() &&
+                       view.alternativeForm() == pk->alternativeForm() && view.egg() == pk->egg() && view.nicknamed() == pk->nicknamed() &&
+                       view.ball() == pk->ball() && view.metLevel() == pk->metLevel() && view.otGender() == pk->otGender() &&
+                       view.version() == pk->version() && view.language() == pk->language() && view.TSV() == pk->TSV() &&
+                       view.PSV() == pk->PSV() && view.shiny() == pk->shiny() && view.formSpecies() == pk->formSpecies() &&
+                       view.level() == pk->level() && view.type1() == pk->type1() && view.type2() == pk->type2();
+            for (u8 j = 0; j < 4; j++)
+            {
+                ret = ret && view.move(j) == pk->move(j) && view.PP(j) == pk->PP(j);
+            }
+            for (u8 j = 0; j < 6; j++)
+            {
+                ret = ret && view.ev(j) == pk->ev(j) && view.iv(j) == pk->iv(j);
+            }
+            return ret;
+        });
+        if (!same)
+        {
+            Bench::fail("%s: PKXView of slot %d differs from PKX\n", name.c_str(), i);
+            break;
+        }
+    }
+}
+
+// Resigning only the blocks written through the setters must give the same file as a full resign
+static void checkDirtyResign(Sav& save, const std::string& name)
+{
+    std::shared_ptr<PKX> pk = save.pkm(1, 2, true);
+    pk->nickname("Dirty");
+    pk->encrypt();
+    save.pkm(pk, 1, 2, false);
+    save.money(1234);
+    save.playedHours(56);
+    save.boxName(3, "Renamed");
+    save.dex(save.pkm(1, 2, true));
+    save.resign();
+
+    std::vector<u8> partial(std::as_const(save).rawData(), std::as_const(save).rawData() + save.getLength());
+    save.rawData();
+    save.resign();
+    if (!std::equal(partial.begin(), partial.end(), std::as_const(save).rawData()))
+    {
+        Bench::fail("%s: resign after setter writes differs from a full resign\n", name.c_str());
+    }
+}
+
+void Bench::saves(void)
+{
+    for (auto game : games)
+    {
+        std::vector<u8> image = saveImage(game);
+        std::string name = gameName(game);
+
+        std::shared_ptr<Sav> save = Sav::getSave(image.data(), image.size());
+        if (!save || save->generation() != gameGeneration(game))
+        {
+            fail("%s: synthetic save was not recognised\n", name.c_str());
+            continue;
+        }
+        TitleLoader::save = save;
+
+        measure("getSave/" + name, 50, [&]() { Sav::getSave(image.data(), image.size()); });
+        checkBoxCrypt(*save, name);
+        checkDirtyResign(*save, name);
+        measure("resign/full/" + name, 50, [&]() { save->resign(); }, [&]() { save->rawData(); });
+        measure("resign/money/" + name, 50, [&]() { save->resign(); }, [&]() { save->money(save->money() + 1); });
+        // Crypting is its own inverse only in pairs, so every run starts from a known image
+        // instead of from whatever the previous (or a filtered out) benchmark left behind
+        std::vector<u8> encrypted(std::as_const(*save).rawData(), std::as_const(*save).rawData() + save->getLength());
+        save->cryptBoxData(true);
+        std::vector<u8> decrypted(std::as_const(*save).rawData(), std::as_const(*save).rawData() + save->getLength());
+        auto restore = [&save](const std::vector<u8>& from) { std::copy(from.begin(), from.end(), save->rawData()); };
+        measure("cryptBoxData/decrypt/" + name, 20, [&]() { save->cryptBoxData(true); }, [&]() { restore(encrypted); });
+        measure("cryptBoxData/encrypt/" + name, 20, [&]() { save->cryptBoxData(false); }, [&]() { restore(decrypted); });
+        restore(decrypted);
+        measure("pkm/boxes/" + name, 50, [&]() {
+            for (int i = 0; i < save->maxSlot(); i++)
+            {
+                save->pkm(i / 30, i % 30);
+            }
+        });
+        checkViews(*save, name);
+        // What drawing a box icon reads, through a PKX and in place
+        volatile u32 icons = 0;
+        measure("pkm/icon-fields/" + name, 50, [&]() {
+            for (int i = 0; i < save->maxSlot(); i++)
+            {
+                auto pk = save->pkm(i / 30, i % 30);
+                icons = icons + pk->species() + pk->alternativeForm() + pk->gender() + pk->egg() + pk->heldItem() + pk->shiny();
+            }
+        });
+        measure("view/icon-fields/" + name, 50, [&]() {
+            for (int i = 0; i < save->maxSlot(); i++)
+            {
+                save->view(i / 30, i % 30, [&icons](const auto& pk) {
+                    icons = icons + pk.species() + pk.alternativeForm() + pk.gender() + pk.egg() + pk.heldItem() + pk.shiny();
+                });
+            }
+        });
+
+        TitleLoader::save = nullptr;
+    }
+}
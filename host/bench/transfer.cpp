@@ -0,0 +1,175 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bench.hpp"
+#include "BankBoxStore.hpp"
+#include "BankTransfer.hpp"
+#include "StdioBankFile.hpp"
+
+void Bench::transfer(void)
+{
+    char dir[] = "/tmp/pksmbench.XXXXXX";
+    if (!mkdtemp(dir))
+    {
+        fail("transfer: could not create a scratch directory\n");
+        return;
+    }
+    StdioBankFile file;
+    std::string root = dir;
+    const int boxes = 10;
+
+    // A bank holding a mix of generations, written straight through the store
+    std::vector<BankEntry> entries = bankEntries(boxes * 30);
+    std::vector<u8> header(BankTransfer::HEADER_SIZE);
+    memcpy(header.data(), "PKSMBANK", 8);
+    int version = 3;
+    memcpy(header.data() + 8, &version, sizeof(int));
+    memcpy(header.data() + 12, &boxes, sizeof(int));
+    {
+        BankBoxStore store;
+        store.attach(file, root + "/source.bnk", header.size());
+        store.save(header, boxes, [&](int box) { return (const u8*)&entries[box * 30]; }, {}, true, true);
+    }
+    std::vector<BankEntry> occupied;
+    for (auto& entry : entries)
+    {
+        if (!BankBoxStore::emptyEntry((u8*)&entry))
+        {
+            occupied.emplace_back(entry);
+        }
+    }
+
+    // What a bank holds, in slot order
+    auto contents = [&](const std::string& path) {
+        std::vector<std::shared_ptr<PKX>> ret;
+        std::vector<u8> bank;
+        file.read(path, bank);
+        int count;
+        memcpy(&count, bank.data() + 12, sizeof(int));
+        BankBoxStore store;
+        std::vector<u8> box(BankBoxStore::BOX_SIZE);
+        if (!store.open(file, path, BankTransfer::HEADER_SIZE, count))
+        {
+            return ret;
+        }
+        for (int i = 0; i < count && store.readBox(i, box.data()); i++)
+        {
+            for (int slot = 0; slot < 30; slot++)
+            {
+                const u8* entry = box.data() + slot * BankBoxStore::ENTRY_SIZE;
+                if (!BankBoxStore::emptyEntry(entry))
+                {
+                    ret.emplace_back(BankBoxStore::readEntry(entry));
+                }
+            }
+        }
+        return ret;
+    };
+    auto same = [](const std::vector<std::shared_ptr<PKX>>& a, const std::vector<BankEntry>& b) {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (memcmp(a[i]->rawData(), b[i].data, a[i]->getLength()))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Round trip: everything exported comes back, packed into the first slots
+    std::string folder = root + "/folder";
+    BankTransfer::Report report = BankTransfer::exportBank(file, root + "/source.bnk", folder);
+    if (!report.good || report.moved != occupied.size())
+    {
+        fail("transfer: export wrote %u of %zu Pokémon\n", report.moved, occupied.size());
+    }
+    BankTransfer::create(file, root + "/copy.bnk", boxes);
+    report = BankTransfer::importFolder(file, root + "/copy.bnk", folder);
+    if (!report.good || report.moved != occupied.size() || report.rejected || report.unplaced)
+    {
+        fail("transfer: import took %u of %zu Pokémon, rejecting %u\n", report.moved, occupied.size(), report.rejected);
+    }
+    if (!same(contents(root + "/copy.bnk"), occupied))
+    {
+        fail("transfer: imported bank differs from the exported one\n");
+    }
+
+    // Importing again fills the remaining slots and leaves the rest unplaced
+    auto revision = [&](const std::string& path) {
+        u32 ret = 0;
+        file.read(path, 16, (u8*)&ret, sizeof(u32));
+        return ret;
+    };
+    u32 imported = revision(root + "/copy.bnk");
+    report = BankTransfer::importFolder(file, root + "/copy.bnk", folder);
+    if (report.moved != boxes * 30 - occupied.size() || report.unplaced != occupied.size() - report.moved)
+    {
+        fail("transfer: second import placed %u and left %u\n", report.moved, report.unplaced);
+    }
+    if (imported == 0 || revision(root + "/copy.bnk") == imported)
+    {
+        fail("transfer: import left the bank's revision alone\n");
+    }
+
+    // Files that are not Pokémon, and Pokémon the validator refuses
+    std::vector<u8> junk(100, 0x12);
+    file.write(folder + "/junk.pk7", 0, junk.data(), junk.size());
+    std::vector<u8> blank(232, 0);
+    file.write(folder + "/blank.pk6", 0, blank.data(), blank.size());
+    BankTransfer::create(file, root + "/filtered.bnk", boxes);
+    u32 refused = 0;
+    report = BankTransfer::importFolder(file, root + "/filtered.bnk", folder, [&](PKX& pkm) {
+        if (pkm.species() > 151)
+        {
+            refused++;
+            return false;
+        }
+        return true;
+    });
+    if (report.rejected != refused + 2 || report.moved + refused != occupied.size())
+    {
+        fail("transfer: filtered import rejected %u, expected %u\n", report.rejected, refused + 2);
+    }
+    remove((folder + "/junk.pk7").c_str());
+    remove((folder + "/blank.pk6").c_str());
+
+    measure("transfer/export/300-slots", 10, [&]() { BankTransfer::exportBank(file, root + "/source.bnk", folder); });
+    measure(
+        "transfer/import/300-slots", 10, [&]() { BankTransfer::importFolder(file, root + "/copy.bnk", folder); },
+        [&]() { BankTransfer::create(file, root + "/copy.bnk", boxes); });
+
+    std::string cleanup = "rm -r " + root;
+    if (system(cleanup.c_str()) != 0)
+    {
+        fail("transfer: could not remove %s\n", dir);
+    }
+}
@@ -0,0 +1,127 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <stdlib.h>
+#include <thread>
+#include "bench.hpp"
+#include "BackupStore.hpp"
+#include "WriteQueue.hpp"
+
+void Bench::writer(void)
+{
+    // Order, and where completions run
+    WriteQueue queue;
+    queue.start();
+    std::vector<int> ran;
+    std::vector<int> completed;
+    bool elsewhere = true;
+    bool early = false;
+    auto self = std::this_thread::get_id();
+    for (int i = 0; i < 100; i++)
+    {
+        queue.push(
+            [&, i]() {
+                elsewhere = elsewhere && std::this_thread::get_id() != self;
+                ran.push_back(i);
+                return i != 50;
+            },
+            [&, i](bool good) {
+                early = early || std::this_thread::get_id() != self;
+                completed.push_back(good ? i : -i);
+            });
+    }
+    queue.wait();
+    if (!completed.empty() || ran.size() != 100)
+    {
+        fail("writer: wait ran completions or returned before the jobs did\n");
+    }
+    queue.flush();
+    bool ordered = ran.size() == 100 && completed.size() == 100;
+    for (int i = 0; ordered && i < 100; i++)
+    {
+        ordered = ran[i] == i && completed[i] == (i == 50 ? -50 : i);
+    }
+    if (!ordered || !elsewhere || early)
+    {
+        fail("writer: jobs did not run in order on the writer thread\n");
+    }
+
+    // Stopping drains the queue first
+    int slow = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        queue.push([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            slow++;
+            return true;
+        });
+    }
+    queue.stop();
+    if (slow != 5 || queue.busy())
+    {
+        fail("writer: stopping dropped queued jobs\n");
+    }
+
+    // Without a thread, jobs run as they are pushed
+    bool inPlace = false;
+    queue.push([&]() { return inPlace = std::this_thread::get_id() == self; }, [&](bool good) { inPlace = inPlace && good; });
+    if (!inPlace)
+    {
+        fail("writer: stopped queue did not run the job in place\n");
+    }
+
+    // Time the interface spends on a save backup, written in place and queued
+    char dir[] = "/tmp/pksmbench.XXXXXX";
+    if (!mkdtemp(dir))
+    {
+        fail("writer: could not create a scratch directory\n");
+        return;
+    }
+    BackupStore store(std::string(dir) + "/store");
+    std::vector<u8> save = saveImage(Game::SM);
+    int session = 0;
+    measure("writer/backup/blocking", 20, [&]() {
+        save[session * 0x1000 % save.size()] ^= 1;
+        store.backup("sm", std::to_string(session++), save.data(), save.size());
+    });
+    queue.start();
+    measure(
+        "writer/backup/queued", 20,
+        [&]() {
+            save[session * 0x1000 % save.size()] ^= 1;
+            queue.push([&store, contents = save, snapshot = std::to_string(session++)]() {
+                return store.backup("sm", snapshot, contents.data(), contents.size());
+            });
+        },
+        [&]() { queue.flush(); });
+    queue.stop();
+
+    std::string cleanup = "rm -r " + std::string(dir);
+    if (system(cleanup.c_str()) != 0)
+    {
+        fail("writer: could not remove %s\n", dir);
+    }
+}
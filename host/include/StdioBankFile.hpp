@@ -0,0 +1,45 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#ifndef STDIOBANKFILE_HPP
+#define STDIOBANKFILE_HPP
+
+#include "BankFile.hpp"
+
+// Bank files in a plain directory, for exercising bank persistence off the console
+class StdioBankFile : public BankFile
+{
+public:
+    bool read(const std::string& path, std::vector<u8>& out) override;
+    bool read(const std::string& path, u32 offset, u8* data, u32 size) override;
+    bool write(const std::string& path, u32 offset, const u8* data, u32 size) override;
+    bool resize(const std::string& path, u32 size) override;
+    bool remove(const std::string& path) override;
+    const u8* map(const std::string& path, u32 size) override;
+    void unmap(const u8* data, u32 size) override;
+};
+
+#endif
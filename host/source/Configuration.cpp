@@ -0,0 +1,91 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+
+#include "Configuration.hpp"
+
+#ifndef ROMFS_PATH
+#define ROMFS_PATH "../assets/romfs"
+#endif
+
+Configuration::Configuration()
+{
+    loadFromRomfs();
+}
+
+// Host builds never persist their configuration
+void Configuration::save() {}
+
+std::vector<std::string> Configuration::extraSaves(const std::string& id)
+{
+    if (mJson["extraSaves"].count(id) > 0)
+    {
+        return mJson["extraSaves"][id].get<std::vector<std::string>>();
+    }
+    return {};
+}
+
+void Configuration::extraSaves(const std::string& id, std::vector<std::string>& value)
+{
+    mJson["extraSaves"][id] = value;
+}
+
+void Configuration::loadFromRomfs()
+{
+    FILE* in = fopen(ROMFS_PATH "/config.json", "rt");
+    if (in)
+    {
+        mJson = nlohmann::json::parse(in, nullptr, false);
+        fclose(in);
+    }
+
+    if (!in || mJson.is_discarded())
+    {
+        mJson = nlohmann::json::object();
+        mJson["version"] = CURRENT_VERSION;
+        mJson["autoBackup"] = false;
+        mJson["transferEdit"] = true;
+        mJson["useExtData"] = false;
+        mJson["defaults"]["pid"] = 12345;
+        mJson["defaults"]["sid"] = 54321;
+        mJson["defaults"]["ot"] = "PKSM";
+        mJson["defaults"]["nationality"] = 2;
+        mJson["defaults"]["country"] = 0;
+        mJson["defaults"]["region"] = 0;
+        mJson["defaults"]["date"]["day"] = 1;
+        mJson["defaults"]["date"]["month"] = 1;
+        mJson["defaults"]["date"]["year"] = 2000;
+        mJson["extraSaves"] = nlohmann::json::object();
+        mJson["writeFileSave"] = false;
+        mJson["useSaveInfo"] = false;
+        mJson["randomMusic"] = false;
+        mJson["showBackups"] = false;
+        mJson["keptBackups"] = 0;
+    }
+
+    // There is no system language to query outside of the console
+    mJson["language"] = Language::EN;
+}
@@ -0,0 +1,113 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "StdioBankFile.hpp"
+
+bool StdioBankFile::read(const std::string& path, std::vector<u8>& out)
+{
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in)
+    {
+        return false;
+    }
+    fseek(in, 0, SEEK_END);
+    out.resize(ftell(in));
+    fseek(in, 0, SEEK_SET);
+    bool good = fread(out.data(), 1, out.size(), in) == out.size();
+    fclose(in);
+    return good;
+}
+
+bool StdioBankFile::read(const std::string& path, u32 offset, u8* data, u32 size)
+{
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in)
+    {
+        return false;
+    }
+    bool good = fseek(in, offset, SEEK_SET) == 0 && fread(data, 1, size, in) == size;
+    fclose(in);
+    return good;
+}
+
+bool StdioBankFile::write(const std::string& path, u32 offset, const u8* data, u32 size)
+{
+    FILE* out = fopen(path.c_str(), "r+b");
+    if (!out)
+    {
+        out = fopen(path.c_str(), "w+b");
+        if (!out)
+        {
+            return false;
+        }
+    }
+    bool good = fseek(out, offset, SEEK_SET) == 0 && fwrite(data, 1, size, out) == size;
+    good = fflush(out) == 0 && good;
+    return fclose(out) == 0 && good;
+}
+
+bool StdioBankFile::resize(const std::string& path, u32 size)
+{
+    if (truncate(path.c_str(), size) == 0)
+    {
+        return true;
+    }
+    FILE* out = fopen(path.c_str(), "w+b");
+    return out && fclose(out) == 0 && truncate(path.c_str(), size) == 0;
+}
+
+bool StdioBankFile::remove(const std::string& path)
+{
+    return ::remove(path.c_str()) == 0;
+}
+
+const u8* StdioBankFile::map(const std::string& path, u32 size)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    // Touching a mapping past the end of the file faults
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size < size)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return nullptr;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return data == MAP_FAILED ? nullptr : (const u8*)data;
+}
+
+void StdioBankFile::unmap(const u8* data, u32 size)
+{
+    munmap((void*)data, size);
+}
@@ -0,0 +1,88 @@
+/*
+*   This file is part of PKSM
+*   Copyright (C) 2016-2019 Bernardo Giordano, Admiral Fish, piepie62
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*   Additional Terms 7.b and 7.c of GPLv3 apply to this file:
+*       * Requiring preservation of specified reasonable legal notices or
+*         author attributions in that material or in the Appropriate Legal
+*         Notices displayed by works containing it.
+*       * Prohibiting misrepresentation of the origin of that material,
+*         or requiring that modified versions of such material be marked in
+*         reasonable ways as different from the original version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "BankTransfer.hpp"
+#include "StdioBankFile.hpp"
+#include "loader.hpp"
+
+// Moves Pokémon between a PKSM bank and a folder of .pkx files on a workstation
+
+static int usage()
+{
+    fprintf(stderr, "usage: pksmbank create <bank> <boxes>\n"
+                    "       pksmbank export <bank> <dir>\n"
+                    "       pksmbank import <bank> <dir> [save]\n");
+    return 1;
+}
+
+static int finish(const BankTransfer::Report& report)
+{
+    printf("moved %u, rejected %u, unplaced %u\n", report.moved, report.rejected, report.unplaced);
+    return report.good ? 0 : 2;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        return usage();
+    }
+    StdioBankFile file;
+    std::string command = argv[1];
+    if (command == "create")
+    {
+        if (!BankTransfer::create(file, argv[2], atoi(argv[3])))
+        {
+            fprintf(stderr, "could not create %s\n", argv[2]);
+            return 2;
+        }
+        return 0;
+    }
+    else if (command == "export")
+    {
+        return finish(BankTransfer::exportBank(file, argv[2], argv[3]));
+    }
+    else if (command == "import")
+    {
+        BankTransfer::Validator valid;
+        if (argc > 4)
+        {
+            std::vector<u8> data;
+            if (!file.read(argv[4], data) || !(TitleLoader::save = Sav::getSave(data.data(), data.size())))
+            {
+                fprintf(stderr, "%s is not a supported save\n", argv[4]);
+                return 2;
+            }
+            valid = [](PKX& pkm) { return TitleLoader::save->transferError(pkm) == TransferError::NONE; };
+        }
+        return finish(BankTransfer::importFolder(file, argv[2], argv[3], valid));
+    }
+    return usage();
+}